@@ -1,7 +1,20 @@
 #include "SudokuSolver.h"
+#include "SudokuParallel.h"
+#include "SudokuPipeline.h"
+#include "SudokuParser.h"
+#include "SudokuEnumerator.h"
+#include "SudokuHints.h"
+#include "SudokuDispatch.h"
+#include "SudokuTuner.h"
+#include "SudokuDecisions.h"
+
+#include <signal.h>
 
 #define INPUTBUFFERSIZE 1024
 
+// how often batch mode rewrites its metrics file in milliseconds
+#define METRICSINTERVAL 1000
+
 #define ISNUMERIC(x) (x > 0x2F && x < 0x3A)
 
 //! This function simply grabs a line of input from the console
@@ -55,23 +68,554 @@ bool __grabxyv(char **ptr, unsigned int xyv[3])
     return true;
 }
 
+//! This function writes every solution of the puzzle on the first line of stdin to stdout
+/*!
+ *    @param      unsigned int       The number of threads to search with
+ *    @param      unsigned long long The number of solutions to stop after, 0 for all of them
+ *    @param      char *             A file to resume from and save progress to, or NULL
+ *
+ *    @author     Daniel Fraser      <danielfraser782@gmail.com>
+ *
+ *    Note: Running again with the same state file carries on where the last run stopped
+ */
+void __enumerate(unsigned int threads, unsigned long long limit, const char *statefile)
+{
+    char input_buffer[INPUTBUFFERSIZE];
+    unsigned int grid[9][9];
+    unsigned long long found = 0;
+    ParseResult result;
+    EnumerationState state;
+    Sudoku sudoku;
+    FILE *file = NULL;
+
+    // grab the puzzle
+    if (!fgets(input_buffer, sizeof(input_buffer), stdin)) {
+        fprintf(stderr, "No puzzle to enumerate\n");
+        return;
+    }
+
+    if (!ParsePuzzleLine(input_buffer, 1, grid, &result)) {
+        fprintf(stderr, "line 1, column %u: %s\n", result.column, ParseErrorString(result.error));
+        return;
+    }
+
+    InitializeSudokuStorage(&sudoku, 0, 81);
+    sudoku.verbose = false;
+    memcpy(sudoku.grid, grid, sizeof(grid));
+
+    // pick up where we left off if there is a saved state
+    InitializeEnumerationState(&state, NULL);
+
+    if (statefile
+        && (file = fopen(statefile, "r"))) {
+        if (!LoadEnumerationState(&state, file)) {
+            fprintf(stderr, "Ignoring the unreadable state in %s\n", statefile);
+        }
+
+        fclose(file);
+    }
+
+    // don't overwrite the progress of another puzzle
+    if (!EnumerationStateMatches(&state, &sudoku)) {
+        fprintf(stderr, "The state in %s was saved for another puzzle\n", statefile);
+        DestroyEnumerationState(&state);
+        return;
+    }
+
+    found = EnumerateSolutions(&sudoku, threads, limit, WriteSolution, stdout, &state);
+    fflush(stdout);
+
+    // save our progress for next time
+    if (statefile) {
+        if (!(file = fopen(statefile, "w"))
+            || !SaveEnumerationState(&state, file)) {
+            fprintf(stderr, "Failed to save the state to %s\n", statefile);
+        }
+
+        if (file) {
+            fclose(file);
+        }
+    }
+
+    fprintf(stderr, "%llu solutions, %llu in total%s\n", found, state.solutions, state.complete ? ", all found" : "");
+
+    DestroyEnumerationState(&state);
+}
+
+//! This function reads every puzzle on stdin
+/*!
+ *    @param      unsigned int *     Receives the number of puzzles read
+ *
+ *    @returns    unsigned int[][9][9] The puzzles, to be freed by the caller, or NULL if none could be kept
+ *
+ *    @author     Daniel Fraser      <danielfraser782@gmail.com>
+ *
+ *    Note: Lines that aren't puzzles are reported and skipped, blank lines are skipped quietly
+ */
+unsigned int (*__readpuzzles(unsigned int *count))[9][9]
+{
+    char input_buffer[INPUTBUFFERSIZE];
+    unsigned int (*puzzles)[9][9] = NULL, (*grown)[9][9] = NULL;
+    unsigned int capacity = 0, line = 0;
+    ParseResult result;
+
+    *count = 0;
+
+    // grab every puzzle, doubling our room as we go
+    while (fgets(input_buffer, sizeof(input_buffer), stdin)) {
+        line++;
+
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+
+            if (!(grown = realloc(puzzles, capacity * sizeof(*puzzles)))) {
+                fprintf(stderr, "Failed to read the puzzles\n");
+                free(puzzles);
+                *count = 0;
+                return NULL;
+            }
+
+            puzzles = grown;
+        }
+
+        // blank lines aren't puzzles, so they aren't worth a complaint either
+        if (!ParsePuzzleLine(input_buffer, line, puzzles[*count], &result)) {
+            if (result.error != PARSE_EMPTY) {
+                fprintf(stderr, "line %u, column %u: %s\n", line, result.column, ParseErrorString(result.error));
+            }
+
+            continue;
+        }
+
+        (*count)++;
+    }
+
+    return puzzles;
+}
+
+//! This function learns which engine suits each difficulty of the puzzles on stdin and prints the buckets
+/*!
+ *    @param      unsigned int       The number of threads parallel searches are timed with
+ *    @param      unsigned int       The maximum number of consecutive guesses
+ *
+ *    @author     Daniel Fraser      <danielfraser782@gmail.com>
+ */
+void __train(unsigned int threads, unsigned int maxguesses)
+{
+    unsigned int (*puzzles)[9][9] = NULL;
+    unsigned int count = 0, b = 0;
+    SudokuDispatcher dispatcher;
+
+    puzzles = __readpuzzles(&count);
+
+    if (!TrainSudokuDispatcher(&dispatcher, (const unsigned int (*)[9][9])puzzles, count, MAX(threads, 1), maxguesses, NULL)) {
+        fprintf(stderr, "None of the %u puzzles needed a search\n", count);
+        free(puzzles);
+        return;
+    }
+
+    for (b = 0; b < dispatcher.count; ++b) {
+        printf("difficulty %u and up: engine %u%s\n", dispatcher.bounds[b], dispatcher.engines[b], dispatcher.parallel[b] ? " in parallel" : "");
+    }
+
+    free(puzzles);
+}
+
+//! This function finds the config that solves the puzzles on stdin best and writes it to a file
+/*!
+ *    @param      SolverConfig *     The config to start from
+ *    @param      char *             The file to write the config to
+ *
+ *    @author     Daniel Fraser      <danielfraser782@gmail.com>
+ */
+void __tune(SolverConfig *config, const char *path)
+{
+    unsigned int (*puzzles)[9][9] = NULL;
+    unsigned int count = 0;
+    TuningResult result;
+    FILE *file = NULL;
+
+    puzzles = __readpuzzles(&count);
+
+    if (!TuneSolverConfig(config, (const unsigned int (*)[9][9])puzzles, count, &result, NULL)) {
+        fprintf(stderr, "Failed to tune on the %u puzzles\n", count);
+        free(puzzles);
+        return;
+    }
+
+    free(puzzles);
+
+    // show what we found either way, then save it for the solver to load
+    SaveSolverConfig(config, &result, stderr);
+
+    if (!(file = fopen(path, "w"))
+        || !SaveSolverConfig(config, &result, file)) {
+        fprintf(stderr, "Failed to write the config to %s\n", path);
+    }
+
+    if (file) {
+        fclose(file);
+    }
+}
+
+//! This function solves a puzzle again from the decisions batch mode wrote for it and says whether they were all made the same
+/*!
+ *    @param      char *             The decision file to replay
+ *    @param      SudokuDispatcher * The dispatcher of adaptive solves, NULL for DefaultDispatcher
+ *    @param      unsigned int       The number of slowest decisions to print the time of, 0 not to profile
+ *
+ *    @author     Daniel Fraser      <danielfraser782@gmail.com>
+ */
+void __replay(const char *path, const SudokuDispatcher *dispatcher, unsigned int slowest)
+{
+    static const char *Outcomes[] = { "matched", "diverged", "matched as far as the log went", "failed" };
+    DecisionLog log;
+    unsigned int outcome = 0;
+    unsigned int i = 0;
+    const LogEntry *entry = NULL;
+
+    if (!InitializeDecisionLog(&log, 0, NULL)
+        || !ReadDecisionFile(&log, path)) {
+        fprintf(stderr, "Failed to read the decisions %s\n", path);
+        DestroyDecisionLog(&log);
+        return;
+    }
+
+    // a shared table remembered boards this solve never saw, so it may not have guessed as often
+    if (log.transpositions) {
+        fprintf(stderr, "The decisions were made with a shared transposition table and may not replay\n");
+    }
+
+    // the members of a portfolio race on threads of their own, so the decisions never come out the same twice
+    if (log.engine == ENGINE_PORTFOLIO) {
+        fprintf(stderr, "The decisions were made by a portfolio race, which can't be replayed\n");
+        DestroyDecisionLog(&log);
+        return;
+    }
+
+    // an adaptive solve only raced a portfolio if the puzzle fell in one of its buckets
+    if (log.engine == ENGINE_ADAPTIVE) {
+        if (!dispatcher) {
+            dispatcher = &DefaultDispatcher;
+        }
+
+        for (i = 0; i < dispatcher->count; ++i) {
+            if (dispatcher->engines[i] == ENGINE_PORTFOLIO) {
+                fprintf(stderr, "The decisions won't replay if the puzzle was dispatched to a portfolio race\n");
+                break;
+            }
+        }
+    }
+
+    outcome = ReplayDecisionLog(&log, dispatcher, slowest != 0);
+    printf("%llu decisions %s\n", log.made, Outcomes[outcome]);
+
+    // show what was recorded where the replay went another way
+    if (outcome == REPLAY_DIVERGED
+        && log.divergence < log.log.count) {
+        entry = &log.log.entries[log.divergence];
+        printf("first difference at #%llu, recorded r%uc%u %u depth %u\n",
+            log.divergence,
+            entry->y + 1,
+            entry->x + 1,
+            entry->value,
+            DECISION_DEPTH(entry->id));
+    } else if (outcome == REPLAY_DIVERGED) {
+        printf("first difference at #%llu\n", log.divergence);
+    }
+
+    if (slowest) {
+        PrintDecisionProfile(&log, slowest, stdout);
+    }
+
+    DestroyDecisionLog(&log);
+}
+
+#ifdef TEST_SUDOKU
+// the bytes of the arena the allocator test solves in
+#define TESTARENASIZE (16u << 20)
+
+// a puzzle that needs guessing, so the parallel search has work to share out
+#define TESTHARDPUZZLE "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3.."
+
+//! This function solves the test puzzle and a hard one with every allocator, on one thread and on several
+/*!
+ *    @param      Sudoku *           The test puzzle, left unchanged
+ *
+ *    @returns    boolean            Whether every solve found the solution
+ *
+ *    @author     Daniel Fraser      <danielfraser782@gmail.com>
+ *
+ *    Note: The arena is reset after each puzzle, so it only has to hold one solve at a time
+ */
+bool __testallocators(Sudoku *puzzle)
+{
+    static const char *Names[] = { "system", "pool", "arena" };
+    static const unsigned int Threads[] = { 1, 4 };
+    const SudokuAllocator *allocators[3];
+    unsigned int grids[2][9][9];
+    unsigned int a = 0, t = 0, p = 0;
+    size_t used = 0;
+    Sudoku *board = NULL;
+    SudokuArena arena;
+    ParseResult result;
+    bool solved = false, passed = true;
+
+    memcpy(grids[0], puzzle->grid, sizeof(grids[0]));
+
+    if (!ParsePuzzleLine(TESTHARDPUZZLE, 1, grids[1], &result)
+        || !InitializeSudokuArena(&arena, NULL, TESTARENASIZE)) {
+        printf("Failed to initialize the test arena\n");
+        return false;
+    }
+
+    allocators[0] = &SystemAllocator;
+    allocators[1] = &PoolAllocator;
+    allocators[2] = &arena.allocator;
+
+    for (a = 0; a < 3; ++a) {
+        for (t = 0; t < 2; ++t) {
+            // the arena solves both puzzles in a row, a reset in between gives everything back
+            for (p = 0; p < 2; ++p) {
+                solved = InitializeSudokuWithAllocator(&board, puzzle->threshold, SUDOKU_CELLS, allocators[a]);
+
+                if (solved) {
+                    memcpy(board->grid, grids[p], sizeof(board->grid));
+                    board->verbose = false;
+                    board->threads = Threads[t];
+
+                    solved = (Threads[t] > 1) ? SolveSudokuParallel(board) : SolveSudoku(board);
+                    used = arena.used;
+                    DestroySudoku(board);
+                }
+
+                // everything the arena handed out goes at once
+                ResetSudokuArena(&arena);
+
+                printf("%s allocator, %u thread%s, %s puzzle: %s", Names[a], Threads[t], Threads[t] > 1 ? "s" : "", p ? "hard" : "test", solved ? "solved" : "failed");
+
+                if (a == 2) {
+                    printf(", %zu bytes in use until the reset", used);
+                }
+
+                printf("\n");
+                passed = passed && solved;
+            }
+        }
+    }
+
+    // the pool keeps what this thread freed until we hand it back
+    ReleasePoolMemory();
+    DestroySudokuArena(&arena);
+
+    return passed;
+}
+#endif
+
 int main(int argc, char* argv[])
 {
 #ifndef TEST_SUDOKU
     char input_buffer[INPUTBUFFERSIZE];
     char *ptr;
+    char description[STEPDESCRIPTIONSIZE];
     unsigned int xyv[3], placed_numbers = 0;
+    SudokuStep step;
 #endif
     unsigned int threshold = 100;
     unsigned int maxguesses = 0;
+    unsigned int threads = 1;
+
+    unsigned int tablemegabytes = 0;
+    unsigned int engine = ENGINE_PROBABILITY;
+    unsigned long long seed = 0;
+    const char *metricspath = NULL;
+    unsigned long long tracemicroseconds = 0;
+    const char *tracepath = NULL;
+    unsigned int decisionsample = 0;
+    const char *decisionpath = NULL;
+
+    SolverConfig config;
+    bool configured = false;
+    FILE *file = NULL;
 
     Sudoku *sudoku = NULL;
+    SudokuPipeline pipeline;
+    TranspositionTable table;
+    SudokuMetrics metrics;
+    MetricsReporter reporter;
+
+    DefaultSolverConfig(&config);
+
+    // a config file sets the defaults the arguments after it override <program> -config <file> ...
+    if (argc > 2 && strcmp(argv[1], "-config") == 0) {
+        if (!(file = fopen(argv[2], "r"))
+            || !LoadSolverConfig(&config, file)) {
+            fprintf(stderr, "Failed to read all of the config %s\n", argv[2]);
+        }
+
+        if (file) {
+            fclose(file);
+        }
+
+        threshold = config.threshold;
+        maxguesses = config.maxguesses;
+        engine = config.engine;
+        tablemegabytes = config.tablemegabytes;
+        seed = config.seed;
+        configured = true;
+
+        argc -= 2;
+        argv += 2;
+    }
+
+    // tune mode sweeps the search knobs over the puzzles of stdin <program> -tune <config file>
+    if (argc > 2 && strcmp(argv[1], "-tune") == 0) {
+        __tune(&config, argv[2]);
+
+        return 0;
+    }
 
-    // check for command line arguments <program> <threshold> <guesses>
+    // batch mode solves a puzzle per line of stdin
+    // <program> -batch <threads> <guesses> <table megabytes> <engine> <metrics file or -> <trace microseconds> <trace path> <seed>
+    //                      <record every nth puzzle's decisions> <decision path>
+    if (argc > 1 && strcmp(argv[1], "-batch") == 0) {
+        maxguesses = configured ? config.maxguesses : 81;
+        if (argc > 2) {
+            threads = atoi(argv[2]);
+            if (argc > 3) {
+                maxguesses = atoi(argv[3]);
+                if (argc > 4) {
+                    tablemegabytes = atoi(argv[4]);
+                    if (argc > 5) {
+                        engine = atoi(argv[5]);
+                        if (argc > 6) {
+                            metricspath = strcmp(argv[6], "-") ? argv[6] : NULL;
+                            if (argc > 8) {
+                                tracemicroseconds = strtoull(argv[7], NULL, 10);
+                                tracepath = argv[8];
+                                if (argc > 9) {
+                                    seed = strtoull(argv[9], NULL, 10);
+                                    if (argc > 11) {
+                                        decisionsample = atoi(argv[10]);
+                                        decisionpath = argv[11];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // share dead boards between every puzzle if we were given room for them
+        if (tablemegabytes
+            && !InitializeTranspositionTable(&table, (size_t)tablemegabytes << 20, NULL)) {
+            tablemegabytes = 0;
+        }
+
+        // keep the metrics file up to date every second, and straight away on SIGUSR1
+        if (metricspath) {
+            if (!InitializeSudokuMetrics(&metrics, NULL)) {
+                metricspath = NULL;
+            } else {
+                metrics.transpositions = tablemegabytes ? &table : NULL;
+
+                if (!StartMetricsReporter(&reporter, &metrics, metricspath, METRICSINTERVAL, SIGUSR1)) {
+                    fprintf(stderr, "Failed to start writing metrics\n");
+                    DestroySudokuMetrics(&metrics);
+                    metricspath = NULL;
+                }
+            }
+        }
+
+        // read, solve and write every puzzle in order
+        if (!InitializeSudokuPipeline(&pipeline, stdin, stdout, threads, maxguesses, true)) {
+            fprintf(stderr, "Failed to run the batch pipeline\n");
+        } else {
+            pipeline.transpositions = tablemegabytes ? &table : NULL;
+            pipeline.engine = engine;
+            pipeline.seed = seed;
+            pipeline.scorer = (config.scorer == SCORER_CANDIDATES) ? CandidateScore : NULL;
+            pipeline.dispatcher = config.dispatchervalid ? &config.dispatcher : NULL;
+            pipeline.metrics = metricspath ? &metrics : NULL;
+            pipeline.tracethreshold = tracemicroseconds * 1000ull;
+            pipeline.tracepath = tracepath;
+            pipeline.decisionsample = decisionsample;
+            pipeline.decisionpath = decisionpath;
+
+            if (!RunSudokuPipeline(&pipeline)) {
+                fprintf(stderr, "Failed to run the batch pipeline\n");
+            }
+        }
+
+        DestroySudokuPipeline(&pipeline);
+
+        // the reporter writes everything recorded before it stops
+        if (metricspath) {
+            StopMetricsReporter(&reporter);
+            DestroySudokuMetrics(&metrics);
+        }
+
+        if (tablemegabytes) {
+            DestroyTranspositionTable(&table);
+        }
+
+        return 0;
+    }
+
+    // decode mode prints a trace written by batch mode <program> -decode <trace file>
+    if (argc > 2 && strcmp(argv[1], "-decode") == 0) {
+        if (!DecodeTraceFile(argv[2], stdout)) {
+            fprintf(stderr, "Failed to read the trace %s\n", argv[2]);
+        }
+
+        return 0;
+    }
+
+    // replay mode solves a puzzle again from the decisions batch mode wrote <program> -replay <decision file>
+    if (argc > 2 && strcmp(argv[1], "-replay") == 0) {
+        __replay(argv[2], config.dispatchervalid ? &config.dispatcher : NULL, 0);
+
+        return 0;
+    }
+
+    // profile mode replays the decisions and times each one <program> -profile <decision file> <slowest>
+    if (argc > 2 && strcmp(argv[1], "-profile") == 0) {
+        __replay(argv[2], config.dispatchervalid ? &config.dispatcher : NULL, argc > 3 ? MAX(atoi(argv[3]), 1) : 10);
+
+        return 0;
+    }
+
+    // enumerate mode writes every solution of a puzzle <program> -enumerate <threads> <limit> <state file>
+    if (argc > 1 && strcmp(argv[1], "-enumerate") == 0) {
+        __enumerate(argc > 2 ? atoi(argv[2]) : 1,
+            argc > 3 ? strtoull(argv[3], NULL, 10) : 0,
+            argc > 4 ? argv[4] : NULL);
+
+        return 0;
+    }
+
+    // train mode times every engine on the puzzles of stdin <program> -train <threads> <guesses>
+    if (argc > 1 && strcmp(argv[1], "-train") == 0) {
+        __train(argc > 2 ? atoi(argv[2]) : 1, argc > 3 ? atoi(argv[3]) : 81);
+
+        return 0;
+    }
+
+    // check for command line arguments <program> <threshold> <guesses> <threads> <engine> <seed>
     if (argc > 1) {
         threshold = atoi(argv[1]);
         if (argc > 2) {
             maxguesses = atoi(argv[2]);
+            if (argc > 3) {
+                threads = atoi(argv[3]);
+                if (argc > 4) {
+                    engine = atoi(argv[4]);
+                    if (argc > 5) {
+                        seed = strtoull(argv[5], NULL, 10);
+                    }
+                }
+            }
         }
     }
 
@@ -81,6 +625,16 @@ int main(int argc, char* argv[])
         return 0;
     }  
 
+    // search with as many threads as we were given
+    sudoku->threads = MAX(threads, 1);
+
+    // 0 guesses by probability, 1 learns nogoods, 2 uses the sat solver, 3 races them all, 4 restarts at random and 5 picks one by difficulty
+    config.threshold = threshold;
+    config.maxguesses = maxguesses;
+    config.engine = engine;
+    config.seed = seed;
+    ApplySolverConfig(sudoku, &config);
+
     printf("_____________________________________________________________________\n"
            "|                    Welcome to sudoku solver v1.0                  |\n"
            "|                                                                   |\n"
@@ -88,6 +642,7 @@ int main(int argc, char* argv[])
            "| Example: 119 will put a 9 in the top left (x:1, y:1) value: 9     |\n"
            "| You can enter more than one number by separating them with spaces |\n"
            "| Leave the input blank to signal you are finished entering numbers |\n"
+           "| Enter ? for a hint at the next number to place                    |\n"
            "|___________________________________________________________________|\n");
 
     // a test sudoku board
@@ -120,6 +675,11 @@ int main(int argc, char* argv[])
     PlaceNumber(sudoku, 3, 8, 6);
     PlaceNumber(sudoku, 5, 8, 8);
     PlaceNumber(sudoku, 8, 8, 1);
+
+    // every allocator has to solve it the same
+    if (!__testallocators(sudoku)) {
+        printf("An allocator failed to solve the puzzle\n");
+    }
 #endif
 
     // output the board to start
@@ -137,6 +697,14 @@ int main(int argc, char* argv[])
         // start at 0 placed numbers this iteration
         placed_numbers = 0;
 
+        // explain the next step rather than placing anything
+        if (*ptr == '?') {
+            FindNextStep(sudoku, &step);
+            DescribeStep(&step, description, sizeof(description));
+            printf("%s\n", description);
+            continue;
+        }
+
         // loop till we hit the end of the user input
         while (*ptr != '\0') {
 
@@ -172,8 +740,8 @@ int main(int argc, char* argv[])
     // use finished input, solve the sudoku now
     printf("Attempting to solve...\n");
     
-    // if we solved the sudoku
-    if(SolveSudoku(sudoku)) {
+    // if we solved the sudoku, splitting the search between threads if we have more than one
+    if((sudoku->threads > 1 && sudoku->engine == ENGINE_PROBABILITY) ? SolveSudokuParallel(sudoku) : SolveSudoku(sudoku)) {
         // print whether we completed successfully or not
         printf("Successfully solved the puzzle\n");
     } else {
@@ -0,0 +1,483 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "SudokuAllocator.h"
+
+// the free lists of the calling thread, one for each size of block
+static _Thread_local PoolBlock *PoolFreeLists[POOLSIZECLASSES];
+
+//! Function to allocate memory from malloc
+/*!
+ *  @param      void *          Unused
+ *  @param      size_t          The number of bytes to allocate
+ *
+ *  @returns    void *          The memory or NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *SystemAllocate(void *user, size_t size)
+{
+    return malloc(size);
+}
+
+//! Function to resize memory with realloc
+/*!
+ *  @param      void *          Unused
+ *  @param      void *          The memory to resize
+ *  @param      size_t          Unused
+ *  @param      size_t          The number of bytes wanted
+ *
+ *  @returns    void *          The resized memory or NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *SystemReallocate(void *user, void *memory, size_t oldsize, size_t size)
+{
+    return realloc(memory, size);
+}
+
+//! Function to free memory with free
+/*!
+ *  @param      void *          Unused
+ *  @param      void *          The memory to free
+ *  @param      size_t          Unused
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void SystemRelease(void *user, void *memory, size_t size)
+{
+    free(memory);
+}
+
+const SudokuAllocator SystemAllocator = { SystemAllocate, SystemReallocate, SystemRelease, NULL };
+
+//! Function to find the free list an allocation belongs on
+/*!
+ *  @param      size_t          The number of bytes allocated
+ *
+ *  @returns    unsigned int    The size class, or POOLSIZECLASSES if it is too big to pool
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int PoolSizeClass(size_t size)
+{
+    unsigned int c = 0;
+    size_t block = POOLSMALLESTBLOCK;
+
+    // double the block until the allocation fits
+    while (c < POOLSIZECLASSES
+        && block < size) {
+        block *= 2;
+        c++;
+    }
+
+    return c;
+}
+
+//! Function to allocate memory from the calling thread's free lists
+/*!
+ *  @param      void *          Unused
+ *  @param      size_t          The number of bytes to allocate
+ *
+ *  @returns    void *          The memory or NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *PoolAllocate(void *user, size_t size)
+{
+    unsigned int c = PoolSizeClass(size);
+    PoolBlock *block = NULL;
+
+    // too big to pool
+    if (c == POOLSIZECLASSES) {
+        return malloc(size);
+    }
+
+    // reuse a block if we have one
+    if (PoolFreeLists[c]) {
+        block = PoolFreeLists[c];
+        PoolFreeLists[c] = block->next;
+        return block;
+    }
+
+    return malloc((size_t)POOLSMALLESTBLOCK << c);
+}
+
+//! Function to free memory onto the calling thread's free lists
+/*!
+ *  @param      void *          Unused
+ *  @param      void *          The memory to free
+ *  @param      size_t          The number of bytes allocated
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void PoolRelease(void *user, void *memory, size_t size)
+{
+    unsigned int c = PoolSizeClass(size);
+    PoolBlock *block = (PoolBlock*)memory;
+
+    // too big to pool
+    if (c == POOLSIZECLASSES) {
+        free(memory);
+        return;
+    }
+
+    block->next = PoolFreeLists[c];
+    PoolFreeLists[c] = block;
+}
+
+//! Function to resize memory from the calling thread's free lists
+/*!
+ *  @param      void *          Unused
+ *  @param      void *          The memory to resize
+ *  @param      size_t          The number of bytes allocated
+ *  @param      size_t          The number of bytes wanted
+ *
+ *  @returns    void *          The resized memory or NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *PoolReallocate(void *user, void *memory, size_t oldsize, size_t size)
+{
+    unsigned int oldclass = PoolSizeClass(oldsize), newclass = PoolSizeClass(size);
+    void *new_memory = NULL;
+
+    // still fits the block we have
+    if (oldclass == newclass
+        && newclass < POOLSIZECLASSES) {
+        return memory;
+    }
+
+    // neither is pooled so let the system resize it
+    if (oldclass == POOLSIZECLASSES
+        && newclass == POOLSIZECLASSES) {
+        return realloc(memory, size);
+    }
+
+    // move it to a block of the new size
+    new_memory = PoolAllocate(user, size);
+
+    if (!new_memory) {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, oldsize < size ? oldsize : size);
+    PoolRelease(user, memory, oldsize);
+
+    return new_memory;
+}
+
+const SudokuAllocator PoolAllocator = { PoolAllocate, PoolReallocate, PoolRelease, NULL };
+
+//! Function to hand out the next bytes of an arena that is already locked
+/*!
+ *  @param      SudokuArena *   The arena
+ *  @param      size_t          The number of bytes to allocate
+ *
+ *  @returns    void *          The memory, or NULL if the arena is full
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *ArenaBump(SudokuArena *arena, size_t size)
+{
+    size_t start = (arena->used + (ARENAALIGNMENT - 1)) & ~(size_t)(ARENAALIGNMENT - 1);
+
+    // make sure it fits
+    if (start > arena->size
+        || size > arena->size - start) {
+        return NULL;
+    }
+
+    arena->last = start;
+    arena->used = start + size;
+
+    return arena->memory + start;
+}
+
+//! Function to allocate memory from an arena
+/*!
+ *  @param      void *          The arena
+ *  @param      size_t          The number of bytes to allocate
+ *
+ *  @returns    void *          The memory, or NULL if the arena is full
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *ArenaAllocate(void *user, size_t size)
+{
+    SudokuArena *arena = (SudokuArena*)user;
+    void *memory = NULL;
+
+    pthread_mutex_lock(&arena->lock);
+    memory = ArenaBump(arena, size);
+    pthread_mutex_unlock(&arena->lock);
+
+    return memory;
+}
+
+//! Function to resize memory from an arena
+/*!
+ *  @param      void *          The arena
+ *  @param      void *          The memory to resize
+ *  @param      size_t          The number of bytes allocated
+ *  @param      size_t          The number of bytes wanted
+ *
+ *  @returns    void *          The resized memory, or NULL if the arena is full
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The newest allocation grows in place, anything older is copied to the end
+ */
+static void *ArenaReallocate(void *user, void *memory, size_t oldsize, size_t size)
+{
+    SudokuArena *arena = (SudokuArena*)user;
+    void *new_memory = NULL;
+
+    pthread_mutex_lock(&arena->lock);
+
+    if ((unsigned char*)memory == arena->memory + arena->last
+        && size <= arena->size - arena->last) {
+        // the newest allocation can move the end of the arena
+        arena->used = arena->last + size;
+        new_memory = memory;
+    } else if (size <= oldsize) {
+        // shrinking never needs to move
+        new_memory = memory;
+    } else if ((new_memory = ArenaBump(arena, size))) {
+        // copy it to the end
+        memcpy(new_memory, memory, oldsize);
+    }
+
+    pthread_mutex_unlock(&arena->lock);
+
+    return new_memory;
+}
+
+//! Function to free memory from an arena
+/*!
+ *  @param      void *          The arena
+ *  @param      void *          The memory to free
+ *  @param      size_t          Unused
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only the newest allocation is given back, everything else waits for ResetSudokuArena
+ */
+static void ArenaRelease(void *user, void *memory, size_t size)
+{
+    SudokuArena *arena = (SudokuArena*)user;
+
+    pthread_mutex_lock(&arena->lock);
+
+    if ((unsigned char*)memory == arena->memory + arena->last) {
+        arena->used = arena->last;
+    }
+
+    pthread_mutex_unlock(&arena->lock);
+}
+
+//! Function to allocate zeroed memory
+/*!
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *  @param      size_t          The number of bytes to allocate
+ *
+ *  @returns    void *          The memory or NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void *AllocateMemory(const SudokuAllocator *allocator, size_t size)
+{
+    void *memory = NULL;
+
+    // fall back on the system
+    if (!allocator) {
+        allocator = &SystemAllocator;
+    }
+
+    memory = allocator->allocate(allocator->user, size ? size : 1);
+
+    // everything starts zeroed like calloc
+    if (memory) {
+        memset(memory, 0, size);
+    }
+
+    return memory;
+}
+
+//! Function to grow or shrink an allocation
+/*!
+ *  @param      SudokuAllocator * The allocator the memory came from, or NULL for the system allocator
+ *  @param      void *          The memory to resize, or NULL to allocate
+ *  @param      size_t          The number of bytes currently allocated
+ *  @param      size_t          The number of bytes wanted, 0 to free the memory
+ *
+ *  @returns    void *          The resized memory, or NULL on failure or when freed
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: On failure the original memory is left allocated
+ */
+void *ReallocateMemory(const SudokuAllocator *allocator, void *memory, size_t oldsize, size_t size)
+{
+    // fall back on the system
+    if (!allocator) {
+        allocator = &SystemAllocator;
+    }
+
+    // nothing to resize yet
+    if (!memory) {
+        return size ? AllocateMemory(allocator, size) : NULL;
+    }
+
+    // resizing to nothing frees it
+    if (!size) {
+        FreeMemory(allocator, memory, oldsize);
+        return NULL;
+    }
+
+    return allocator->reallocate(allocator->user, memory, oldsize, size);
+}
+
+//! Function to free an allocation
+/*!
+ *  @param      SudokuAllocator * The allocator the memory came from, or NULL for the system allocator
+ *  @param      void *          The memory to free
+ *  @param      size_t          The number of bytes allocated
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void FreeMemory(const SudokuAllocator *allocator, void *memory, size_t size)
+{
+    // sanity
+    if (!memory) {
+        return;
+    }
+
+    // fall back on the system
+    if (!allocator) {
+        allocator = &SystemAllocator;
+    }
+
+    allocator->release(allocator->user, memory, size);
+}
+
+//! Function to initialize a bump arena
+/*!
+ *  @param      SudokuArena *   A pointer to the arena to initialize
+ *  @param      void *          The memory to hand out, or NULL for the arena to allocate it
+ *  @param      size_t          The number of bytes the arena can hand out
+ *
+ *  @returns    boolean         Whether the arena was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Hand &arena->allocator to a solver. Allocations fail once the arena is full,
+ *        which puts a hard limit on the memory a solve can use. Every allocation takes
+ *        a lock so the threads of a parallel or portfolio search can share one arena.
+ */
+bool InitializeSudokuArena(SudokuArena *arena, void *memory, size_t size)
+{
+    // sanity
+    if (!arena
+        || !size) {
+        return false;
+    }
+
+    memset(arena, 0, sizeof(SudokuArena));
+
+    // use the caller's memory if we were given some
+    arena->ownsmemory = !memory;
+    arena->memory = memory ? (unsigned char*)memory : (unsigned char*)malloc(size);
+
+    // sanity check it
+    if (!arena->memory) {
+        return false;
+    }
+
+    if (pthread_mutex_init(&arena->lock, NULL) != 0) {
+        if (arena->ownsmemory) {
+            free(arena->memory);
+        }
+
+        arena->memory = NULL;
+        return false;
+    }
+
+    arena->size = size;
+
+    // point the allocator back at us
+    arena->allocator.allocate = ArenaAllocate;
+    arena->allocator.reallocate = ArenaReallocate;
+    arena->allocator.release = ArenaRelease;
+    arena->allocator.user = arena;
+
+    return true;
+}
+
+//! Function to free everything handed out by an arena at once
+/*!
+ *  @param      SudokuArena *   A pointer to the arena to reset
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only reset an arena once every search using it has returned
+ */
+void ResetSudokuArena(SudokuArena *arena)
+{
+    // sanity
+    if (!arena
+        || !arena->memory) {
+        return;
+    }
+
+    pthread_mutex_lock(&arena->lock);
+    arena->used = 0;
+    arena->last = 0;
+    pthread_mutex_unlock(&arena->lock);
+}
+
+//! Function to cleanup an arena
+/*!
+ *  @param      SudokuArena *   A pointer to the arena to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Memory given by the caller is left for the caller to free
+ */
+void DestroySudokuArena(SudokuArena *arena)
+{
+    // sanity
+    if (!arena) {
+        return;
+    }
+
+    if (!arena->memory) {
+        return;
+    }
+
+    if (arena->ownsmemory) {
+        free(arena->memory);
+    }
+
+    pthread_mutex_destroy(&arena->lock);
+    memset(arena, 0, sizeof(SudokuArena));
+}
+
+//! Function to give the calling thread's pooled blocks back to the system
+/*!
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Call this before a thread that used the PoolAllocator exits
+ */
+void ReleasePoolMemory(void)
+{
+    unsigned int c = 0;
+    PoolBlock *block = NULL;
+
+    for (c = 0; c < POOLSIZECLASSES; ++c) {
+        while ((block = PoolFreeLists[c])) {
+            PoolFreeLists[c] = block->next;
+            free(block);
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef SUDOKU_ALLOCATOR_H
+#define SUDOKU_ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// every arena allocation starts on a multiple of this
+#define ARENAALIGNMENT 16
+
+// the pool keeps free lists for blocks of 16, 32, 64 ... 2048 bytes
+#define POOLSIZECLASSES 8
+#define POOLSMALLESTBLOCK 16
+
+// A structure defining where a solver gets its memory from
+typedef struct {
+    // allocates size bytes, returns NULL on failure
+    void *(*allocate)(void *user, size_t size);
+
+    // grows or shrinks an allocation of oldsize bytes to size bytes, returns NULL on failure
+    void *(*reallocate)(void *user, void *memory, size_t oldsize, size_t size);
+
+    // frees an allocation of size bytes
+    void (*release)(void *user, void *memory, size_t size);
+
+    // passed to every call
+    void *user;
+} SudokuAllocator;
+
+// A structure defining a freed block waiting on a pool free list
+typedef struct PoolBlock {
+    // the next free block of the same size
+    struct PoolBlock *next;
+} PoolBlock;
+
+// A structure defining a bump arena that is freed in one go
+typedef struct {
+    // the memory handed out
+    unsigned char *memory;
+
+    // the number of bytes of memory
+    size_t size;
+
+    // the number of bytes handed out so far
+    size_t used;
+
+    // where the newest allocation starts, so it can grow in place
+    size_t last;
+
+    // whether the arena allocated its memory itself
+    bool ownsmemory;
+
+    // lets the threads of a parallel search share the arena
+    pthread_mutex_t lock;
+
+    // the allocator that hands out this arena's memory
+    SudokuAllocator allocator;
+} SudokuArena;
+
+// allocates straight from malloc, realloc and free
+extern const SudokuAllocator SystemAllocator;
+
+// keeps freed blocks on free lists local to each thread for the next allocation of the same size
+extern const SudokuAllocator PoolAllocator;
+
+//! Function to allocate zeroed memory
+/*!
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *  @param      size_t          The number of bytes to allocate
+ *
+ *  @returns    void *          The memory or NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void *AllocateMemory(const SudokuAllocator *allocator, size_t size);
+
+//! Function to grow or shrink an allocation
+/*!
+ *  @param      SudokuAllocator * The allocator the memory came from, or NULL for the system allocator
+ *  @param      void *          The memory to resize, or NULL to allocate
+ *  @param      size_t          The number of bytes currently allocated
+ *  @param      size_t          The number of bytes wanted, 0 to free the memory
+ *
+ *  @returns    void *          The resized memory, or NULL on failure or when freed
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: On failure the original memory is left allocated
+ */
+void *ReallocateMemory(const SudokuAllocator *allocator, void *memory, size_t oldsize, size_t size);
+
+//! Function to free an allocation
+/*!
+ *  @param      SudokuAllocator * The allocator the memory came from, or NULL for the system allocator
+ *  @param      void *          The memory to free
+ *  @param      size_t          The number of bytes allocated
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void FreeMemory(const SudokuAllocator *allocator, void *memory, size_t size);
+
+//! Function to initialize a bump arena
+/*!
+ *  @param      SudokuArena *   A pointer to the arena to initialize
+ *  @param      void *          The memory to hand out, or NULL for the arena to allocate it
+ *  @param      size_t          The number of bytes the arena can hand out
+ *
+ *  @returns    boolean         Whether the arena was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Hand &arena->allocator to a solver. Allocations fail once the arena is full,
+ *        which puts a hard limit on the memory a solve can use. Every allocation takes
+ *        a lock so the threads of a parallel or portfolio search can share one arena.
+ */
+bool InitializeSudokuArena(SudokuArena *arena, void *memory, size_t size);
+
+//! Function to free everything handed out by an arena at once
+/*!
+ *  @param      SudokuArena *   A pointer to the arena to reset
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only reset an arena once every search using it has returned
+ */
+void ResetSudokuArena(SudokuArena *arena);
+
+//! Function to cleanup an arena
+/*!
+ *  @param      SudokuArena *   A pointer to the arena to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Memory given by the caller is left for the caller to free
+ */
+void DestroySudokuArena(SudokuArena *arena);
+
+//! Function to give the calling thread's pooled blocks back to the system
+/*!
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Call this before a thread that used the PoolAllocator exits
+ */
+void ReleasePoolMemory(void);
+
+#endif
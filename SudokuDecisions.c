@@ -0,0 +1,485 @@
+#include <string.h>
+
+#include "SudokuDecisions.h"
+#include "SudokuMetrics.h"
+
+// the most of the slowest decisions a profile lists
+#define PROFILESLOWEST  32
+
+// where each part of a decision sits within the 4 bytes it is packed into
+#define PACK_CELL(word)         ((word) & 0x7f)
+#define PACK_VALUE(word)        (((word) >> 7) & 0xf)
+#define PACK_KIND(word)         (((word) >> 11) & 0x3)
+#define PACK_DEPTH(word)        (((word) >> 13) & 0x7f)
+#define PACK_PROBABILITY(word)  (((word) >> 20) & 0x7f)
+
+// the log decisions are recorded into on this thread, NULL when this thread isn't recording
+_Thread_local DecisionLog *ActiveDecisions;
+
+//! Function to initialize an empty decision log
+/*!
+ *  @param      DecisionLog *   A pointer to the log to initialize
+ *  @param      unsigned int    The most decisions to keep, 0 for DECISIONCAPACITY
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the log was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeDecisionLog(DecisionLog *log, unsigned int capacity, const SudokuAllocator *allocator)
+{
+    // sanity
+    if (!log) {
+        return false;
+    }
+
+    memset(log, 0, sizeof(DecisionLog));
+
+    if (!capacity) {
+        capacity = DECISIONCAPACITY;
+    }
+
+    log->log.entries = AllocateMemory(allocator, capacity * sizeof(LogEntry));
+
+    if (!log->log.entries) {
+        return false;
+    }
+
+    log->capacity = capacity;
+    log->divergence = DECISIONSAGREED;
+    log->allocator = allocator;
+
+    return true;
+}
+
+//! Function to cleanup a decision log
+/*!
+ *  @param      DecisionLog *   A pointer to the log to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyDecisionLog(DecisionLog *log)
+{
+    // sanity
+    if (!log) {
+        return;
+    }
+
+    // never leave this thread recording into freed memory
+    if (ActiveDecisions == log) {
+        ActiveDecisions = NULL;
+    }
+
+    FreeMemory(log->allocator, log->ticks, (log->ticks ? log->capacity : 0) * sizeof(unsigned long long));
+    FreeMemory(log->allocator, log->log.entries, (log->log.entries ? log->capacity : 0) * sizeof(LogEntry));
+    memset(log, 0, sizeof(DecisionLog));
+}
+
+//! Function to start recording the decisions the calling thread makes solving a sudoku
+/*!
+ *  @param      DecisionLog *   A pointer to the log, emptied first
+ *  @param      Sudoku*         The sudoku about to be solved, its grid and settings are kept
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void BeginDecisionLog(DecisionLog *log, Sudoku *sudoku)
+{
+    unsigned int c = 0;
+
+    // sanity
+    if (!log
+        || !log->log.entries
+        || !sudoku) {
+        return;
+    }
+
+    // everything a replay needs to make the same decisions
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        log->givens[c] = (unsigned char)CELL_VALUE(sudoku, c);
+    }
+
+    memset(log->result, 0, sizeof(log->result));
+    log->engine = sudoku->engine;
+    log->threshold = sudoku->threshold;
+    log->maxguesscount = sudoku->maxguesscount;
+    log->seed = sudoku->seed;
+    log->candidatescorer = (sudoku->scorer == CandidateScore);
+    log->transpositions = (sudoku->transpositions != NULL);
+
+    log->log.count = 0;
+    log->made = 0;
+    log->replaying = false;
+    log->divergence = DECISIONSAGREED;
+    log->startnanoseconds = MetricsNanoseconds();
+    log->startticks = TraceTicks();
+    log->endticks = log->startticks;
+    log->endnanoseconds = log->startnanoseconds;
+
+    ActiveDecisions = log;
+}
+
+//! Function to stop recording the decisions of the calling thread
+/*!
+ *  @param      DecisionLog *   A pointer to the log being recorded into
+ *  @param      Sudoku*         The sudoku that was solved, its grid is kept as the result
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void EndDecisionLog(DecisionLog *log, Sudoku *sudoku)
+{
+    unsigned int c = 0;
+
+    // sanity
+    if (!log
+        || !log->log.entries) {
+        return;
+    }
+
+    log->endticks = TraceTicks();
+    log->endnanoseconds = MetricsNanoseconds();
+
+    if (ActiveDecisions == log) {
+        ActiveDecisions = NULL;
+    }
+
+    for (c = 0; sudoku && c < SUDOKU_CELLS; ++c) {
+        log->result[c] = (unsigned char)CELL_VALUE(sudoku, c);
+    }
+}
+
+//! Function to solve the puzzle of a log again and check every decision against it
+/*!
+ *  @param      DecisionLog *   A pointer to a log that has ended or was read from a file
+ *  @param      SudokuDispatcher * The dispatcher of ENGINE_ADAPTIVE solves, NULL for DefaultDispatcher
+ *  @param      boolean         Whether to stamp every decision with the ticks it was made at
+ *
+ *  @returns    unsigned int    The REPLAY_ outcome
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The solve runs on the calling thread with the engine, guess limit, seed and scorer
+ *        it was recorded with. REPLAY_DIVERGED leaves the first decision made differently in
+ *        the divergence of the log, REPLAY_PARTIAL means every decision the log kept agreed but
+ *        it filled up before the end, and REPLAY_FAILED that nothing could be replayed.
+ *        The times of the log become those of the replay
+ */
+unsigned int ReplayDecisionLog(DecisionLog *log, const struct SudokuDispatcher *dispatcher, bool profile)
+{
+    unsigned long long recorded = 0;
+    unsigned int c = 0;
+    DecisionLog *previous = NULL;
+    Sudoku sudoku;
+
+    // sanity
+    if (!log
+        || !log->log.entries
+        || !InitializeSudokuStorage(&sudoku, log->threshold, log->maxguesscount)) {
+        return REPLAY_FAILED;
+    }
+
+    // profiling stamps every decision the log holds
+    if (profile
+        && !log->ticks) {
+        log->ticks = AllocateMemory(log->allocator, log->capacity * sizeof(unsigned long long));
+
+        if (!log->ticks) {
+            return REPLAY_FAILED;
+        }
+    }
+
+    // the sudoku the log was recorded from
+    sudoku.verbose = false;
+    sudoku.engine = log->engine;
+    sudoku.seed = log->seed;
+    sudoku.scorer = log->candidatescorer ? CandidateScore : ProbabilityScore;
+    sudoku.dispatcher = dispatcher;
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        sudoku.grid[CellRow[c]][CellColumn[c]] = log->givens[c];
+    }
+
+    recorded = log->made;
+    log->made = 0;
+    log->replaying = true;
+    log->divergence = DECISIONSAGREED;
+
+    // whoever was recording on this thread carries on after us
+    previous = ActiveDecisions;
+    log->startnanoseconds = MetricsNanoseconds();
+    log->startticks = TraceTicks();
+    ActiveDecisions = log;
+
+    // the same step as the pipeline, which propagates the same as SolveSudoku does first
+    SearchSudokuEngine(&sudoku);
+
+    ActiveDecisions = previous;
+    log->endticks = TraceTicks();
+    log->endnanoseconds = MetricsNanoseconds();
+    log->replaying = false;
+
+    // stopping short of the log is a divergence too, as is finishing on another board
+    if (log->divergence == DECISIONSAGREED
+        && log->made != recorded) {
+        log->divergence = MIN(log->made, recorded);
+    }
+
+    for (c = 0; c < SUDOKU_CELLS && log->divergence == DECISIONSAGREED; ++c) {
+        if (CELL_VALUE(&sudoku, c) != log->result[c]) {
+            log->divergence = log->made;
+        }
+    }
+
+    if (log->divergence != DECISIONSAGREED) {
+        return REPLAY_DIVERGED;
+    }
+
+    return (recorded > log->log.count) ? REPLAY_PARTIAL : REPLAY_MATCHED;
+}
+
+#ifndef SUDOKU_NO_STDIO
+//! Function to write a decision log to a file
+/*!
+ *  @param      DecisionLog *   A pointer to a log that has ended
+ *  @param      char *          The file to write
+ *
+ *  @returns    boolean         Whether the log was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Each decision is packed into 4 bytes, in the byte order of the machine that wrote it
+ */
+bool WriteDecisionFile(const DecisionLog *log, const char *path)
+{
+    DecisionHeader header;
+    unsigned int packed[256];
+    unsigned int i = 0, n = 0;
+    const LogEntry *entry = NULL;
+    FILE *file = NULL;
+    bool written = false;
+
+    // sanity
+    if (!log
+        || !log->log.entries
+        || !path) {
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DECISIONMAGIC, sizeof(header.magic));
+    header.version = DECISIONVERSION;
+    header.count = log->log.count;
+    header.made = log->made;
+    header.startticks = log->startticks;
+    header.startnanoseconds = log->startnanoseconds;
+    header.endticks = log->endticks;
+    header.endnanoseconds = log->endnanoseconds;
+    header.seed = log->seed;
+    header.engine = log->engine;
+    header.threshold = log->threshold;
+    header.maxguesscount = log->maxguesscount;
+    header.candidatescorer = log->candidatescorer;
+    header.transpositions = log->transpositions;
+    memcpy(header.givens, log->givens, sizeof(header.givens));
+    memcpy(header.result, log->result, sizeof(header.result));
+
+    file = fopen(path, "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // pack the decisions a block at a time
+    for (i = 0; i < header.count && written; i += n) {
+        for (n = 0; n < 256 && i + n < header.count; ++n) {
+            entry = &log->log.entries[i + n];
+            packed[n] = CELL(entry->x, entry->y)
+                | (entry->value << 7)
+                | (DECISION_KIND(entry->id) << 11)
+                | ((DECISION_DEPTH(entry->id) & 0x7f) << 13)
+                | ((entry->probability & 0x7f) << 20);
+        }
+
+        written = fwrite(packed, sizeof(unsigned int), n, file) == n;
+    }
+
+    if (fclose(file) != 0) {
+        written = false;
+    }
+
+    return written;
+}
+
+//! Function to read a decision log written by WriteDecisionFile
+/*!
+ *  @param      DecisionLog *   A pointer to an initialized log, it grows to fit the file
+ *  @param      char *          The file to read
+ *
+ *  @returns    boolean         Whether the whole log was read
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ReadDecisionFile(DecisionLog *log, const char *path)
+{
+    DecisionHeader header;
+    LogEntry *entries = NULL;
+    unsigned int packed = 0, i = 0;
+    FILE *file = NULL;
+    bool complete = true;
+
+    // sanity
+    if (!log
+        || !log->log.entries
+        || !path) {
+        return false;
+    }
+
+    file = fopen(path, "rb");
+
+    if (!file) {
+        return false;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.magic, DECISIONMAGIC, sizeof(header.magic)) != 0
+        || header.version != DECISIONVERSION) {
+        fclose(file);
+        return false;
+    }
+
+    // make room for every decision in the file, a profile has to be stamped again after
+    if (header.count > log->capacity) {
+        entries = AllocateMemory(log->allocator, header.count * sizeof(LogEntry));
+
+        if (!entries) {
+            fclose(file);
+            return false;
+        }
+
+        FreeMemory(log->allocator, log->ticks, (log->ticks ? log->capacity : 0) * sizeof(unsigned long long));
+        FreeMemory(log->allocator, log->log.entries, log->capacity * sizeof(LogEntry));
+        log->log.entries = entries;
+        log->ticks = NULL;
+        log->capacity = header.count;
+    }
+
+    log->made = header.made;
+    log->startticks = header.startticks;
+    log->startnanoseconds = header.startnanoseconds;
+    log->endticks = header.endticks;
+    log->endnanoseconds = header.endnanoseconds;
+    log->seed = header.seed;
+    log->engine = header.engine;
+    log->threshold = header.threshold;
+    log->maxguesscount = header.maxguesscount;
+    log->candidatescorer = (header.candidatescorer != 0);
+    log->transpositions = (header.transpositions != 0);
+    log->replaying = false;
+    log->divergence = DECISIONSAGREED;
+    memcpy(log->givens, header.givens, sizeof(log->givens));
+    memcpy(log->result, header.result, sizeof(log->result));
+
+    for (i = 0; i < header.count; ++i) {
+        if (fread(&packed, sizeof(packed), 1, file) != 1
+            || PACK_CELL(packed) >= SUDOKU_CELLS) {
+            complete = false;
+            break;
+        }
+
+        log->log.entries[i].x = CellColumn[PACK_CELL(packed)];
+        log->log.entries[i].y = CellRow[PACK_CELL(packed)];
+        log->log.entries[i].value = PACK_VALUE(packed);
+        log->log.entries[i].probability = PACK_PROBABILITY(packed);
+        log->log.entries[i].id = DECISION_ID(PACK_KIND(packed), PACK_DEPTH(packed));
+    }
+
+    log->log.count = i;
+    fclose(file);
+
+    return complete;
+}
+
+//! Function to print where the time of a profiled replay went
+/*!
+ *  @param      DecisionLog *   A pointer to a log replayed with profiling
+ *  @param      unsigned int    The number of slowest decisions to list
+ *  @param      FILE *          Where to print
+ *
+ *  @returns    boolean         Whether there was a profile to print
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The time of a decision is the time since the decision before it, so a guess carries
+ *        the cost of ranking it and a placement the cost of the propagation that found it
+ */
+bool PrintDecisionProfile(const DecisionLog *log, unsigned int slowest, FILE *output)
+{
+    static const char *Kinds[] = { "place", "guess", "backtrack", "restart" };
+    unsigned long long counts[4] = { 0 }, totals[4] = { 0 };
+    unsigned long long elapsed[PROFILESLOWEST];
+    unsigned int positions[PROFILESLOWEST];
+    unsigned long long previous = 0, spent = 0;
+    unsigned int i = 0, k = 0, kept = 0, count = 0;
+    const LogEntry *entry = NULL;
+    double scale = 1.0;
+
+    // sanity
+    if (!log
+        || !log->ticks
+        || !output) {
+        return false;
+    }
+
+    // nanoseconds per tick, from the clocks read when the replay began and ended
+    if (log->endticks > log->startticks) {
+        scale = (double)(log->endnanoseconds - log->startnanoseconds) / (double)(log->endticks - log->startticks);
+    }
+
+    slowest = MIN(slowest, PROFILESLOWEST);
+    count = (unsigned int)MIN(log->made, (unsigned long long)log->log.count);
+    previous = log->startticks;
+
+    for (i = 0; i < count; ++i) {
+        spent = (log->ticks[i] > previous) ? log->ticks[i] - previous : 0;
+        previous = log->ticks[i];
+        k = DECISION_KIND(log->log.entries[i].id);
+        counts[k]++;
+        totals[k] += spent;
+
+        // keep the slowest in order, slowest first
+        for (k = kept; k > 0 && elapsed[k - 1] < spent; --k) {
+            if (k < slowest) {
+                elapsed[k] = elapsed[k - 1];
+                positions[k] = positions[k - 1];
+            }
+        }
+
+        if (k < slowest) {
+            elapsed[k] = spent;
+            positions[k] = i;
+            kept = MIN(kept + 1, slowest);
+        }
+    }
+
+    fprintf(output, "%u decisions in %.3fus\n", count, (double)(log->endnanoseconds - log->startnanoseconds) / 1000.0);
+
+    for (k = 0; k < 4; ++k) {
+        fprintf(output, "%-10s %8llu %12.3fus\n", Kinds[k], counts[k], (double)totals[k] * scale / 1000.0);
+    }
+
+    for (k = 0; k < kept; ++k) {
+        entry = &log->log.entries[positions[k]];
+        fprintf(output, "#%-8u %-10s r%uc%u %u depth %u %12.3fus\n",
+            positions[k],
+            Kinds[DECISION_KIND(entry->id)],
+            entry->y + 1,
+            entry->x + 1,
+            entry->value,
+            DECISION_DEPTH(entry->id),
+            (double)elapsed[k] * scale / 1000.0);
+    }
+
+    return true;
+}
+#endif
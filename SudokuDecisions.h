@@ -0,0 +1,291 @@
+#ifndef SUDOKU_DECISIONS_H
+#define SUDOKU_DECISIONS_H
+
+#include <stdbool.h>
+
+#include "SudokuSolver.h"
+
+// the number of decisions a log keeps when the caller doesn't say, 20 bytes each in memory and 4 in a file
+#define DECISIONCAPACITY  65536
+
+// the first bytes of every decision file, and the version of the layout after them
+#define DECISIONMAGIC     "SDKDECIS"
+#define DECISIONVERSION   1
+
+// the decisions a log records
+#define DECISION_PLACE      0
+#define DECISION_GUESS      1
+#define DECISION_BACKTRACK  2
+#define DECISION_RESTART    3
+
+// the id of each entry holds its decision and the guess depth it was made at
+#define DECISION_ID(kind, depth)  (((depth) << 2) | (kind))
+#define DECISION_KIND(id)         ((id) & 3)
+#define DECISION_DEPTH(id)        ((id) >> 2)
+
+// the divergence of a replay that agreed with every decision
+#define DECISIONSAGREED   (~0ull)
+
+// the outcomes of replaying a log
+#define REPLAY_MATCHED    0
+#define REPLAY_DIVERGED   1
+#define REPLAY_PARTIAL    2
+#define REPLAY_FAILED     3
+
+// A structure defining the decisions made while solving one puzzle, and what it takes to make them again
+typedef struct {
+    // the decisions in the order they were made, a guess is followed by the placement it made
+    Log log;
+
+    // the most decisions kept, later ones are only counted
+    unsigned int capacity;
+
+    // the number of decisions made, more than the log holds when it filled up
+    unsigned long long made;
+
+    // whether decisions are checked against the log rather than added to it
+    bool replaying;
+
+    // the first decision a replay disagreed with, DECISIONSAGREED while it hasn't
+    unsigned long long divergence;
+
+    // the ticks each decision was made at while profiling a replay, NULL otherwise
+    unsigned long long *ticks;
+
+    // the ticks and time the log began and ended, so ticks can be turned into time
+    unsigned long long startticks;
+    unsigned long long startnanoseconds;
+    unsigned long long endticks;
+    unsigned long long endnanoseconds;
+
+    // the puzzle that was solved, 1 - 9 for givens and 0 for blanks
+    unsigned char givens[SUDOKU_CELLS];
+
+    // the board the solve finished with
+    unsigned char result[SUDOKU_CELLS];
+
+    // the ENGINE_ the puzzle was searched with
+    unsigned int engine;
+
+    // the minimum guess threshold % of the solve
+    unsigned int threshold;
+
+    // the maximum number of consecutive guesses of the solve
+    unsigned int maxguesscount;
+
+    // the seed of the solve
+    unsigned long long seed;
+
+    // whether guesses were scored with CandidateScore rather than ProbabilityScore
+    bool candidatescorer;
+
+    // whether the solve shared a transposition table, whose earlier contents a replay can't have
+    bool transpositions;
+
+    // where the log gets its memory from
+    const SudokuAllocator *allocator;
+} DecisionLog;
+
+// A structure defining the header of a decision file, the decisions follow packed 4 bytes each
+typedef struct {
+    // DECISIONMAGIC without its terminator
+    char magic[8];
+
+    // DECISIONVERSION
+    unsigned int version;
+
+    // the number of decisions in the file
+    unsigned int count;
+
+    // the number of decisions made, more than the count when the log filled up
+    unsigned long long made;
+
+    // the ticks and time the log began and ended
+    unsigned long long startticks;
+    unsigned long long startnanoseconds;
+    unsigned long long endticks;
+    unsigned long long endnanoseconds;
+
+    // the seed of the solve
+    unsigned long long seed;
+
+    // the ENGINE_, threshold and guess limit of the solve
+    unsigned int engine;
+    unsigned int threshold;
+    unsigned int maxguesscount;
+
+    // whether the solve scored guesses with CandidateScore, and shared a transposition table
+    unsigned char candidatescorer;
+    unsigned char transpositions;
+
+    // the puzzle that was solved and the board it finished with
+    unsigned char givens[SUDOKU_CELLS];
+    unsigned char result[SUDOKU_CELLS];
+} DecisionHeader;
+
+// the log decisions are recorded into on this thread, NULL when this thread isn't recording
+extern _Thread_local DecisionLog *ActiveDecisions;
+
+//! Function to record a decision, or check it against the log when replaying
+/*!
+ *  @param      DecisionLog *   A pointer to the log
+ *  @param      unsigned int    The DECISION_
+ *  @param      unsigned int    The cell from 0 - 80
+ *  @param      unsigned int    The value
+ *  @param      unsigned int    The score of a guess
+ *  @param      unsigned int    The guess depth
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The log belongs to the calling thread so nothing is locked
+ */
+static inline void RecordDecision(DecisionLog *log, unsigned int kind, unsigned int cell, unsigned int value, unsigned int probability, unsigned int depth)
+{
+    unsigned long long position = log->made++;
+    LogEntry *entry = NULL;
+
+    if (position >= log->capacity) {
+        return;
+    }
+
+    if (log->ticks) {
+        log->ticks[position] = TraceTicks();
+    }
+
+    entry = &log->log.entries[position];
+
+    // a replay only has to notice the first decision that differs
+    if (log->replaying) {
+        if (log->divergence == DECISIONSAGREED
+            && (position >= log->log.count
+                || entry->x != CellColumn[cell]
+                || entry->y != CellRow[cell]
+                || entry->value != value
+                || entry->probability != probability
+                || entry->id != DECISION_ID(kind, depth))) {
+            log->divergence = position;
+        }
+
+        return;
+    }
+
+    entry->x = CellColumn[cell];
+    entry->y = CellRow[cell];
+    entry->value = value;
+    entry->probability = probability;
+    entry->id = DECISION_ID(kind, depth);
+    log->log.count++;
+}
+
+// records a decision if this thread is recording, building with SUDOKU_NO_DECISIONS removes every decision
+#ifdef SUDOKU_NO_DECISIONS
+#define DECISION_EVENT(kind, cell, value, probability, depth)  ((void)0)
+#else
+#define DECISION_EVENT(kind, cell, value, probability, depth) \
+    do { \
+        if (ActiveDecisions) { \
+            RecordDecision(ActiveDecisions, (kind), (cell), (value), (probability), (depth)); \
+        } \
+    } while (0)
+#endif
+
+//! Function to initialize an empty decision log
+/*!
+ *  @param      DecisionLog *   A pointer to the log to initialize
+ *  @param      unsigned int    The most decisions to keep, 0 for DECISIONCAPACITY
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the log was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeDecisionLog(DecisionLog *log, unsigned int capacity, const SudokuAllocator *allocator);
+
+//! Function to cleanup a decision log
+/*!
+ *  @param      DecisionLog *   A pointer to the log to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyDecisionLog(DecisionLog *log);
+
+//! Function to start recording the decisions the calling thread makes solving a sudoku
+/*!
+ *  @param      DecisionLog *   A pointer to the log, emptied first
+ *  @param      Sudoku*         The sudoku about to be solved, its grid and settings are kept
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void BeginDecisionLog(DecisionLog *log, Sudoku *sudoku);
+
+//! Function to stop recording the decisions of the calling thread
+/*!
+ *  @param      DecisionLog *   A pointer to the log being recorded into
+ *  @param      Sudoku*         The sudoku that was solved, its grid is kept as the result
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void EndDecisionLog(DecisionLog *log, Sudoku *sudoku);
+
+//! Function to solve the puzzle of a log again and check every decision against it
+/*!
+ *  @param      DecisionLog *   A pointer to a log that has ended or was read from a file
+ *  @param      SudokuDispatcher * The dispatcher of ENGINE_ADAPTIVE solves, NULL for DefaultDispatcher
+ *  @param      boolean         Whether to stamp every decision with the ticks it was made at
+ *
+ *  @returns    unsigned int    The REPLAY_ outcome
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The solve runs on the calling thread with the engine, guess limit, seed and scorer
+ *        it was recorded with. REPLAY_DIVERGED leaves the first decision made differently in
+ *        the divergence of the log, REPLAY_PARTIAL means every decision the log kept agreed but
+ *        it filled up before the end, and REPLAY_FAILED that nothing could be replayed.
+ *        The times of the log become those of the replay
+ */
+unsigned int ReplayDecisionLog(DecisionLog *log, const struct SudokuDispatcher *dispatcher, bool profile);
+
+#ifndef SUDOKU_NO_STDIO
+#include <stdio.h>
+
+//! Function to write a decision log to a file
+/*!
+ *  @param      DecisionLog *   A pointer to a log that has ended
+ *  @param      char *          The file to write
+ *
+ *  @returns    boolean         Whether the log was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Each decision is packed into 4 bytes, in the byte order of the machine that wrote it
+ */
+bool WriteDecisionFile(const DecisionLog *log, const char *path);
+
+//! Function to read a decision log written by WriteDecisionFile
+/*!
+ *  @param      DecisionLog *   A pointer to an initialized log, it grows to fit the file
+ *  @param      char *          The file to read
+ *
+ *  @returns    boolean         Whether the whole log was read
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ReadDecisionFile(DecisionLog *log, const char *path);
+
+//! Function to print where the time of a profiled replay went
+/*!
+ *  @param      DecisionLog *   A pointer to a log replayed with profiling
+ *  @param      unsigned int    The number of slowest decisions to list
+ *  @param      FILE *          Where to print
+ *
+ *  @returns    boolean         Whether there was a profile to print
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The time of a decision is the time since the decision before it, so a guess carries
+ *        the cost of ranking it and a placement the cost of the propagation that found it
+ */
+bool PrintDecisionProfile(const DecisionLog *log, unsigned int slowest, FILE *output);
+#endif
+
+#endif
@@ -0,0 +1,390 @@
+#include "SudokuDispatch.h"
+#include "SudokuParallel.h"
+
+// the engines a dispatcher is trained on, a parallel search of the first one is timed after them
+static const unsigned int DispatchEngines[] = { ENGINE_PROBABILITY, ENGINE_LEARNING, ENGINE_SAT, ENGINE_RESTARTS };
+
+#define DISPATCHENGINES  (sizeof(DispatchEngines) / sizeof(DispatchEngines[0]))
+#define DISPATCHCHOICES  (DISPATCHENGINES + 1)
+
+// a choice that gave up on a puzzle another choice solved
+#define DISPATCHREJECTED (~0ull)
+
+// probability search beat every other engine at every difficulty of the corpus on a single core
+const SudokuDispatcher DefaultDispatcher = {
+    { 0 },
+    { ENGINE_PROBABILITY },
+    { false },
+    1
+};
+
+//! Function to put a puzzle on a board and propagate it
+/*!
+ *  @param      Sudoku*         A pointer to the board
+ *  @param      unsigned int[9][9] The puzzle
+ *  @param      unsigned int *  Receives the cells propagation placed
+ *
+ *  @returns    unsigned int    The PROPAGATE_ result
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int LoadTrainingPuzzle(Sudoku *sudoku, const unsigned int grid[9][9], unsigned int *forced)
+{
+    unsigned int empty = 0, result = PROPAGATE_INCOMPLETE;
+
+    ResetSudoku(sudoku);
+    memcpy(sudoku->grid, grid, sizeof(sudoku->grid));
+
+    empty = CountEmptyCells(sudoku);
+    result = PropagateSudoku(sudoku);
+    *forced = empty - CountEmptyCells(sudoku);
+
+    return result;
+}
+
+//! Function to search a propagated board with one of the choices a dispatcher makes
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      unsigned int    The ENGINE_ to search with
+ *  @param      boolean         Whether to search with SearchSudokuParallel over the threads of the sudoku
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool SearchDispatched(Sudoku *sudoku, unsigned int engine, bool parallel)
+{
+    unsigned int adaptive = sudoku->engine;
+    bool solved = false;
+
+    // search as the chosen engine so nothing below dispatches again
+    sudoku->engine = (engine == ENGINE_ADAPTIVE) ? ENGINE_PROBABILITY : engine;
+
+    if (parallel
+        && sudoku->threads > 1
+        && sudoku->engine == ENGINE_PROBABILITY) {
+        solved = SearchSudokuParallel(sudoku, sudoku->threads, 1) > 0;
+    } else {
+        solved = SearchSudokuEngine(sudoku);
+    }
+
+    sudoku->engine = adaptive;
+
+    return solved;
+}
+
+//! Function to order difficulties from easiest to hardest
+/*!
+ *  @param      void *          The first unsigned int
+ *  @param      void *          The second unsigned int
+ *
+ *  @returns    int             Less than 0 if the first is easier
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static int CompareScores(const void *first, const void *second)
+{
+    unsigned int a = *(const unsigned int*)first;
+    unsigned int b = *(const unsigned int*)second;
+
+    return (a > b) - (a < b);
+}
+
+//! Function to measure a board left by propagation
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object after propagating
+ *  @param      unsigned int    The cells propagation placed
+ *  @param      DifficultyFeatures * Receives the measurements
+ *
+ *  @returns    boolean         Whether the board could be measured, false if its candidates are dead
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool EstimateDifficulty(Sudoku *sudoku, unsigned int forced, DifficultyFeatures *features)
+{
+    unsigned int c = 0, count = 0;
+
+    // sanity
+    if (!sudoku
+        || !features) {
+        return false;
+    }
+
+    memset(features, 0, sizeof(DifficultyFeatures));
+    features->forced = forced;
+    features->fewest = 10;
+
+    // make sure our candidates match the grid
+    if (!RefreshCandidates(sudoku)) {
+        return false;
+    }
+
+    // a single pass over the empty cells
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        if (CELL_VALUE(sudoku, c)) {
+            continue;
+        }
+
+        count = POPCOUNT(CELL_CANDIDATES(sudoku, c));
+
+        features->empty++;
+        features->candidates += count;
+        features->bivalue += (count == 2);
+        features->fewest = MIN(features->fewest, count);
+    }
+
+    if (!features->empty) {
+        features->fewest = 0;
+    }
+
+    return true;
+}
+
+//! Function to boil the measurements of a board down to a single difficulty
+/*!
+ *  @param      DifficultyFeatures * The measurements
+ *
+ *  @returns    unsigned int    The difficulty, 0 for a solved board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every candidate beyond the one each empty cell keeps is a way to go wrong, cells with
+ *        two candidates only offer one so they count for less, and propagation that stalled
+ *        early leaves more of the board for the search to work out, so every empty cell beyond
+ *        the number propagation placed adds one more
+ */
+unsigned int DifficultyScore(const DifficultyFeatures *features)
+{
+    // sanity
+    if (!features
+        || !features->empty) {
+        return 0;
+    }
+
+    return ((features->candidates - features->empty) * 2) - features->bivalue
+        + (features->empty > features->forced ? features->empty - features->forced : 0);
+}
+
+//! Function to find the bucket a difficulty falls in
+/*!
+ *  @param      SudokuDispatcher * The dispatcher
+ *  @param      unsigned int    The difficulty from DifficultyScore
+ *
+ *  @returns    unsigned int    The bucket from 0
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int DispatchBucket(const SudokuDispatcher *dispatcher, unsigned int score)
+{
+    unsigned int b = 0, count = 0;
+
+    // sanity
+    if (!dispatcher) {
+        return 0;
+    }
+
+    count = MIN(MAX(dispatcher->count, 1), DISPATCHBUCKETS);
+
+    // the last bucket that starts at or below the score
+    for (b = 1; b < count && dispatcher->bounds[b] <= score; ++b);
+
+    return b - 1;
+}
+
+//! Function which searches for a solution with the cheapest engine for how hard the puzzle looks
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      SudokuDispatcher * The buckets to choose from, or NULL for the sudoku's own
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The board is propagated first and returned straight away if that settles it, most
+ *        puzzles never get further. The rest are measured and searched with their bucket's
+ *        engine, sudokus without a dispatcher use DefaultDispatcher
+ */
+bool SearchSudokuAdaptive(Sudoku *sudoku, const SudokuDispatcher *dispatcher)
+{
+    unsigned int empty = 0, bucket = 0;
+    DifficultyFeatures features;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    if (!dispatcher) {
+        dispatcher = sudoku->dispatcher ? sudoku->dispatcher : &DefaultDispatcher;
+    }
+
+    // singles alone settle most puzzles, there's nothing to choose for those
+    empty = CountEmptyCells(sudoku);
+
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            return false;
+    }
+
+    if (!EstimateDifficulty(sudoku, empty - CountEmptyCells(sudoku), &features)) {
+        return false;
+    }
+
+    bucket = DispatchBucket(dispatcher, DifficultyScore(&features));
+
+    return SearchDispatched(sudoku, dispatcher->engines[bucket], dispatcher->parallel[bucket]);
+}
+
+//! Function to learn the buckets of a dispatcher by timing every engine on a corpus
+/*!
+ *  @param      SudokuDispatcher * Receives the buckets
+ *  @param      unsigned int[][9][9] The puzzles to time, 0 for an empty cell
+ *  @param      unsigned int    The number of puzzles
+ *  @param      unsigned int    The threads parallel searches are timed with, 1 to never search in parallel
+ *  @param      unsigned int    The maximum number of consecutive guesses
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether any puzzle needed a search, the dispatcher is untouched otherwise
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The bounds split the puzzles that need a search into buckets of about the same size.
+ *        Each bucket gets the engine that searched its puzzles fastest in total, an engine
+ *        that gave up on a puzzle another one solved is never picked for that bucket
+ */
+bool TrainSudokuDispatcher(SudokuDispatcher *dispatcher, const unsigned int (*puzzles)[9][9], unsigned int count, unsigned int threads, unsigned int maxguesses, const SudokuAllocator *allocator)
+{
+    unsigned long long totals[DISPATCHBUCKETS][DISPATCHCHOICES];
+    unsigned long long started = 0, elapsed = 0, best = 0;
+    unsigned int *scores = NULL, *sorted = NULL;
+    unsigned int i = 0, b = 0, e = 0, n = 0, forced = 0, buckets = 0, choices = 0, choice = 0;
+    unsigned char *solvedby = NULL;
+    SudokuDispatcher trained;
+    DifficultyFeatures features;
+    Sudoku sudoku;
+    bool solved = false;
+
+    // sanity
+    if (!dispatcher
+        || !puzzles
+        || !count) {
+        return false;
+    }
+
+    scores = (unsigned int*)AllocateMemory(allocator, count * sizeof(unsigned int));
+    sorted = (unsigned int*)AllocateMemory(allocator, count * sizeof(unsigned int));
+    solvedby = (unsigned char*)AllocateMemory(allocator, count);
+
+    if (!scores
+        || !sorted
+        || !solvedby) {
+        FreeMemory(allocator, scores, count * sizeof(unsigned int));
+        FreeMemory(allocator, sorted, count * sizeof(unsigned int));
+        FreeMemory(allocator, solvedby, count);
+        return false;
+    }
+
+    InitializeSudokuStorage(&sudoku, 0, maxguesses);
+    sudoku.verbose = false;
+    sudoku.threads = MAX(threads, 1);
+
+    // measure every puzzle that propagation alone doesn't settle
+    for (i = 0; i < count; ++i) {
+        scores[i] = 0;
+
+        if (LoadTrainingPuzzle(&sudoku, puzzles[i], &forced) == PROPAGATE_INCOMPLETE
+            && EstimateDifficulty(&sudoku, forced, &features)) {
+            scores[i] = DifficultyScore(&features);
+            sorted[n++] = scores[i];
+        }
+    }
+
+    if (!n) {
+        FreeMemory(allocator, scores, count * sizeof(unsigned int));
+        FreeMemory(allocator, sorted, count * sizeof(unsigned int));
+        FreeMemory(allocator, solvedby, count);
+        return false;
+    }
+
+    // split them into buckets of about the same size, equal difficulties can't be split
+    qsort(sorted, n, sizeof(unsigned int), CompareScores);
+    memset(&trained, 0, sizeof(SudokuDispatcher));
+    trained.count = 1;
+
+    for (b = 1; b < DISPATCHBUCKETS; ++b) {
+        i = (unsigned int)(((unsigned long long)n * b) / DISPATCHBUCKETS);
+
+        if (sorted[i] > trained.bounds[trained.count - 1]) {
+            trained.bounds[trained.count++] = sorted[i];
+        }
+    }
+
+    buckets = trained.count;
+    choices = (threads > 1) ? DISPATCHCHOICES : DISPATCHENGINES;
+    memset(totals, 0, sizeof(totals));
+
+    // time every choice on every puzzle, remembering which puzzles anything could solve
+    for (e = 0; e < choices; ++e) {
+        for (i = 0; i < count; ++i) {
+            if (LoadTrainingPuzzle(&sudoku, puzzles[i], &forced) != PROPAGATE_INCOMPLETE) {
+                continue;
+            }
+
+            b = DispatchBucket(&trained, scores[i]);
+
+            started = MetricsNanoseconds();
+            solved = SearchDispatched(&sudoku,
+                (e < DISPATCHENGINES) ? DispatchEngines[e] : ENGINE_PROBABILITY,
+                e >= DISPATCHENGINES);
+            elapsed = MetricsNanoseconds() - started;
+
+            if (totals[b][e] != DISPATCHREJECTED) {
+                totals[b][e] += elapsed;
+            }
+
+            // bit e is set for every choice that solved the puzzle
+            solvedby[i] |= (unsigned char)(solved << e);
+        }
+    }
+
+    // a choice that missed a solution someone else found can't be trusted with the bucket
+    for (i = 0; i < count; ++i) {
+        if (!solvedby[i]) {
+            continue;
+        }
+
+        b = DispatchBucket(&trained, scores[i]);
+
+        for (e = 0; e < choices; ++e) {
+            if (!(solvedby[i] & (1 << e))) {
+                totals[b][e] = DISPATCHREJECTED;
+            }
+        }
+    }
+
+    // each bucket gets its fastest choice, probability search when nothing else could be trusted
+    for (b = 0; b < buckets; ++b) {
+        choice = 0;
+        best = totals[b][0];
+
+        for (e = 1; e < choices; ++e) {
+            if (totals[b][e] < best) {
+                best = totals[b][e];
+                choice = e;
+            }
+        }
+
+        trained.engines[b] = (choice < DISPATCHENGINES) ? DispatchEngines[choice] : ENGINE_PROBABILITY;
+        trained.parallel[b] = (choice >= DISPATCHENGINES);
+    }
+
+    *dispatcher = trained;
+
+    FreeMemory(allocator, scores, count * sizeof(unsigned int));
+    FreeMemory(allocator, sorted, count * sizeof(unsigned int));
+    FreeMemory(allocator, solvedby, count);
+
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef SUDOKU_DISPATCH_H
+#define SUDOKU_DISPATCH_H
+
+#include <stdbool.h>
+
+#include "SudokuSolver.h"
+
+// the most difficulty buckets a dispatcher splits puzzles into
+#define DISPATCHBUCKETS  8
+
+// A structure defining what a board left by propagation looks like
+typedef struct {
+    // the cells propagation placed
+    unsigned int forced;
+
+    // the cells still empty
+    unsigned int empty;
+
+    // the candidates of every empty cell added together
+    unsigned int candidates;
+
+    // the empty cells with exactly two candidates
+    unsigned int bivalue;
+
+    // the fewest candidates of any empty cell
+    unsigned int fewest;
+} DifficultyFeatures;
+
+// A structure defining which engine each difficulty of puzzle is searched with
+typedef struct SudokuDispatcher {
+    // the lowest difficulty score of each bucket, the first is always 0 and the rest go up
+    unsigned int bounds[DISPATCHBUCKETS];
+
+    // the ENGINE_ each bucket is searched with
+    unsigned int engines[DISPATCHBUCKETS];
+
+    // whether each bucket is searched with SearchSudokuParallel when the sudoku has threads to spare
+    bool parallel[DISPATCHBUCKETS];
+
+    // the number of buckets in use
+    unsigned int count;
+} SudokuDispatcher;
+
+// the buckets trained on a corpus of random, hard and adversarial puzzles, used when a sudoku has no dispatcher
+extern const SudokuDispatcher DefaultDispatcher;
+
+//! Function to measure a board left by propagation
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object after propagating
+ *  @param      unsigned int    The cells propagation placed
+ *  @param      DifficultyFeatures * Receives the measurements
+ *
+ *  @returns    boolean         Whether the board could be measured, false if its candidates are dead
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool EstimateDifficulty(Sudoku *sudoku, unsigned int forced, DifficultyFeatures *features);
+
+//! Function to boil the measurements of a board down to a single difficulty
+/*!
+ *  @param      DifficultyFeatures * The measurements
+ *
+ *  @returns    unsigned int    The difficulty, 0 for a solved board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every candidate beyond the one each empty cell keeps is a way to go wrong, cells with
+ *        two candidates only offer one so they count for less, and propagation that stalled
+ *        early leaves more of the board for the search to work out, so every empty cell beyond
+ *        the number propagation placed adds one more
+ */
+unsigned int DifficultyScore(const DifficultyFeatures *features);
+
+//! Function to find the bucket a difficulty falls in
+/*!
+ *  @param      SudokuDispatcher * The dispatcher
+ *  @param      unsigned int    The difficulty from DifficultyScore
+ *
+ *  @returns    unsigned int    The bucket from 0
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int DispatchBucket(const SudokuDispatcher *dispatcher, unsigned int score);
+
+//! Function which searches for a solution with the cheapest engine for how hard the puzzle looks
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      SudokuDispatcher * The buckets to choose from, or NULL for the sudoku's own
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The board is propagated first and returned straight away if that settles it, most
+ *        puzzles never get further. The rest are measured and searched with their bucket's
+ *        engine, sudokus without a dispatcher use DefaultDispatcher
+ */
+bool SearchSudokuAdaptive(Sudoku *sudoku, const SudokuDispatcher *dispatcher);
+
+//! Function to learn the buckets of a dispatcher by timing every engine on a corpus
+/*!
+ *  @param      SudokuDispatcher * Receives the buckets
+ *  @param      unsigned int[][9][9] The puzzles to time, 0 for an empty cell
+ *  @param      unsigned int    The number of puzzles
+ *  @param      unsigned int    The threads parallel searches are timed with, 1 to never search in parallel
+ *  @param      unsigned int    The maximum number of consecutive guesses
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether any puzzle needed a search, the dispatcher is untouched otherwise
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The bounds split the puzzles that need a search into buckets of about the same size.
+ *        Each bucket gets the engine that searched its puzzles fastest in total, an engine
+ *        that gave up on a puzzle another one solved is never picked for that bucket
+ */
+bool TrainSudokuDispatcher(SudokuDispatcher *dispatcher, const unsigned int (*puzzles)[9][9], unsigned int count, unsigned int threads, unsigned int maxguesses, const SudokuAllocator *allocator);
+
+#endif
@@ -0,0 +1,362 @@
+#include <string.h>
+
+#include "SudokuEditor.h"
+#include "SudokuParallel.h"
+
+//! Function to place everything the givens of an editor force
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *
+ *  @returns    unsigned int    The PROPAGATE_ result
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int PropagateEditor(SudokuEditor *editor)
+{
+    CopySudoku(editor->propagated, editor->givens);
+
+    return PropagateSudoku(editor->propagated);
+}
+
+//! Function to search the propagated board of an editor for solutions
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int    The number of solutions to stop at
+ *
+ *  @returns    unsigned int    The number of solutions found, the first is left on the board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int SearchEditor(SudokuEditor *editor, unsigned int limit)
+{
+    editor->searched++;
+
+    // search a copy so the propagated board is there for the next edit
+    CopySudoku(editor->board, editor->propagated);
+
+    return SearchSudokuParallel(editor->board, editor->threads, limit);
+}
+
+//! Function to work out what the givens of an editor add up to from scratch
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int EvaluateEditor(SudokuEditor *editor)
+{
+    unsigned int solutions = 0;
+
+    editor->alternativevalid = false;
+
+    // a value twice in a unit breaks the rules before there is anything to solve
+    UpdateCandidates(editor->givens);
+
+    if (editor->givens->contradiction == CONTRADICTION_DUPLICATE) {
+        editor->status = EDIT_INVALID;
+        return editor->status;
+    }
+
+    switch (PropagateEditor(editor)) {
+        case PROPAGATE_CONTRADICTION:
+            editor->status = EDIT_UNSOLVABLE;
+            return editor->status;
+        case PROPAGATE_COMPLETE:
+            memcpy(editor->solution, editor->propagated->grid, sizeof(editor->solution));
+            editor->status = EDIT_UNIQUE;
+            return editor->status;
+    }
+
+    // a second solution is all it takes to show the givens aren't unique
+    solutions = SearchEditor(editor, 2);
+
+    if (!solutions) {
+        editor->status = EDIT_UNSOLVABLE;
+        return editor->status;
+    }
+
+    memcpy(editor->solution, editor->board->grid, sizeof(editor->solution));
+    editor->status = (solutions > 1) ? EDIT_MULTIPLE : EDIT_UNIQUE;
+
+    return editor->status;
+}
+
+//! Function to initialize an editor holding an empty puzzle
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor to initialize
+ *  @param      unsigned int    The number of threads to search with
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the editor was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudokuEditor(SudokuEditor *editor, unsigned int threads, const SudokuAllocator *allocator)
+{
+    // sanity
+    if (!editor) {
+        return false;
+    }
+
+    memset(editor, 0, sizeof(SudokuEditor));
+
+    editor->threads = MAX(threads, 1);
+    editor->allocator = allocator;
+
+    // every board may guess as deep as it needs to, so a search is never cut short
+    if (!InitializeSudokuWithAllocator(&editor->givens, 0, SUDOKU_CELLS, allocator)
+        || !InitializeSudokuWithAllocator(&editor->propagated, 0, SUDOKU_CELLS, allocator)
+        || !InitializeSudokuWithAllocator(&editor->board, 0, SUDOKU_CELLS, allocator)) {
+        DestroySudokuEditor(editor);
+        return false;
+    }
+
+    editor->givens->verbose = false;
+    editor->propagated->verbose = false;
+    editor->board->verbose = false;
+
+    EvaluateEditor(editor);
+
+    return true;
+}
+
+//! Function to cleanup an editor
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroySudokuEditor(SudokuEditor *editor)
+{
+    // sanity
+    if (!editor) {
+        return;
+    }
+
+    DestroySudoku(editor->givens);
+    DestroySudoku(editor->propagated);
+    DestroySudoku(editor->board);
+
+    memset(editor, 0, sizeof(SudokuEditor));
+}
+
+//! Function to replace every given of an editor and solve them from scratch
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int[9][9] The givens, 0 for an empty cell
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int LoadEditorPuzzle(SudokuEditor *editor, const unsigned int grid[9][9])
+{
+    // sanity
+    if (!editor
+        || !editor->givens
+        || !grid) {
+        return EDIT_INVALID;
+    }
+
+    memcpy(editor->givens->grid, grid, sizeof(editor->givens->grid));
+    editor->givens->candidatesvalid = false;
+    editor->givens->branchvalid = false;
+
+    return EvaluateEditor(editor);
+}
+
+//! Function to place a given, changing the one already there
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int    The x position of the cell from 0 - 8
+ *  @param      unsigned int    The y position of the cell from 0 - 8
+ *  @param      unsigned int    The value to place from 1 - 9
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A placement only narrows the solutions, so the known solutions answer it
+ *        without a search unless the puzzle had more than one and they both disagree
+ */
+unsigned int EditPlaceNumber(SudokuEditor *editor, unsigned int X, unsigned int Y, unsigned int value)
+{
+    unsigned int result = PROPAGATE_INCOMPLETE, solutions = 0;
+    bool fits = false, insolution = false, inalternative = false;
+
+    // sanity
+    if (!editor
+        || !editor->givens
+        || Y > 8
+        || X > 8
+        || value > 9
+        || value == 0) {
+        return EDIT_INVALID;
+    }
+
+    // nothing changes if the given is already there, a different one is taken away first
+    if (editor->givens->grid[Y][X] == value) {
+        editor->reused++;
+        return editor->status;
+    }
+
+    if (editor->givens->grid[Y][X]) {
+        EditClearCell(editor, X, Y);
+    }
+
+    // the givens are only placements, so anything that isn't a candidate is already in a unit
+    fits = CanPlaceNumber(editor->givens, X, Y, value);
+    PlaceNumber(editor->givens, X, Y, value);
+
+    if (!fits) {
+        editor->alternativevalid = false;
+        editor->status = EDIT_INVALID;
+        editor->reused++;
+        return editor->status;
+    }
+
+    // fewer solutions than none is still none, and a value that fits can't mend a duplicate
+    if (editor->status == EDIT_UNSOLVABLE
+        || editor->status == EDIT_INVALID) {
+        editor->reused++;
+        return editor->status;
+    }
+
+    // carry the propagated board forward from where it was rather than from the givens
+    if (editor->propagated->grid[Y][X] == value) {
+        // the givens already forced this value, so the solutions haven't changed at all
+        editor->reused++;
+        return editor->status;
+    } else if (CanPlaceNumber(editor->propagated, X, Y, value)) {
+        PlaceNumber(editor->propagated, X, Y, value);
+        result = PropagateSudoku(editor->propagated);
+    } else {
+        result = PROPAGATE_CONTRADICTION;
+    }
+
+    insolution = editor->solution[Y][X] == value;
+    inalternative = editor->alternativevalid && editor->alternative[Y][X] == value;
+
+    // a unique puzzle keeps its solution if it agrees, otherwise nothing is left
+    if (result == PROPAGATE_CONTRADICTION
+        || editor->status == EDIT_UNIQUE) {
+        editor->alternativevalid = false;
+        editor->status = (result != PROPAGATE_CONTRADICTION && insolution) ? EDIT_UNIQUE : EDIT_UNSOLVABLE;
+        editor->reused++;
+        return editor->status;
+    }
+
+    // the placement forced the rest of the board
+    if (result == PROPAGATE_COMPLETE) {
+        memcpy(editor->solution, editor->propagated->grid, sizeof(editor->solution));
+        editor->alternativevalid = false;
+        editor->status = EDIT_UNIQUE;
+        editor->reused++;
+        return editor->status;
+    }
+
+    // two known solutions that both agree are still two solutions
+    if (insolution
+        && inalternative) {
+        editor->reused++;
+        return editor->status;
+    }
+
+    // keep whichever known solution survived, the search may find the other one
+    if (!insolution
+        && inalternative) {
+        memcpy(editor->solution, editor->alternative, sizeof(editor->solution));
+        insolution = true;
+    }
+
+    solutions = SearchEditor(editor, 2);
+
+    if (!solutions) {
+        editor->alternativevalid = false;
+        editor->status = EDIT_UNSOLVABLE;
+        return editor->status;
+    }
+
+    // a survivor that isn't the solution found is a second solution we already know of
+    editor->alternativevalid = insolution
+        && solutions > 1
+        && memcmp(editor->solution, editor->board->grid, sizeof(editor->solution)) != 0;
+
+    if (editor->alternativevalid) {
+        memcpy(editor->alternative, editor->solution, sizeof(editor->alternative));
+    }
+
+    memcpy(editor->solution, editor->board->grid, sizeof(editor->solution));
+    editor->status = (solutions > 1) ? EDIT_MULTIPLE : EDIT_UNIQUE;
+
+    return editor->status;
+}
+
+//! Function to take a given away
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int    The x position of the cell from 0 - 8
+ *  @param      unsigned int    The y position of the cell from 0 - 8
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Taking a given away keeps every known solution, a puzzle that was unique only
+ *        needs to search for a solution with a different value in the emptied cell
+ */
+unsigned int EditClearCell(SudokuEditor *editor, unsigned int X, unsigned int Y)
+{
+    unsigned int result = PROPAGATE_INCOMPLETE;
+
+    // sanity
+    if (!editor
+        || !editor->givens
+        || Y > 8
+        || X > 8) {
+        return EDIT_INVALID;
+    }
+
+    // nothing to take away
+    if (!UnplaceNumber(editor->givens, X, Y)) {
+        editor->reused++;
+        return editor->status;
+    }
+
+    // more solutions than none may be some, and the duplicate may be gone
+    if (editor->status == EDIT_UNSOLVABLE
+        || editor->status == EDIT_INVALID) {
+        return EvaluateEditor(editor);
+    }
+
+    result = PropagateEditor(editor);
+
+    // every solution we knew of is still a solution, so two stay two
+    if (editor->status == EDIT_MULTIPLE) {
+        editor->reused++;
+        return editor->status;
+    }
+
+    // any new solution differs in the emptied cell, or it was a solution before,
+    // so there is nothing new when the rest of the givens still force that cell
+    if (result == PROPAGATE_COMPLETE
+        || editor->propagated->grid[Y][X]) {
+        editor->reused++;
+        return editor->status;
+    }
+
+    editor->searched++;
+
+    CopySudoku(editor->board, editor->propagated);
+    EliminateCandidate(editor->board, X, Y, editor->solution[Y][X]);
+
+    if (SearchSudokuParallel(editor->board, editor->threads, 1)) {
+        memcpy(editor->alternative, editor->board->grid, sizeof(editor->alternative));
+        editor->alternativevalid = true;
+        editor->status = EDIT_MULTIPLE;
+    }
+
+    return editor->status;
+}
@@ -0,0 +1,112 @@
+#ifndef SUDOKU_EDITOR_H
+#define SUDOKU_EDITOR_H
+
+#include <stdbool.h>
+
+#include "SudokuSolver.h"
+
+// what the givens of an editor add up to
+#define EDIT_UNIQUE      0
+#define EDIT_MULTIPLE    1
+#define EDIT_UNSOLVABLE  2
+#define EDIT_INVALID     3
+
+// A structure defining a puzzle being edited one given at a time
+typedef struct {
+    // the givens, their candidates kept up to date by every edit
+    Sudoku *givens;
+
+    // the givens with everything they force placed, kept while the givens can be solved
+    Sudoku *propagated;
+
+    // the board searches are run on so the propagated board is kept
+    Sudoku *board;
+
+    // what the givens add up to, one of the EDIT_ results
+    unsigned int status;
+
+    // a solution of the givens, kept while the status is EDIT_UNIQUE or EDIT_MULTIPLE
+    unsigned int solution[9][9];
+
+    // a second solution of the givens, kept while the status is EDIT_MULTIPLE and it is known
+    unsigned int alternative[9][9];
+
+    // whether the alternative holds a second solution
+    bool alternativevalid;
+
+    // the number of threads searches are split between
+    unsigned int threads;
+
+    // the number of edits answered from the solutions already known
+    unsigned long long reused;
+
+    // the number of edits that needed a search
+    unsigned long long searched;
+
+    // where the editor gets its memory from
+    const SudokuAllocator *allocator;
+} SudokuEditor;
+
+//! Function to initialize an editor holding an empty puzzle
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor to initialize
+ *  @param      unsigned int    The number of threads to search with
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the editor was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudokuEditor(SudokuEditor *editor, unsigned int threads, const SudokuAllocator *allocator);
+
+//! Function to cleanup an editor
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroySudokuEditor(SudokuEditor *editor);
+
+//! Function to replace every given of an editor and solve them from scratch
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int[9][9] The givens, 0 for an empty cell
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int LoadEditorPuzzle(SudokuEditor *editor, const unsigned int grid[9][9]);
+
+//! Function to place a given, changing the one already there
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int    The x position of the cell from 0 - 8
+ *  @param      unsigned int    The y position of the cell from 0 - 8
+ *  @param      unsigned int    The value to place from 1 - 9
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A placement only narrows the solutions, so the known solutions answer it
+ *        without a search unless the puzzle had more than one and they both disagree
+ */
+unsigned int EditPlaceNumber(SudokuEditor *editor, unsigned int X, unsigned int Y, unsigned int value);
+
+//! Function to take a given away
+/*!
+ *  @param      SudokuEditor *  A pointer to the editor
+ *  @param      unsigned int    The x position of the cell from 0 - 8
+ *  @param      unsigned int    The y position of the cell from 0 - 8
+ *
+ *  @returns    unsigned int    What the givens add up to, one of the EDIT_ results
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Taking a given away keeps every known solution, a puzzle that was unique only
+ *        needs to search for a solution with a different value in the emptied cell
+ */
+unsigned int EditClearCell(SudokuEditor *editor, unsigned int X, unsigned int Y);
+
+#endif
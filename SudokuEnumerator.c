@@ -0,0 +1,637 @@
+#include "SudokuEnumerator.h"
+
+// A structure defining an enumeration shared by the threads running it
+typedef struct {
+    // the grid at the top of every subtree, 81 bytes each
+    unsigned char *subtrees;
+
+    // the number of subtrees
+    unsigned int count;
+
+    // the next subtree to claim
+    atomic_uint next;
+
+    // set once the enumeration should be abandoned by every thread
+    atomic_bool stop;
+
+    // protects the callback, the counts and the state
+    pthread_mutex_t lock;
+
+    // stop after this many solutions, 0 to find them all
+    unsigned long long limit;
+
+    // the number of solutions handed out by this run
+    unsigned long long found;
+
+    // the function to call with each solution
+    SolutionCallback callback;
+
+    // passed to every call of the callback
+    void *user;
+
+    // where progress is recorded
+    EnumerationState *state;
+
+    // the board the enumeration was started from, for its settings
+    const Sudoku *sudoku;
+} Enumeration;
+
+// A structure defining where a thread is within the subtree it is searching
+typedef struct {
+    // the enumeration the thread belongs to
+    Enumeration *enumeration;
+
+    // the subtree being searched
+    unsigned int subtree;
+
+    // the number of solutions of the subtree found so far
+    unsigned long long seen;
+
+    // the number of solutions of the subtree handed out by an earlier run
+    unsigned long long skip;
+} EnumerationCursor;
+
+//! Function to set up a quiet board to enumerate on with the settings of another
+/*!
+ *  @param      Sudoku*         The board to set up
+ *  @param      Sudoku*         The board to take the settings from
+ *
+ *  @returns    boolean         Whether the board was set up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool InitializeEnumerationBoard(Sudoku *board, const Sudoku *sudoku)
+{
+    if (!InitializeSudokuStorage(board, sudoku->threshold, sudoku->maxguesscount)) {
+        return false;
+    }
+
+    board->verbose = false;
+    board->scorer = sudoku->scorer;
+
+    return true;
+}
+
+//! Function to load a grid of 81 bytes onto a board
+/*!
+ *  @param      Sudoku*         The board to load onto
+ *  @param      unsigned char[81] The grid
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void LoadGrid(Sudoku *sudoku, const unsigned char grid[81])
+{
+    unsigned int c = 0;
+
+    ResetSudoku(sudoku);
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        CELL_VALUE(sudoku, c) = grid[c];
+    }
+}
+
+//! Function to store the grid of a board as 81 bytes
+/*!
+ *  @param      Sudoku*         The board to store
+ *  @param      unsigned char[81] Receives the grid
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void StoreGrid(const Sudoku *sudoku, unsigned char grid[81])
+{
+    unsigned int c = 0;
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        grid[c] = (unsigned char)CELL_VALUE(sudoku, c);
+    }
+}
+
+//! Function to split the search of a sudoku into subtrees
+/*!
+ *  @param      Sudoku*         The sudoku to split
+ *  @param      unsigned int *  Receives the number of subtrees
+ *
+ *  @returns    unsigned char * The grid at the top of every subtree, 81 bytes each, or NULL on failure
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every subtree is expanded a level at a time at its most constrained cell until there are
+ *        ENUMERATESUBTREES of them or nothing left to expand. Dead ends are dropped and solved
+ *        grids are kept as subtrees of their own. The split only depends on the grid, so the
+ *        same sudoku is always split the same way.
+ */
+static unsigned char *SplitSearch(const Sudoku *sudoku, unsigned int *count)
+{
+    unsigned char *current = NULL, *next = NULL, *swap = NULL;
+    unsigned int i = 0, g = 0, x = 0, y = 0, nextcount = 0;
+    size_t size = MAXENUMERATESUBTREES * SUDOKU_CELLS;
+    bool expanded = true;
+    GuessRanking ranking;
+    Sudoku board;
+
+    *count = 0;
+
+    // allocate a level and the one below it
+    current = (unsigned char*)AllocateMemory(sudoku->allocator, size);
+    next = (unsigned char*)AllocateMemory(sudoku->allocator, size);
+
+    // sanity check them
+    if (!current
+        || !next
+        || !InitializeEnumerationBoard(&board, sudoku)) {
+        FreeMemory(sudoku->allocator, current, size);
+        FreeMemory(sudoku->allocator, next, size);
+        return NULL;
+    }
+
+    // the whole board is the first subtree
+    StoreGrid(sudoku, current);
+    *count = 1;
+
+    // expand a level at a time till we have enough
+    while (*count < ENUMERATESUBTREES
+        && expanded) {
+        expanded = false;
+        nextcount = 0;
+
+        for (i = 0; i < *count; ++i) {
+            LoadGrid(&board, current + (i * SUDOKU_CELLS));
+
+            // dead ends have nothing to search
+            switch (PropagateSudoku(&board)) {
+                case PROPAGATE_CONTRADICTION:
+                    continue;
+                case PROPAGATE_COMPLETE:
+                    StoreGrid(&board, next + (nextcount++ * SUDOKU_CELLS));
+                    continue;
+            }
+
+            if (!FindMostConstrainedCell(&board, &x, &y)
+                || !RankCellGuesses(&board, x, y, &ranking)) {
+                continue;
+            }
+
+            // keep it whole if its children wouldn't leave room for the rest of the level
+            if (nextcount + ranking.count + (*count - i - 1) > MAXENUMERATESUBTREES) {
+                StoreGrid(&board, next + (nextcount++ * SUDOKU_CELLS));
+                continue;
+            }
+
+            // a subtree for every guess in the order a search would try them
+            for (g = 0; g < ranking.count; ++g) {
+                StoreGrid(&board, next + (nextcount * SUDOKU_CELLS));
+                next[(nextcount * SUDOKU_CELLS) + CELL(ranking.guesses[g].x, ranking.guesses[g].y)] = (unsigned char)ranking.guesses[g].value;
+                nextcount++;
+            }
+
+            expanded = true;
+        }
+
+        swap = current;
+        current = next;
+        next = swap;
+        *count = nextcount;
+    }
+
+    FreeMemory(sudoku->allocator, next, size);
+
+    return current;
+}
+
+//! Function to hand a solution to the callback of an enumeration
+/*!
+ *  @param      EnumerationCursor * Where the solution was found
+ *  @param      Sudoku*         The solution
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void EmitSolution(EnumerationCursor *cursor, const Sudoku *sudoku)
+{
+    Enumeration *enumeration = cursor->enumeration;
+
+    // a resumed subtree passes over what it handed out last time
+    if (cursor->seen++ < cursor->skip) {
+        return;
+    }
+
+    pthread_mutex_lock(&enumeration->lock);
+
+    if (!atomic_load(&enumeration->stop)) {
+        // the solution counts as handed out even if the callback wants us to stop
+        if (!enumeration->callback(enumeration->user, sudoku)) {
+            atomic_store(&enumeration->stop, true);
+        }
+
+        enumeration->found++;
+        enumeration->state->solutions++;
+        enumeration->state->emitted[cursor->subtree]++;
+
+        // stop once we've found enough
+        if (enumeration->limit
+            && enumeration->found >= enumeration->limit) {
+            atomic_store(&enumeration->stop, true);
+        }
+    }
+
+    pthread_mutex_unlock(&enumeration->lock);
+}
+
+//! Function which searches a board depth first, handing out every solution
+/*!
+ *  @param      EnumerationCursor * Where the board is
+ *  @param      Sudoku*         The board to search
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void EnumerateBranch(EnumerationCursor *cursor, Sudoku *sudoku)
+{
+    unsigned int x = 0, y = 0, g = 0;
+    GuessRanking ranking;
+    Sudoku branch;
+
+    // abandon the search once we're told to
+    if (atomic_load(&cursor->enumeration->stop)) {
+        return;
+    }
+
+    // place everything that is forced
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            EmitSolution(cursor, sudoku);
+            return;
+        case PROPAGATE_CONTRADICTION:
+            return;
+    }
+
+    // grab the cell to guess in, its guesses and a board on the stack to try them on
+    if (!FindMostConstrainedCell(sudoku, &x, &y)
+        || !RankCellGuesses(sudoku, x, y, &ranking)
+        || !InitializeEnumerationBoard(&branch, sudoku)) {
+        return;
+    }
+
+    // try every guess until we're told to stop
+    for (g = 0; g < ranking.count && !atomic_load(&cursor->enumeration->stop); ++g) {
+        CopySudoku(&branch, sudoku);
+        PlaceNumber(&branch,
+            ranking.guesses[g].x,
+            ranking.guesses[g].y,
+            ranking.guesses[g].value);
+
+        EnumerateBranch(cursor, &branch);
+    }
+}
+
+//! Function run by each thread of an enumeration
+/*!
+ *  @param      void *          A pointer to the Enumeration
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *RunEnumerator(void *argument)
+{
+    Enumeration *enumeration = (Enumeration*)argument;
+    EnumerationCursor cursor;
+    unsigned int i = 0;
+    Sudoku board;
+
+    if (!InitializeEnumerationBoard(&board, enumeration->sudoku)) {
+        return NULL;
+    }
+
+    cursor.enumeration = enumeration;
+
+    // claim subtrees in order until there are none left
+    while (!atomic_load(&enumeration->stop)
+        && (i = atomic_fetch_add(&enumeration->next, 1)) < enumeration->count) {
+        // only the thread that claims a subtree touches its count outside the lock
+        if (enumeration->state->emitted[i] == ENUMERATEFINISHED) {
+            continue;
+        }
+
+        cursor.subtree = i;
+        cursor.seen = 0;
+        cursor.skip = enumeration->state->emitted[i];
+
+        LoadGrid(&board, enumeration->subtrees + (i * SUDOKU_CELLS));
+        EnumerateBranch(&cursor, &board);
+
+        // a subtree cut short is searched again by the next run
+        if (!atomic_load(&enumeration->stop)) {
+            pthread_mutex_lock(&enumeration->lock);
+            enumeration->state->emitted[i] = ENUMERATEFINISHED;
+            pthread_mutex_unlock(&enumeration->lock);
+        }
+    }
+
+    // give back the blocks pooled while enumerating
+    ReleasePoolMemory();
+
+    return NULL;
+}
+
+//! Function to initialize an empty enumeration state
+/*!
+ *  @param      EnumerationState * A pointer to the state to initialize
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the state was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeEnumerationState(EnumerationState *state, const SudokuAllocator *allocator)
+{
+    // sanity
+    if (!state) {
+        return false;
+    }
+
+    memset(state, 0, sizeof(EnumerationState));
+    state->allocator = allocator;
+
+    return true;
+}
+
+//! Function to cleanup an enumeration state
+/*!
+ *  @param      EnumerationState * A pointer to the state to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyEnumerationState(EnumerationState *state)
+{
+    const SudokuAllocator *allocator = NULL;
+
+    // sanity
+    if (!state) {
+        return;
+    }
+
+    allocator = state->allocator;
+    FreeMemory(allocator, state->emitted, state->subtrees * sizeof(unsigned long long));
+
+    // leave it ready to use again
+    InitializeEnumerationState(state, allocator);
+}
+
+//! Function to write an enumeration state to a file
+/*!
+ *  @param      EnumerationState * A pointer to the state to save
+ *  @param      FILE *          The file to write to
+ *
+ *  @returns    boolean         Whether the state was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The state is written as text, the totals and the puzzle's hash on the first line then
+ *        a count for every subtree
+ */
+bool SaveEnumerationState(const EnumerationState *state, FILE *file)
+{
+    unsigned int i = 0;
+
+    // sanity
+    if (!state
+        || !file) {
+        return false;
+    }
+
+    if (fprintf(file, "%u %llu %u %llu\n", state->subtrees, state->solutions, state->complete ? 1u : 0u, state->puzzle) < 0) {
+        return false;
+    }
+
+    for (i = 0; i < state->subtrees; ++i) {
+        if (fprintf(file, "%llu\n", state->emitted[i]) < 0) {
+            return false;
+        }
+    }
+
+    return (fflush(file) == 0);
+}
+
+//! Function to read an enumeration state written by SaveEnumerationState
+/*!
+ *  @param      EnumerationState * A pointer to an initialized state to fill
+ *  @param      FILE *          The file to read from
+ *
+ *  @returns    boolean         Whether a whole state was read
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Whatever the state held before is thrown away, it is left empty if the read fails
+ */
+bool LoadEnumerationState(EnumerationState *state, FILE *file)
+{
+    unsigned int i = 0, subtrees = 0, complete = 0;
+    unsigned long long solutions = 0, puzzle = 0;
+
+    // sanity
+    if (!state
+        || !file) {
+        return false;
+    }
+
+    DestroyEnumerationState(state);
+
+    // the totals and the puzzle, a state can't have more subtrees than a split leaves
+    if (fscanf(file, "%u %llu %u %llu", &subtrees, &solutions, &complete, &puzzle) != 4
+        || subtrees > MAXENUMERATESUBTREES) {
+        return false;
+    }
+
+    if (subtrees) {
+        state->emitted = (unsigned long long*)AllocateMemory(state->allocator, subtrees * sizeof(unsigned long long));
+
+        if (!state->emitted) {
+            return false;
+        }
+
+        state->subtrees = subtrees;
+
+        for (i = 0; i < subtrees; ++i) {
+            if (fscanf(file, "%llu", &state->emitted[i]) != 1) {
+                DestroyEnumerationState(state);
+                return false;
+            }
+        }
+    }
+
+    state->solutions = solutions;
+    state->complete = (complete != 0);
+    state->puzzle = puzzle;
+
+    return true;
+}
+
+//! Function to tell whether an enumeration state can be resumed on a sudoku
+/*!
+ *  @param      EnumerationState * A pointer to the state
+ *  @param      Sudoku*         A pointer to the sudoku about to be enumerated
+ *
+ *  @returns    boolean         Whether the state is new or was saved enumerating the same puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Another puzzle can split into as many subtrees, so the counts of a state are only
+ *        trusted on the puzzle whose hash it holds
+ */
+bool EnumerationStateMatches(const EnumerationState *state, Sudoku *sudoku)
+{
+    // sanity
+    if (!state
+        || !sudoku) {
+        return false;
+    }
+
+    // nothing has been recorded in a new state
+    if (!state->subtrees
+        && !state->complete) {
+        return true;
+    }
+
+    return (state->puzzle == HashSudoku(sudoku));
+}
+
+//! Function which hands every solution of a sudoku to a callback
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to enumerate, it is left unchanged
+ *  @param      unsigned int    The number of threads to search with
+ *  @param      unsigned long long The number of solutions to stop after, 0 to find them all
+ *  @param      SolutionCallback The function to call with each solution
+ *  @param      void *          Passed to every call of the callback
+ *  @param      EnumerationState * Where to resume from and record progress, or NULL to start afresh
+ *
+ *  @returns    unsigned long long The number of solutions handed to the callback by this run
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The search is split into subtrees in the same order every time, threads claim them one
+ *        at a time and search them depth first. The callback is never called by two threads at
+ *        once. Solutions are never kept, the state only holds a count for every subtree, and a
+ *        resumed run skips the solutions that count says were already handed out. A state
+ *        saved for another puzzle is left alone and nothing is enumerated.
+ *        Every solution is wanted so the guess limit of the sudoku is ignored.
+ */
+unsigned long long EnumerateSolutions(Sudoku *sudoku, unsigned int threads, unsigned long long limit, SolutionCallback callback, void *user, EnumerationState *state)
+{
+    pthread_t workers[MAXSEARCHTHREADS];
+    unsigned int i = 0, started = 0;
+    EnumerationState fresh;
+    Enumeration enumeration;
+
+    // sanity
+    if (!sudoku
+        || !callback) {
+        return 0;
+    }
+
+    // without a state to resume from use one that is thrown away afterwards
+    if (!state) {
+        InitializeEnumerationState(&fresh, sudoku->allocator);
+        state = &fresh;
+    }
+
+    // resuming another puzzle's state would skip solutions of this one
+    if (!EnumerationStateMatches(state, sudoku)) {
+        return 0;
+    }
+
+    memset(&enumeration, 0, sizeof(Enumeration));
+    enumeration.limit = limit;
+    enumeration.callback = callback;
+    enumeration.user = user;
+    enumeration.state = state;
+    enumeration.sudoku = sudoku;
+    enumeration.subtrees = SplitSearch(sudoku, &enumeration.count);
+
+    if (!enumeration.subtrees) {
+        return 0;
+    }
+
+    // a new state starts with nothing handed out for this puzzle, a saved one must be for the same split
+    if (!state->subtrees
+        && !state->complete) {
+        state->puzzle = HashSudoku(sudoku);
+
+        if (enumeration.count) {
+            state->emitted = (unsigned long long*)AllocateMemory(state->allocator, enumeration.count * sizeof(unsigned long long));
+            state->subtrees = state->emitted ? enumeration.count : 0;
+        }
+    }
+
+    if (state->subtrees == enumeration.count
+        && !state->complete) {
+        atomic_init(&enumeration.next, 0);
+        atomic_init(&enumeration.stop, false);
+        pthread_mutex_init(&enumeration.lock, NULL);
+
+        // keep our thread count sensible, the calling thread is one of them
+        threads = MAX(MIN(threads, MAXSEARCHTHREADS), 1);
+
+        for (started = 0; started + 1 < threads; ++started) {
+            if (pthread_create(&workers[started], NULL, RunEnumerator, &enumeration) != 0) {
+                break;
+            }
+        }
+
+        RunEnumerator(&enumeration);
+
+        for (i = 0; i < started; ++i) {
+            pthread_join(workers[i], NULL);
+        }
+
+        pthread_mutex_destroy(&enumeration.lock);
+
+        // we're complete once every subtree is
+        state->complete = true;
+
+        for (i = 0; i < state->subtrees; ++i) {
+            if (state->emitted[i] != ENUMERATEFINISHED) {
+                state->complete = false;
+                break;
+            }
+        }
+    }
+
+    // cleanup
+    FreeMemory(sudoku->allocator, enumeration.subtrees, MAXENUMERATESUBTREES * SUDOKU_CELLS);
+
+    if (state == &fresh) {
+        DestroyEnumerationState(&fresh);
+    }
+
+    return enumeration.found;
+}
+
+//! Function to write a solution to a file as a line of 81 digits
+/*!
+ *  @param      void *          The FILE * to write to
+ *  @param      Sudoku*         The solution
+ *
+ *  @returns    boolean         Whether the line was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Pass this as the callback of EnumerateSolutions to stream solutions to a file
+ */
+bool WriteSolution(void *user, const Sudoku *sudoku)
+{
+    char line[SUDOKU_CELLS + 1];
+    unsigned int c = 0;
+
+    // sanity
+    if (!user
+        || !sudoku) {
+        return false;
+    }
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        line[c] = (char)('0' + CELL_VALUE(sudoku, c));
+    }
+
+    line[SUDOKU_CELLS] = '\n';
+
+    return (fwrite(line, 1, sizeof(line), (FILE*)user) == sizeof(line));
+}
@@ -0,0 +1,129 @@
+#ifndef SUDOKU_ENUMERATOR_H
+#define SUDOKU_ENUMERATOR_H
+
+#include <stdio.h>
+
+#include "SudokuParallel.h"
+
+// the number of subtrees the search is split into before it is shared out between threads,
+// this never depends on the thread count so a saved state can be resumed with any number of threads
+#define ENUMERATESUBTREES 256
+
+// the most subtrees a single split can leave behind
+#define MAXENUMERATESUBTREES (ENUMERATESUBTREES * SUDOKU_SIZE)
+
+// marks a subtree whose every solution has been handed out
+#define ENUMERATEFINISHED (~0ull)
+
+// called with every solution found, return false to stop the enumeration
+typedef bool (*SolutionCallback)(void *user, const Sudoku *sudoku);
+
+// A structure defining how far an enumeration has got, so it can be saved and resumed later
+typedef struct {
+    // the number of solutions handed out over every run
+    unsigned long long solutions;
+
+    // the number of subtrees the search was split into, 0 until the first run
+    unsigned int subtrees;
+
+    // the solutions handed out from each subtree, ENUMERATEFINISHED once it has been searched entirely
+    unsigned long long *emitted;
+
+    // whether every subtree has been searched
+    bool complete;
+
+    // the Zobrist hash of the puzzle the state belongs to, set by the first run
+    unsigned long long puzzle;
+
+    // where the state gets its memory from
+    const SudokuAllocator *allocator;
+} EnumerationState;
+
+//! Function to initialize an empty enumeration state
+/*!
+ *  @param      EnumerationState * A pointer to the state to initialize
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the state was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeEnumerationState(EnumerationState *state, const SudokuAllocator *allocator);
+
+//! Function to cleanup an enumeration state
+/*!
+ *  @param      EnumerationState * A pointer to the state to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyEnumerationState(EnumerationState *state);
+
+//! Function to write an enumeration state to a file
+/*!
+ *  @param      EnumerationState * A pointer to the state to save
+ *  @param      FILE *          The file to write to
+ *
+ *  @returns    boolean         Whether the state was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool SaveEnumerationState(const EnumerationState *state, FILE *file);
+
+//! Function to read an enumeration state written by SaveEnumerationState
+/*!
+ *  @param      EnumerationState * A pointer to an initialized state to fill
+ *  @param      FILE *          The file to read from
+ *
+ *  @returns    boolean         Whether a whole state was read
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool LoadEnumerationState(EnumerationState *state, FILE *file);
+
+//! Function to tell whether an enumeration state can be resumed on a sudoku
+/*!
+ *  @param      EnumerationState * A pointer to the state
+ *  @param      Sudoku*         A pointer to the sudoku about to be enumerated
+ *
+ *  @returns    boolean         Whether the state is new or was saved enumerating the same puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool EnumerationStateMatches(const EnumerationState *state, Sudoku *sudoku);
+
+//! Function which hands every solution of a sudoku to a callback
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to enumerate, it is left unchanged
+ *  @param      unsigned int    The number of threads to search with
+ *  @param      unsigned long long The number of solutions to stop after, 0 to find them all
+ *  @param      SolutionCallback The function to call with each solution
+ *  @param      void *          Passed to every call of the callback
+ *  @param      EnumerationState * Where to resume from and record progress, or NULL to start afresh
+ *
+ *  @returns    unsigned long long The number of solutions handed to the callback by this run
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The search is split into subtrees in the same order every time, threads claim them one
+ *        at a time and search them depth first. The callback is never called by two threads at
+ *        once. Solutions are never kept, the state only holds a count for every subtree, and a
+ *        resumed run skips the solutions that count says were already handed out. A state
+ *        saved for another puzzle is left alone and nothing is enumerated.
+ *        Every solution is wanted so the guess limit of the sudoku is ignored.
+ */
+unsigned long long EnumerateSolutions(Sudoku *sudoku, unsigned int threads, unsigned long long limit, SolutionCallback callback, void *user, EnumerationState *state);
+
+//! Function to write a solution to a file as a line of 81 digits
+/*!
+ *  @param      void *          The FILE * to write to
+ *  @param      Sudoku*         The solution
+ *
+ *  @returns    boolean         Whether the line was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Pass this as the callback of EnumerateSolutions to stream solutions to a file
+ */
+bool WriteSolution(void *user, const Sudoku *sudoku);
+
+#endif
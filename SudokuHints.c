@@ -0,0 +1,540 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "SudokuHints.h"
+
+//! Function to start a step found in a unit
+/*!
+ *  @param      SudokuStep *    A pointer to the step to fill
+ *  @param      unsigned int    The STEP_ deduction
+ *  @param      unsigned int    The unit the deduction was made in, or SUDOKU_UNITS
+ *  @param      unsigned short  The values the deduction is about
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void BeginStep(SudokuStep *step, unsigned int technique, unsigned int unit, unsigned short values)
+{
+    memset(step, 0, sizeof(SudokuStep));
+
+    step->technique = technique;
+    step->unit = unit;
+    step->target = SUDOKU_UNITS;
+    step->values = values;
+    step->cell = SUDOKU_CELLS;
+}
+
+//! Function to add every candidate of a unit a step removes, skipping the cells of the deduction
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    A pointer to the step
+ *  @param      unsigned int    The unit to remove the values from
+ *
+ *  @returns    unsigned int    The number of candidates added
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only candidates still on the board are added, a step removing nothing isn't a step
+ */
+static unsigned int AddStepEliminations(Sudoku *sudoku, SudokuStep *step, unsigned int unit)
+{
+    unsigned int i = 0, j = 0, cell = 0, mask = 0, added = 0;
+    bool involved = false;
+
+    for (i = 0; i < SUDOKU_SIZE; ++i) {
+        cell = UnitCells[unit][i];
+
+        // the cells making the deduction keep their candidates
+        for (involved = false, j = 0; j < step->cellcount; ++j) {
+            if (step->cells[j] == cell) {
+                involved = true;
+                break;
+            }
+        }
+
+        if (involved
+            || CELL_VALUE(sudoku, cell)) {
+            continue;
+        }
+
+        for (mask = CELL_CANDIDATES(sudoku, cell) & step->values; mask && step->eliminationcount < MAXSTEPELIMINATIONS; mask &= mask - 1) {
+            step->eliminations[step->eliminationcount].cell = (unsigned char)cell;
+            step->eliminations[step->eliminationcount].value = (unsigned char)(LOWBIT(mask) + 1);
+            step->eliminationcount++;
+            added++;
+        }
+    }
+
+    if (added) {
+        step->target = unit;
+    }
+
+    return added;
+}
+
+//! Function to find where a board that can't be solved goes wrong
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the contradiction
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A contradiction that can't be pinned down is still reported, with no unit or cells
+ */
+static void FindContradiction(Sudoku *sudoku, SudokuStep *step)
+{
+    unsigned int u = 0, i = 0, j = 0, v = 0, cell = 0;
+
+    BeginStep(step, STEP_CONTRADICTION, SUDOKU_UNITS, 0);
+    step->contradiction = sudoku->contradiction;
+
+    // an empty cell with nothing left
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell) {
+        if (!CELL_VALUE(sudoku, cell)
+            && !CELL_CANDIDATES(sudoku, cell)) {
+            step->contradiction = CONTRADICTION_EMPTYCELL;
+            step->cells[step->cellcount++] = (unsigned char)cell;
+            return;
+        }
+    }
+
+    for (u = 0; u < SUDOKU_UNITS; ++u) {
+        // a value used twice in the unit
+        for (i = 0; i < SUDOKU_SIZE; ++i) {
+            v = CELL_VALUE(sudoku, UnitCells[u][i]);
+
+            for (j = i + 1; v && j < SUDOKU_SIZE; ++j) {
+                if (CELL_VALUE(sudoku, UnitCells[u][j]) == v) {
+                    step->contradiction = CONTRADICTION_DUPLICATE;
+                    step->unit = u;
+                    step->values = (unsigned short)VALUE_BIT(v);
+                    step->cells[step->cellcount++] = UnitCells[u][i];
+                    step->cells[step->cellcount++] = UnitCells[u][j];
+                    return;
+                }
+            }
+        }
+
+        // a value the unit still needs with nowhere left to go
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            if (!sudoku->places[u][v]
+                && !(sudoku->unitvalues[u] & VALUE_BIT(v))) {
+                step->contradiction = CONTRADICTION_NOPLACE;
+                step->unit = u;
+                step->values = (unsigned short)VALUE_BIT(v);
+                return;
+            }
+        }
+    }
+}
+
+//! Function to find a cell left with a single candidate
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the step
+ *
+ *  @returns    boolean         Whether a naked single was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool FindNakedSingle(Sudoku *sudoku, SudokuStep *step)
+{
+    unsigned int cell = 0, mask = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell) {
+        mask = CELL_CANDIDATES(sudoku, cell);
+
+        if (!CELL_VALUE(sudoku, cell)
+            && POPCOUNT(mask) == 1) {
+            BeginStep(step, STEP_NAKEDSINGLE, SUDOKU_UNITS, (unsigned short)mask);
+            step->cells[step->cellcount++] = (unsigned char)cell;
+            step->cell = cell;
+            step->value = LOWBIT(mask) + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! Function to find a value with a single place left within a unit
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the step
+ *
+ *  @returns    boolean         Whether a hidden single was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Boxes are checked before rows and columns since they are the easiest for a person to see
+ */
+static bool FindHiddenSingle(Sudoku *sudoku, SudokuStep *step)
+{
+    static const unsigned char Order[SUDOKU_UNITS] = {
+        18, 19, 20, 21, 22, 23, 24, 25, 26,
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 15, 16, 17
+    };
+    unsigned int i = 0, u = 0, v = 0, cell = 0;
+
+    for (i = 0; i < SUDOKU_UNITS; ++i) {
+        u = Order[i];
+
+        // nothing to find in a full unit
+        if (!sudoku->unitempty[u]) {
+            continue;
+        }
+
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            if (sudoku->places[u][v] == 1) {
+                cell = UnitCells[u][LOWBIT(sudoku->placemasks[u][v])];
+
+                BeginStep(step, STEP_HIDDENSINGLE, u, (unsigned short)VALUE_BIT(v));
+                step->cells[step->cellcount++] = (unsigned char)cell;
+                step->cell = cell;
+                step->value = v;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+//! Function to find a value whose places within a box all share a row or column
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the step
+ *
+ *  @returns    boolean         Whether a pointing pair or triple was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The value can be removed from the rest of that row or column
+ */
+static bool FindPointing(Sudoku *sudoku, SudokuStep *step)
+{
+    unsigned int b = 0, v = 0, i = 0, line = 0, mask = 0, unit = 0;
+
+    for (b = 0; b < SUDOKU_SIZE; ++b) {
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            mask = sudoku->placemasks[BOX_UNIT(b)][v];
+
+            // a single place is a hidden single, which was already looked for
+            if (sudoku->places[BOX_UNIT(b)][v] < 2) {
+                continue;
+            }
+
+            for (line = 0; line < 3; ++line) {
+                // within a box, row r holds bits 3r - 3r + 2 and column c holds bits c, c + 3 and c + 6
+                if (!(mask & ~(0x7u << (3 * line)))) {
+                    unit = ROW_UNIT(BoxTop[b] + line);
+                } else if (!(mask & ~(0x49u << line))) {
+                    unit = COLUMN_UNIT(BoxLeft[b] + line);
+                } else {
+                    continue;
+                }
+
+                BeginStep(step, STEP_POINTING, BOX_UNIT(b), (unsigned short)VALUE_BIT(v));
+
+                for (i = 0; i < SUDOKU_SIZE; ++i) {
+                    if (mask & (1u << i)) {
+                        step->cells[step->cellcount++] = UnitCells[BOX_UNIT(b)][i];
+                    }
+                }
+
+                if (AddStepEliminations(sudoku, step, unit)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+//! Function to find a value whose places within a row or column all share a box
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the step
+ *
+ *  @returns    boolean         Whether a claiming pair or triple was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The value can be removed from the rest of that box
+ */
+static bool FindClaiming(Sudoku *sudoku, SudokuStep *step)
+{
+    unsigned int u = 0, v = 0, i = 0, third = 0, mask = 0;
+
+    for (u = 0; u < BOX_UNIT(0); ++u) {
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            mask = sudoku->placemasks[u][v];
+
+            if (sudoku->places[u][v] < 2) {
+                continue;
+            }
+
+            // within a row or column, each box holds 3 bits in a row
+            for (third = 0; third < 3; ++third) {
+                if (!(mask & ~(0x7u << (3 * third)))) {
+                    break;
+                }
+            }
+
+            if (third == 3) {
+                continue;
+            }
+
+            BeginStep(step, STEP_CLAIMING, u, (unsigned short)VALUE_BIT(v));
+
+            for (i = 0; i < SUDOKU_SIZE; ++i) {
+                if (mask & (1u << i)) {
+                    step->cells[step->cellcount++] = UnitCells[u][i];
+                }
+            }
+
+            if (AddStepEliminations(sudoku, step, BOX_UNIT(CellBox[step->cells[0]]))) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+//! Function to find two cells of a unit left with the same two candidates
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the step
+ *
+ *  @returns    boolean         Whether a naked pair was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Both values can be removed from the rest of the unit
+ */
+static bool FindNakedPair(Sudoku *sudoku, SudokuStep *step)
+{
+    unsigned int u = 0, i = 0, j = 0, first = 0, second = 0, mask = 0;
+
+    for (u = 0; u < SUDOKU_UNITS; ++u) {
+        // a pair needs a third cell to take anything from
+        if (sudoku->unitempty[u] < 3) {
+            continue;
+        }
+
+        for (i = 0; i < SUDOKU_SIZE; ++i) {
+            first = UnitCells[u][i];
+            mask = CELL_CANDIDATES(sudoku, first);
+
+            if (CELL_VALUE(sudoku, first)
+                || POPCOUNT(mask) != 2) {
+                continue;
+            }
+
+            for (j = i + 1; j < SUDOKU_SIZE; ++j) {
+                second = UnitCells[u][j];
+
+                if (CELL_VALUE(sudoku, second)
+                    || CELL_CANDIDATES(sudoku, second) != mask) {
+                    continue;
+                }
+
+                BeginStep(step, STEP_NAKEDPAIR, u, (unsigned short)mask);
+                step->cells[step->cellcount++] = (unsigned char)first;
+                step->cells[step->cellcount++] = (unsigned char)second;
+
+                if (AddStepEliminations(sudoku, step, u)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+//! Function to find the cheapest deduction that can be made on a board
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the deduction
+ *
+ *  @returns    boolean         Whether a deduction or a contradiction was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The techniques are tried cheapest first and the search stops at the first hit.
+ *        The grid isn't changed and the candidates are only rebuilt when a placement
+ *        has made them stale, so any candidates removed before are kept
+ */
+bool FindNextStep(Sudoku *sudoku, SudokuStep *step)
+{
+    // sanity
+    if (!sudoku
+        || !step) {
+        return false;
+    }
+
+    BeginStep(step, STEP_NONE, SUDOKU_UNITS, 0);
+
+    // a board that can't be solved has no next step, only the reason why
+    if (!RefreshCandidates(sudoku)) {
+        FindContradiction(sudoku, step);
+        return true;
+    }
+
+    // cheapest first, each scan only reads the cached candidate and place tables
+    if (FindNakedSingle(sudoku, step)
+        || FindHiddenSingle(sudoku, step)
+        || FindPointing(sudoku, step)
+        || FindClaiming(sudoku, step)
+        || FindNakedPair(sudoku, step)) {
+        return true;
+    }
+
+    // a failed scan may have left a pattern that removed nothing behind
+    BeginStep(step, STEP_NONE, SUDOKU_UNITS, 0);
+
+    return false;
+}
+
+//! Function to make the placement or remove the candidates of a step
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    A pointer to a step found on the sudoku
+ *
+ *  @returns    boolean         Whether the step was applied
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ApplyStep(Sudoku *sudoku, const SudokuStep *step)
+{
+    unsigned int i = 0, cell = 0;
+
+    // sanity
+    if (!sudoku
+        || !step
+        || step->technique == STEP_NONE
+        || step->technique == STEP_CONTRADICTION) {
+        return false;
+    }
+
+    // a single places its value
+    if (step->cell < SUDOKU_CELLS) {
+        return PlaceNumber(sudoku, CellColumn[step->cell], CellRow[step->cell], step->value);
+    }
+
+    // anything else removes candidates
+    for (i = 0; i < step->eliminationcount; ++i) {
+        cell = step->eliminations[i].cell;
+
+        EliminateCandidate(sudoku, CellColumn[cell], CellRow[cell], step->eliminations[i].value);
+    }
+
+    return step->eliminationcount > 0;
+}
+
+//! Function to name a unit the way a person would
+/*!
+ *  @param      unsigned int    The unit from 0 - 26
+ *  @param      char *          The buffer to write to, at least 16 bytes
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void UnitName(unsigned int unit, char *buffer)
+{
+    if (unit < COLUMN_UNIT(0)) {
+        sprintf(buffer, "row %u", unit + 1);
+    } else if (unit < BOX_UNIT(0)) {
+        sprintf(buffer, "column %u", unit - COLUMN_UNIT(0) + 1);
+    } else if (unit < SUDOKU_UNITS) {
+        sprintf(buffer, "box %u", unit - BOX_UNIT(0) + 1);
+    } else {
+        strcpy(buffer, "the board");
+    }
+}
+
+//! Function to explain a step in words
+/*!
+ *  @param      SudokuStep *    A pointer to the step
+ *  @param      char *          The buffer to write to
+ *  @param      size_t          The size of the buffer, STEPDESCRIPTIONSIZE is always enough
+ *
+ *  @returns    size_t          The length of the explanation, 0 if it didn't fit
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Cells are named r<row>c<column> counting from 1, boxes count from 1 left to right, top to bottom
+ */
+size_t DescribeStep(const SudokuStep *step, char *buffer, size_t size)
+{
+    char text[STEPDESCRIPTIONSIZE], unit[16], target[16];
+    unsigned int i = 0, first = 0, second = 0;
+    int length = 0;
+
+    // sanity
+    if (!step
+        || !buffer
+        || !size) {
+        return 0;
+    }
+
+    UnitName(step->unit, unit);
+    UnitName(step->target, target);
+
+    first = step->values ? LOWBIT(step->values) + 1 : 0;
+    second = POPCOUNT(step->values) > 1 ? LOWBIT(step->values & (step->values - 1)) + 1 : 0;
+
+    // say what was seen
+    switch (step->technique) {
+        case STEP_NAKEDSINGLE:
+            length = sprintf(text, "Naked single: r%uc%u can only be %u",
+                CellRow[step->cell] + 1, CellColumn[step->cell] + 1, step->value);
+            break;
+        case STEP_HIDDENSINGLE:
+            length = sprintf(text, "Hidden single: %u can only go in r%uc%u within %s",
+                step->value, CellRow[step->cell] + 1, CellColumn[step->cell] + 1, unit);
+            break;
+        case STEP_POINTING:
+            length = sprintf(text, "Pointing: %u within %s can only go in %s", first, unit, target);
+            break;
+        case STEP_CLAIMING:
+            length = sprintf(text, "Claiming: %u within %s can only go in %s", first, unit, target);
+            break;
+        case STEP_NAKEDPAIR:
+            length = sprintf(text, "Naked pair: r%uc%u and r%uc%u within %s can only be %u and %u",
+                CellRow[step->cells[0]] + 1, CellColumn[step->cells[0]] + 1,
+                CellRow[step->cells[1]] + 1, CellColumn[step->cells[1]] + 1, unit, first, second);
+            break;
+        case STEP_CONTRADICTION:
+            if (step->contradiction == CONTRADICTION_EMPTYCELL && step->cellcount) {
+                length = sprintf(text, "Contradiction: r%uc%u has no candidates left",
+                    CellRow[step->cells[0]] + 1, CellColumn[step->cells[0]] + 1);
+            } else if (step->contradiction == CONTRADICTION_DUPLICATE && step->unit < SUDOKU_UNITS) {
+                length = sprintf(text, "Contradiction: %u is used twice within %s", first, unit);
+            } else if (step->contradiction == CONTRADICTION_NOPLACE && step->unit < SUDOKU_UNITS) {
+                length = sprintf(text, "Contradiction: %u has nowhere left to go within %s", first, unit);
+            } else {
+                length = sprintf(text, "Contradiction: the board can't be solved");
+            }
+            break;
+        default:
+            length = sprintf(text, "No step found");
+            break;
+    }
+
+    // then what it removes
+    for (i = 0; i < step->eliminationcount; ++i) {
+        length += sprintf(text + length, "%s r%uc%u %u", i ? "," : ", removing",
+            CellRow[step->eliminations[i].cell] + 1, CellColumn[step->eliminations[i].cell] + 1, step->eliminations[i].value);
+    }
+
+    if ((size_t)length >= size) {
+        return 0;
+    }
+
+    memcpy(buffer, text, (size_t)length + 1);
+
+    return (size_t)length;
+}
@@ -0,0 +1,107 @@
+#ifndef SUDOKU_HINTS_H
+#define SUDOKU_HINTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "SudokuSolver.h"
+
+// the deductions a step can be, cheapest first
+#define STEP_NONE           0
+#define STEP_NAKEDSINGLE    1
+#define STEP_HIDDENSINGLE   2
+#define STEP_POINTING       3
+#define STEP_CLAIMING       4
+#define STEP_NAKEDPAIR      5
+#define STEP_CONTRADICTION  6
+
+// the most candidates a single step removes, a naked pair takes 2 values from the 7 other cells of its unit
+#define MAXSTEPELIMINATIONS 16
+
+// the most bytes DescribeStep writes
+#define STEPDESCRIPTIONSIZE 256
+
+// A structure defining a candidate a step removes
+typedef struct {
+    // the cell from 0 - 80
+    unsigned char cell;
+
+    // the value from 1 - 9
+    unsigned char value;
+} StepElimination;
+
+// A structure defining the next deduction that can be made on a board
+typedef struct {
+    // the STEP_ deduction
+    unsigned int technique;
+
+    // the unit the deduction was made in, SUDOKU_UNITS when it only needed one cell
+    unsigned int unit;
+
+    // the unit the eliminations were made in, SUDOKU_UNITS when there are none
+    unsigned int target;
+
+    // the cells that make up the deduction
+    unsigned char cells[SUDOKU_SIZE];
+
+    // the number of cells that make up the deduction
+    unsigned int cellcount;
+
+    // the values the deduction is about, value v is bit v - 1
+    unsigned short values;
+
+    // the cell to place a value in, SUDOKU_CELLS when the step only removes candidates
+    unsigned int cell;
+
+    // the value to place from 1 - 9
+    unsigned int value;
+
+    // the candidates removed
+    StepElimination eliminations[MAXSTEPELIMINATIONS];
+
+    // the number of candidates removed
+    unsigned int eliminationcount;
+
+    // the CONTRADICTION_ reason when the board can't be solved
+    unsigned int contradiction;
+} SudokuStep;
+
+//! Function to find the cheapest deduction that can be made on a board
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    Receives the deduction
+ *
+ *  @returns    boolean         Whether a deduction or a contradiction was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The techniques are tried cheapest first and the search stops at the first hit.
+ *        The grid isn't changed and the candidates are only rebuilt when a placement
+ *        has made them stale, so any candidates removed before are kept
+ */
+bool FindNextStep(Sudoku *sudoku, SudokuStep *step);
+
+//! Function to make the placement or remove the candidates of a step
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SudokuStep *    A pointer to a step found on the sudoku
+ *
+ *  @returns    boolean         Whether the step was applied
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ApplyStep(Sudoku *sudoku, const SudokuStep *step);
+
+//! Function to explain a step in words
+/*!
+ *  @param      SudokuStep *    A pointer to the step
+ *  @param      char *          The buffer to write to
+ *  @param      size_t          The size of the buffer, STEPDESCRIPTIONSIZE is always enough
+ *
+ *  @returns    size_t          The length of the explanation, 0 if it didn't fit
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+size_t DescribeStep(const SudokuStep *step, char *buffer, size_t size);
+
+#endif
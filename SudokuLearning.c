@@ -0,0 +1,552 @@
+#include "SudokuLearning.h"
+
+// the guesses a dead end depends on, bit l is the guess made at level l
+typedef struct {
+    unsigned long long bits[2];
+} LevelSet;
+
+#define LEVELSET_ADD(s, l)  ((s)->bits[(l) >> 6] |= (1ull << ((l) & 63)))
+#define LEVELSET_HAS(s, l)  (((s)->bits[(l) >> 6] >> ((l) & 63)) & 1)
+
+// A structure defining a search that learns from its dead ends
+typedef struct {
+    // the board after the givens were propagated, dead ends are explained from here
+    Sudoku *root;
+
+    // the nogoods learned so far
+    NogoodStore *store;
+
+    // the guesses made to reach the board being searched, entry l is the guess made at level l
+    Log *trail;
+} LearningSearch;
+
+//! Function to order nogoods from the most to the least active
+/*!
+ *  @param      void *          The first Nogood
+ *  @param      void *          The second Nogood
+ *
+ *  @returns    int             Less than 0 if the first should come first
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static int CompareNogoods(const void *first, const void *second)
+{
+    unsigned int a = ((const Nogood*)first)->activity;
+    unsigned int b = ((const Nogood*)second)->activity;
+
+    return (a < b) - (a > b);
+}
+
+//! Function to throw away the least useful half of a store
+/*!
+ *  @param      NogoodStore *   A pointer to the store
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The nogoods that pruned the most are kept, every activity is halved so old successes fade
+ */
+static void CleanNogoods(NogoodStore *store)
+{
+    unsigned int i = 0;
+
+    qsort(store->nogoods, store->count, sizeof(Nogood), CompareNogoods);
+    store->count /= 2;
+
+    for (i = 0; i < store->count; ++i) {
+        store->nogoods[i].activity /= 2;
+    }
+
+    store->cleanups++;
+}
+
+//! Function to propagate a board with the rules of sudoku and every nogood learned
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to propagate
+ *  @param      NogoodStore *   The nogoods
+ *
+ *  @returns    unsigned int    PROPAGATE_COMPLETE, PROPAGATE_INCOMPLETE or PROPAGATE_CONTRADICTION
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A nogood with every placement made is a contradiction, one with every placement
+ *        but one made takes the last one out of the candidates of its cell
+ */
+static unsigned int PropagateNogoods(Sudoku *sudoku, NogoodStore *store)
+{
+    unsigned int i = 0, l = 0, status = 0, cell = 0, value = 0, unknown = 0, pending = 0;
+    bool changed = true;
+    Nogood *nogood = NULL;
+
+    while (changed) {
+        changed = false;
+
+        status = PropagateSudoku(sudoku);
+
+        if (status != PROPAGATE_INCOMPLETE) {
+            return status;
+        }
+
+        for (i = 0; i < store->count; ++i) {
+            nogood = &store->nogoods[i];
+            unknown = 0;
+
+            for (l = 0; l < nogood->size; ++l) {
+                cell = LITERAL_CELL(nogood->literals[l]);
+                value = LITERAL_VALUE(nogood->literals[l]);
+
+                // already made
+                if (CELL_VALUE(sudoku, cell) == value) {
+                    continue;
+                }
+
+                // can't be made, so the nogood can never bite
+                if (CELL_VALUE(sudoku, cell)
+                    || !(CELL_CANDIDATES(sudoku, cell) & VALUE_BIT(value))) {
+                    break;
+                }
+
+                // more than one left to make, nothing to do yet
+                if (unknown++) {
+                    break;
+                }
+
+                pending = nogood->literals[l];
+            }
+
+            if (l < nogood->size) {
+                continue;
+            }
+
+            nogood->activity++;
+
+            // every placement made
+            if (!unknown) {
+                sudoku->contradiction = CONTRADICTION_NOGOOD;
+                return PROPAGATE_CONTRADICTION;
+            }
+
+            // the last placement can't be made
+            EliminateCandidate(sudoku, CellColumn[LITERAL_CELL(pending)], CellRow[LITERAL_CELL(pending)], LITERAL_VALUE(pending));
+            changed = true;
+        }
+    }
+
+    return status;
+}
+
+//! Function to blame a dead end on every guess made to reach it
+/*!
+ *  @param      LevelSet *      Receives the guesses
+ *  @param      unsigned int    The number of guesses made
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void BlameEveryGuess(LevelSet *conflict, unsigned int level)
+{
+    unsigned int l = 0;
+
+    memset(conflict, 0, sizeof(LevelSet));
+
+    for (l = 0; l < level; ++l) {
+        LEVELSET_ADD(conflict, l);
+    }
+}
+
+//! Function to check whether some of the guesses on the trail propagate to a contradiction
+/*!
+ *  @param      LearningSearch * The search
+ *  @param      boolean *       Whether each guess on the trail is used
+ *  @param      Sudoku*         A board to replay the guesses on
+ *
+ *  @returns    boolean         Whether the guesses used lead to a contradiction
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool ReplayTrail(LearningSearch *search, const bool *used, Sudoku *board)
+{
+    unsigned int l = 0, cell = 0, value = 0;
+    LogEntry *entry = NULL;
+
+    CopySudoku(board, search->root);
+
+    for (l = 0; l < search->trail->count; ++l) {
+        if (!used[l]) {
+            continue;
+        }
+
+        entry = &search->trail->entries[l];
+        cell = CELL(entry->x, entry->y);
+        value = entry->value;
+
+        // the guesses already used may force this one or rule it out
+        if (CELL_VALUE(board, cell) == value) {
+            continue;
+        }
+
+        if (CELL_VALUE(board, cell)
+            || !(CELL_CANDIDATES(board, cell) & VALUE_BIT(value))) {
+            return true;
+        }
+
+        PlaceNumber(board, entry->x, entry->y, value);
+    }
+
+    return (PropagateNogoods(board, search->store) == PROPAGATE_CONTRADICTION);
+}
+
+//! Function to take out as many of a run of guesses as can go while the rest still lead to a contradiction
+/*!
+ *  @param      LearningSearch * The search
+ *  @param      boolean *       Whether each guess on the trail is used
+ *  @param      unsigned int    The first guess of the run
+ *  @param      unsigned int    The guess after the last of the run
+ *  @param      Sudoku*         A board to replay the guesses on
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The whole run is tried first and only split in half when it can't all go,
+ *        so a dead end caused by a few guesses is explained in a few replays
+ */
+static void DropGuesses(LearningSearch *search, bool *used, unsigned int first, unsigned int last, Sudoku *board)
+{
+    unsigned int l = 0;
+
+    if (first >= last) {
+        return;
+    }
+
+    for (l = first; l < last; ++l) {
+        used[l] = false;
+    }
+
+    if (ReplayTrail(search, used, board)) {
+        return;
+    }
+
+    for (l = first; l < last; ++l) {
+        used[l] = true;
+    }
+
+    // a single guess that can't go is part of the explanation
+    if (last - first == 1) {
+        return;
+    }
+
+    DropGuesses(search, used, first, first + ((last - first) / 2), board);
+    DropGuesses(search, used, first + ((last - first) / 2), last, board);
+}
+
+//! Function to find a small set of guesses on the trail that lead to a contradiction
+/*!
+ *  @param      LearningSearch * The search
+ *  @param      boolean         Whether the whole trail is already known to lead to a contradiction
+ *  @param      LevelSet *      Receives the guesses
+ *
+ *  @returns    boolean         Whether the trail leads to a contradiction at all
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Guesses are only left in when taking them out means the rest no longer lead to a contradiction
+ */
+static bool ExplainConflict(LearningSearch *search, bool known, LevelSet *conflict)
+{
+    bool used[SUDOKU_CELLS];
+    unsigned int l = 0;
+    Sudoku board;
+
+    memset(conflict, 0, sizeof(LevelSet));
+
+    if (!InitializeSudokuStorage(&board, search->root->threshold, search->root->maxguesscount)) {
+        return false;
+    }
+
+    board.verbose = false;
+
+    for (l = 0; l < search->trail->count; ++l) {
+        used[l] = true;
+    }
+
+    // make sure there is something to explain
+    if (!known
+        && !ReplayTrail(search, used, &board)) {
+        return false;
+    }
+
+    // take out every guess we don't need
+    DropGuesses(search, used, 0, search->trail->count, &board);
+
+    for (l = 0; l < search->trail->count; ++l) {
+        if (used[l]) {
+            LEVELSET_ADD(conflict, l);
+        }
+    }
+
+    return true;
+}
+
+//! Function to store the guesses behind a dead end as a nogood
+/*!
+ *  @param      LearningSearch * The search
+ *  @param      LevelSet *      The guesses
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void LearnNogood(LearningSearch *search, const LevelSet *conflict)
+{
+    NogoodStore *store = search->store;
+    unsigned int l = 0, size = 0;
+    Nogood *nogood = NULL;
+    LogEntry *entry = NULL;
+
+    for (l = 0; l < search->trail->count; ++l) {
+        size += LEVELSET_HAS(conflict, l);
+    }
+
+    // too long to be worth checking every board against
+    if (!size
+        || size > MAXNOGOODSIZE) {
+        return;
+    }
+
+    // make room
+    if (store->count == store->capacity) {
+        CleanNogoods(store);
+    }
+
+    nogood = &store->nogoods[store->count++];
+    nogood->size = 0;
+    nogood->activity = 0;
+
+    for (l = 0; l < search->trail->count; ++l) {
+        if (LEVELSET_HAS(conflict, l)) {
+            entry = &search->trail->entries[l];
+            nogood->literals[nogood->size++] = NOGOOD_LITERAL(CELL(entry->x, entry->y), entry->value);
+        }
+    }
+
+    store->learned++;
+}
+
+//! Function which searches a board, explaining and learning from its dead ends
+/*!
+ *  @param      LearningSearch * The search
+ *  @param      Sudoku*         The board to search, receives the solution
+ *  @param      unsigned int    The number of guesses made to reach the board
+ *  @param      LevelSet *      Receives the guesses a dead end depends on
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool SearchLearning(LearningSearch *search, Sudoku *sudoku, unsigned int level, LevelSet *conflict)
+{
+    unsigned int x = 0, y = 0, g = 0;
+    GuessRanking ranking;
+    LevelSet childconflict;
+    LogEntry *entry = NULL;
+    Sudoku branch;
+
+    search->trail->count = level;
+
+    // someone else has already finished, what we'd learn no longer matters
+    if (SEARCH_CANCELLED(sudoku)) {
+        BlameEveryGuess(conflict, level);
+        return false;
+    }
+
+    // a dead end is explained by the guesses that lead to it
+    switch (PropagateNogoods(sudoku, search->store)) {
+        case PROPAGATE_COMPLETE:
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            search->store->conflicts++;
+
+            if (ExplainConflict(search, true, conflict)) {
+                LearnNogood(search, conflict);
+            } else {
+                BlameEveryGuess(conflict, level);
+            }
+
+            return false;
+    }
+
+    // grab the cell to guess in, its guesses and a board on the stack to try them on
+    if (!FindMostConstrainedCell(sudoku, &x, &y)
+        || !RankCellGuesses(sudoku, x, y, &ranking)
+        || !InitializeSudokuStorage(&branch, sudoku->threshold, sudoku->maxguesscount)) {
+        // blame every guess when we can't say which
+        BlameEveryGuess(conflict, level);
+        return false;
+    }
+
+    branch.verbose = false;
+
+    for (g = 0; g < ranking.count; ++g) {
+        // log the guess at this level
+        entry = &search->trail->entries[level];
+        entry->x = ranking.guesses[g].x;
+        entry->y = ranking.guesses[g].y;
+        entry->value = ranking.guesses[g].value;
+        entry->probability = ranking.guesses[g].probability;
+        entry->id = level;
+
+        CopySudoku(&branch, sudoku);
+        PlaceNumber(&branch, entry->x, entry->y, entry->value);
+
+        // count the guess if anyone is keeping track
+        if (sudoku->guesscounter) {
+            (*sudoku->guesscounter)++;
+        }
+
+        if (SearchLearning(search, &branch, level + 1, &childconflict)) {
+            CopySudoku(sudoku, &branch);
+            return true;
+        }
+
+        search->trail->count = level;
+
+        // unwind straight away once cancelled
+        if (SEARCH_CANCELLED(sudoku)) {
+            BlameEveryGuess(conflict, level);
+            return false;
+        }
+
+        // the dead end didn't depend on this guess so no other guess here can help, jump straight back
+        if (!LEVELSET_HAS(&childconflict, level)) {
+            *conflict = childconflict;
+            search->store->backjumps++;
+            return false;
+        }
+    }
+
+    // every guess failed and each left a nogood behind, which now make this board a contradiction
+    search->store->conflicts++;
+
+    if (ExplainConflict(search, false, conflict)) {
+        LearnNogood(search, conflict);
+    } else {
+        BlameEveryGuess(conflict, level);
+    }
+
+    return false;
+}
+
+//! Function to initialize a store of nogoods
+/*!
+ *  @param      NogoodStore *   A pointer to the store to initialize
+ *  @param      unsigned int    The most nogoods to keep, 0 for NOGOODCAPACITY
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the store was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeNogoodStore(NogoodStore *store, unsigned int capacity, const SudokuAllocator *allocator)
+{
+    // sanity
+    if (!store) {
+        return false;
+    }
+
+    memset(store, 0, sizeof(NogoodStore));
+
+    // a clean up keeps half, so there has to be room for two
+    store->allocator = allocator;
+    store->capacity = MAX(capacity ? capacity : NOGOODCAPACITY, 2);
+    store->nogoods = (Nogood*)AllocateMemory(allocator, store->capacity * sizeof(Nogood));
+
+    // sanity check it
+    if (!store->nogoods) {
+        store->capacity = 0;
+        return false;
+    }
+
+    return true;
+}
+
+//! Function to cleanup a store of nogoods
+/*!
+ *  @param      NogoodStore *   A pointer to the store to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyNogoodStore(NogoodStore *store)
+{
+    // sanity
+    if (!store) {
+        return;
+    }
+
+    FreeMemory(store->allocator, store->nogoods, store->capacity * sizeof(Nogood));
+    memset(store, 0, sizeof(NogoodStore));
+}
+
+//! Function which searches for a solution, learning from every dead end
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      NogoodStore *   The store to learn into, emptied first
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The guesses leading to each board are kept in a Log. A dead end is explained by
+ *        taking guesses out of the log while the rest still propagate to a contradiction,
+ *        the guesses left are stored as a nogood that later boards are pruned with, and the
+ *        search jumps straight back to the newest guess the dead end depends on.
+ *        Nogoods only hold for the givens they were learned with, and every guess is
+ *        needed to prove a puzzle has no solution so the guess limit of the sudoku is ignored.
+ */
+bool SearchSudokuLearning(Sudoku *sudoku, NogoodStore *store)
+{
+    LogEntry entries[SUDOKU_CELLS];
+    LearningSearch search;
+    LevelSet conflict;
+    Sudoku root, board;
+    Log trail;
+
+    // sanity
+    if (!sudoku
+        || !store
+        || !store->nogoods) {
+        return false;
+    }
+
+    // nogoods learned on other givens don't hold here
+    store->count = 0;
+
+    // propagate the givens once, every explanation starts from here
+    if (!InitializeSudokuStorage(&root, sudoku->threshold, sudoku->maxguesscount)
+        || !InitializeSudokuStorage(&board, sudoku->threshold, sudoku->maxguesscount)) {
+        return false;
+    }
+
+    root.verbose = false;
+    board.verbose = false;
+    CopySudoku(&root, sudoku);
+
+    switch (PropagateSudoku(&root)) {
+        case PROPAGATE_COMPLETE:
+            CopySudoku(sudoku, &root);
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            return false;
+    }
+
+    trail.count = 0;
+    trail.entries = entries;
+
+    search.root = &root;
+    search.store = store;
+    search.trail = &trail;
+
+    CopySudoku(&board, &root);
+
+    if (!SearchLearning(&search, &board, 0, &conflict)) {
+        return false;
+    }
+
+    CopySudoku(sudoku, &board);
+
+    return true;
+}
@@ -0,0 +1,94 @@
+#ifndef SUDOKU_LEARNING_H
+#define SUDOKU_LEARNING_H
+
+#include "SudokuSolver.h"
+
+// the most placements a nogood can hold, longer conflicts still backjump but aren't kept
+#define MAXNOGOODSIZE 16
+
+// the number of nogoods a store keeps when the caller doesn't say
+#define NOGOODCAPACITY 1024
+
+// a placement of value v in cell c as held in a nogood
+#define NOGOOD_LITERAL(c, v)  ((unsigned short)(((c) * SUDOKU_SIZE) + (v) - 1))
+#define LITERAL_CELL(l)       ((l) / SUDOKU_SIZE)
+#define LITERAL_VALUE(l)      (((l) % SUDOKU_SIZE) + 1)
+
+// A structure defining placements that can't all be made on the same board
+typedef struct {
+    // the placements, each from NOGOOD_LITERAL
+    unsigned short literals[MAXNOGOODSIZE];
+
+    // the number of placements
+    unsigned int size;
+
+    // the number of times the nogood has pruned a board, halved at every clean up
+    unsigned int activity;
+} Nogood;
+
+// A structure defining the nogoods learned while searching a sudoku
+typedef struct {
+    // the nogoods
+    Nogood *nogoods;
+
+    // the number of nogoods held
+    unsigned int count;
+
+    // the most nogoods held, half of them are thrown away when it is reached
+    unsigned int capacity;
+
+    // the number of dead ends explained
+    unsigned long long conflicts;
+
+    // the number of nogoods learned
+    unsigned long long learned;
+
+    // the number of times a search jumped back over more than one guess
+    unsigned long long backjumps;
+
+    // the number of clean ups
+    unsigned long long cleanups;
+
+    // where the store gets its memory from
+    const SudokuAllocator *allocator;
+} NogoodStore;
+
+//! Function to initialize a store of nogoods
+/*!
+ *  @param      NogoodStore *   A pointer to the store to initialize
+ *  @param      unsigned int    The most nogoods to keep, 0 for NOGOODCAPACITY
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the store was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeNogoodStore(NogoodStore *store, unsigned int capacity, const SudokuAllocator *allocator);
+
+//! Function to cleanup a store of nogoods
+/*!
+ *  @param      NogoodStore *   A pointer to the store to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyNogoodStore(NogoodStore *store);
+
+//! Function which searches for a solution, learning from every dead end
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      NogoodStore *   The store to learn into, emptied first
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The guesses leading to each board are kept in a Log. A dead end is explained by
+ *        taking guesses out of the log while the rest still propagate to a contradiction,
+ *        the guesses left are stored as a nogood that later boards are pruned with, and the
+ *        search jumps straight back to the newest guess the dead end depends on.
+ *        Nogoods only hold for the givens they were learned with, and every guess is
+ *        needed to prove a puzzle has no solution so the guess limit of the sudoku is ignored.
+ */
+bool SearchSudokuLearning(Sudoku *sudoku, NogoodStore *store);
+
+#endif
@@ -0,0 +1,380 @@
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "SudokuLibrary.h"
+#include "SudokuParallel.h"
+#include "SudokuValidator.h"
+#include "SudokuMetrics.h"
+
+// the most threads a batch will start
+#define MAXBATCHTHREADS 64
+
+// the number of puzzles a batch thread claims at a time
+#define BATCHCHUNKSIZE 16
+
+// guesses are never limited, a puzzle can't need more than one per cell
+#define LIBRARYMAXGUESSES 81
+
+// A structure defining a batch of puzzles shared by the threads solving it
+typedef struct {
+    // the puzzles, 81 bytes each
+    const unsigned char *puzzles;
+
+    // the solutions, 81 bytes each
+    unsigned char *solutions;
+
+    // the result of every puzzle, or NULL
+    unsigned char *results;
+
+    // the number of puzzles
+    unsigned int count;
+
+    // the next puzzle to claim
+    atomic_uint next;
+
+    // the number of puzzles solved
+    atomic_uint solved;
+} LibraryBatch;
+
+// the running totals of the library
+static atomic_ullong TotalPuzzles;
+static atomic_ullong TotalSolved;
+static atomic_ullong TotalUnsolved;
+static atomic_ullong TotalInvalid;
+static atomic_ullong TotalGuesses;
+static atomic_ullong TotalNanoseconds;
+
+//! Function to load a puzzle onto a board, checking the givens as it goes
+/*!
+ *  @param      Sudoku*         The board to load onto
+ *  @param      unsigned char[81] The puzzle
+ *
+ *  @returns    boolean         Returns false if the puzzle is invalid
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool LoadPuzzle(Sudoku *sudoku, const unsigned char puzzle[81])
+{
+    unsigned int c = 0;
+
+    ResetSudoku(sudoku);
+
+    // out of range or already given in one of its units
+    if (!ValidateGivens(puzzle, NULL)) {
+        return false;
+    }
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        CELL_VALUE(sudoku, c) = puzzle[c];
+    }
+
+    return true;
+}
+
+
+//! Function to solve a single puzzle on a board
+/*!
+ *  @param      Sudoku*         The board to solve on
+ *  @param      unsigned char[81] The puzzle
+ *  @param      unsigned char[81] Receives the solution, or the puzzle if it wasn't solved
+ *
+ *  @returns    unsigned int    The result of the puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int SolvePuzzle(Sudoku *sudoku, const unsigned char puzzle[81], unsigned char solution[81])
+{
+    unsigned int c = 0, result = SUDOKU_RESULT_INVALID;
+
+    if (LoadPuzzle(sudoku, puzzle)) {
+        SearchSudoku(sudoku, 0);
+        result = IsSudokuComplete(sudoku) ? SUDOKU_RESULT_SOLVED : SUDOKU_RESULT_UNSOLVED;
+    }
+
+    // hand back the solution, anything else leaves the puzzle as it was
+    if (result == SUDOKU_RESULT_SOLVED) {
+        for (c = 0; c < SUDOKU_CELLS; ++c) {
+            solution[c] = (unsigned char)CELL_VALUE(sudoku, c);
+        }
+    } else if (solution != puzzle) {
+        memcpy(solution, puzzle, SUDOKU_CELLS);
+    }
+
+    // add to our totals
+    atomic_fetch_add(&TotalPuzzles, 1);
+
+    if (result == SUDOKU_RESULT_SOLVED) {
+        atomic_fetch_add(&TotalSolved, 1);
+    } else if (result == SUDOKU_RESULT_UNSOLVED) {
+        atomic_fetch_add(&TotalUnsolved, 1);
+    } else {
+        atomic_fetch_add(&TotalInvalid, 1);
+    }
+
+    return result;
+}
+
+//! Function to set up a quiet board for the library to solve on
+/*!
+ *  @param      Sudoku*         The board to set up
+ *  @param      unsigned long long * Counts the guesses made on the board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void InitializeLibraryBoard(Sudoku *sudoku, unsigned long long *guesses)
+{
+    InitializeSudokuStorage(sudoku, 0, LIBRARYMAXGUESSES);
+    sudoku->verbose = false;
+    sudoku->guesscounter = guesses;
+}
+
+//! Function run by each thread solving a batch
+/*!
+ *  @param      void *          A pointer to the LibraryBatch
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *RunBatchSolver(void *argument)
+{
+    LibraryBatch *batch = (LibraryBatch*)argument;
+    unsigned long long guesses = 0, start = MetricsNanoseconds();
+    unsigned int first = 0, i = 0, solved = 0, result = 0;
+    Sudoku sudoku;
+
+    InitializeLibraryBoard(&sudoku, &guesses);
+
+    // claim chunks of puzzles until there are none left
+    while ((first = atomic_fetch_add(&batch->next, BATCHCHUNKSIZE)) < batch->count) {
+        for (i = first; i < first + BATCHCHUNKSIZE && i < batch->count; ++i) {
+            result = SolvePuzzle(&sudoku, batch->puzzles + (i * SUDOKU_CELLS), batch->solutions + (i * SUDOKU_CELLS));
+
+            if (batch->results) {
+                batch->results[i] = (unsigned char)result;
+            }
+
+            if (result == SUDOKU_RESULT_SOLVED) {
+                solved++;
+            }
+        }
+    }
+
+    atomic_fetch_add(&batch->solved, solved);
+    atomic_fetch_add(&TotalGuesses, guesses);
+    atomic_fetch_add(&TotalNanoseconds, MetricsNanoseconds() - start);
+
+    // pooled blocks would die with the thread otherwise
+    ReleasePoolMemory();
+
+    return NULL;
+}
+
+//! Function to get the version of the library
+/*!
+ *  @returns    unsigned int    The version the library was built with, in the form of SUDOKU_VERSION
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API unsigned int SudokuVersion(void)
+{
+    return SUDOKU_VERSION;
+}
+
+//! Function to solve a puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle left to right, top to bottom, 1 - 9 for givens and 0 for blanks
+ *  @param      unsigned char[81] Receives the solution, may be the same as the puzzle
+ *
+ *  @returns    unsigned int    SUDOKU_RESULT_SOLVED, SUDOKU_RESULT_UNSOLVED or SUDOKU_RESULT_INVALID
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Invalid puzzles have a number above 9 or two of the same given in a row, column or box
+ */
+SUDOKU_API unsigned int SudokuSolve(const unsigned char puzzle[81], unsigned char solution[81])
+{
+    unsigned long long guesses = 0, start = MetricsNanoseconds();
+    unsigned int result = 0;
+    Sudoku sudoku;
+
+    // sanity
+    if (!puzzle
+        || !solution) {
+        return SUDOKU_RESULT_INVALID;
+    }
+
+    InitializeLibraryBoard(&sudoku, &guesses);
+    result = SolvePuzzle(&sudoku, puzzle, solution);
+
+    atomic_fetch_add(&TotalGuesses, guesses);
+    atomic_fetch_add(&TotalNanoseconds, MetricsNanoseconds() - start);
+
+    return result;
+}
+
+//! Function to solve an array of puzzles
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each laid out as for SudokuSolve
+ *  @param      unsigned char * Receives the solutions, 81 bytes each, may be the same as the puzzles
+ *  @param      unsigned char * Receives the result of every puzzle, or NULL
+ *  @param      unsigned int    The number of puzzles
+ *  @param      unsigned int    The number of threads to solve with, 0 or 1 solves on the calling thread
+ *
+ *  @returns    unsigned int    The number of puzzles solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API unsigned int SudokuSolveBatch(const unsigned char *puzzles, unsigned char *solutions, unsigned char *results, unsigned int count, unsigned int threads)
+{
+    pthread_t workers[MAXBATCHTHREADS];
+    unsigned int i = 0, started = 0;
+    LibraryBatch batch;
+
+    // sanity
+    if (!puzzles
+        || !solutions
+        || !count) {
+        return 0;
+    }
+
+    batch.puzzles = puzzles;
+    batch.solutions = solutions;
+    batch.results = results;
+    batch.count = count;
+    atomic_init(&batch.next, 0);
+    atomic_init(&batch.solved, 0);
+
+    // never start more threads than there are chunks to go round
+    threads = MIN(MIN(threads, MAXBATCHTHREADS), (count + BATCHCHUNKSIZE - 1) / BATCHCHUNKSIZE);
+
+    // the calling thread is one of the solvers
+    for (started = 0; started + 1 < threads; ++started) {
+        if (pthread_create(&workers[started], NULL, RunBatchSolver, &batch) != 0) {
+            break;
+        }
+    }
+
+    RunBatchSolver(&batch);
+
+    for (i = 0; i < started; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+
+    return atomic_load(&batch.solved);
+}
+
+//! Function to count the solutions of a puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle laid out as for SudokuSolve
+ *  @param      unsigned int    The number of solutions to stop counting at, 0 to count them all
+ *  @param      unsigned int    The number of threads to search with
+ *
+ *  @returns    unsigned int    The number of solutions found, 0 for an invalid puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A limit of 2 is enough to tell whether a puzzle has a unique solution
+ */
+SUDOKU_API unsigned int SudokuCountSolutions(const unsigned char puzzle[81], unsigned int limit, unsigned int threads)
+{
+    Sudoku sudoku;
+
+    // sanity
+    if (!puzzle) {
+        return 0;
+    }
+
+    InitializeLibraryBoard(&sudoku, NULL);
+
+    if (!LoadPuzzle(&sudoku, puzzle)) {
+        return 0;
+    }
+
+    sudoku.threads = MAX(threads, 1);
+
+    return CountSolutionsParallel(&sudoku, limit);
+}
+
+//! Function to check an array of puzzles or solutions
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each laid out as for SudokuSolve
+ *  @param      unsigned char * The solutions to check against the puzzles, or NULL to check the puzzles alone
+ *  @param      SudokuValidation * Receives what is wrong with every grid, or NULL
+ *  @param      unsigned int    The number of grids
+ *
+ *  @returns    unsigned int    The number of valid grids
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A valid solution has every cell from 1 - 9, no value twice in a row, column or box
+ *        and keeps every given of its puzzle
+ */
+SUDOKU_API unsigned int SudokuValidate(const unsigned char *puzzles, const unsigned char *solutions, SudokuValidation *results, unsigned int count)
+{
+    ValidationResult result;
+    unsigned int i = 0, valid = 0;
+    bool ok = false;
+
+    // sanity
+    if (!puzzles) {
+        return 0;
+    }
+
+    for (i = 0; i < count; ++i) {
+        if (solutions) {
+            ok = ValidateSolution(puzzles + (i * SUDOKU_CELLS), solutions + (i * SUDOKU_CELLS), &result);
+        } else {
+            ok = ValidateGivens(puzzles + (i * SUDOKU_CELLS), &result);
+        }
+
+        if (ok) {
+            valid++;
+        }
+
+        // the library's error codes are the same as the validator's
+        if (results) {
+            results[i].error = (unsigned char)result.error;
+            results[i].cell = (unsigned char)result.cell;
+            results[i].unit = (unsigned char)result.unit;
+            results[i].value = (unsigned char)result.value;
+        }
+    }
+
+    return valid;
+}
+
+//! Function to read the running totals of the library
+/*!
+ *  @param      SudokuStats *   Receives the totals
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API void SudokuGetStats(SudokuStats *stats)
+{
+    // sanity
+    if (!stats) {
+        return;
+    }
+
+    stats->puzzles = atomic_load(&TotalPuzzles);
+    stats->solved = atomic_load(&TotalSolved);
+    stats->unsolved = atomic_load(&TotalUnsolved);
+    stats->invalid = atomic_load(&TotalInvalid);
+    stats->guesses = atomic_load(&TotalGuesses);
+    stats->nanoseconds = atomic_load(&TotalNanoseconds);
+}
+
+//! Function to zero the running totals of the library
+/*!
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API void SudokuResetStats(void)
+{
+    atomic_store(&TotalPuzzles, 0);
+    atomic_store(&TotalSolved, 0);
+    atomic_store(&TotalUnsolved, 0);
+    atomic_store(&TotalInvalid, 0);
+    atomic_store(&TotalGuesses, 0);
+    atomic_store(&TotalNanoseconds, 0);
+}
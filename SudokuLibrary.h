@@ -0,0 +1,155 @@
+#ifndef SUDOKU_LIBRARY_H
+#define SUDOKU_LIBRARY_H
+
+// The public interface of libsudoku. Only what is in this header is exported by
+// libsudoku.so and none of it reads or writes stdio.
+
+// the version of this header, compare against SudokuVersion() to catch a mismatched library
+#define SUDOKU_VERSION_MAJOR 1
+#define SUDOKU_VERSION_MINOR 1
+#define SUDOKU_VERSION_PATCH 0
+#define SUDOKU_VERSION ((SUDOKU_VERSION_MAJOR << 16) | (SUDOKU_VERSION_MINOR << 8) | SUDOKU_VERSION_PATCH)
+
+// marks what the shared library exports
+#if defined(__GNUC__)
+#define SUDOKU_API __attribute__((visibility("default")))
+#else
+#define SUDOKU_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the results of solving a puzzle
+#define SUDOKU_RESULT_SOLVED    0
+#define SUDOKU_RESULT_UNSOLVED  1
+#define SUDOKU_RESULT_INVALID   2
+
+// the problems SudokuValidate can find with a grid
+#define SUDOKU_VALID                0
+#define SUDOKU_ERROR_BADVALUE       1
+#define SUDOKU_ERROR_DUPLICATE      2
+#define SUDOKU_ERROR_INCOMPLETE     3
+#define SUDOKU_ERROR_MISMATCH       4
+
+// A structure defining what is wrong with a grid
+typedef struct {
+    // SUDOKU_VALID or the SUDOKU_ERROR found
+    unsigned char error;
+
+    // the first cell found to be wrong from 0 - 80
+    unsigned char cell;
+
+    // the row, column or box holding a duplicate, rows are 0 - 8, columns 9 - 17 and boxes 18 - 26
+    unsigned char unit;
+
+    // the value found in the cell
+    unsigned char value;
+} SudokuValidation;
+
+// A structure defining the running totals of everything the library has solved
+typedef struct {
+    // the number of puzzles given to SudokuSolve and SudokuSolveBatch
+    unsigned long long puzzles;
+
+    // the number of puzzles solved
+    unsigned long long solved;
+
+    // the number of puzzles with no solution
+    unsigned long long unsolved;
+
+    // the number of puzzles rejected as invalid
+    unsigned long long invalid;
+
+    // the number of guesses made while searching
+    unsigned long long guesses;
+
+    // the time spent solving in nanoseconds, summed over every thread
+    unsigned long long nanoseconds;
+} SudokuStats;
+
+//! Function to get the version of the library
+/*!
+ *  @returns    unsigned int    The version the library was built with, in the form of SUDOKU_VERSION
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API unsigned int SudokuVersion(void);
+
+//! Function to solve a puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle left to right, top to bottom, 1 - 9 for givens and 0 for blanks
+ *  @param      unsigned char[81] Receives the solution, may be the same as the puzzle
+ *
+ *  @returns    unsigned int    SUDOKU_RESULT_SOLVED, SUDOKU_RESULT_UNSOLVED or SUDOKU_RESULT_INVALID
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Invalid puzzles have a number above 9 or two of the same given in a row, column or box
+ */
+SUDOKU_API unsigned int SudokuSolve(const unsigned char puzzle[81], unsigned char solution[81]);
+
+//! Function to solve an array of puzzles
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each laid out as for SudokuSolve
+ *  @param      unsigned char * Receives the solutions, 81 bytes each, may be the same as the puzzles
+ *  @param      unsigned char * Receives the result of every puzzle, or NULL
+ *  @param      unsigned int    The number of puzzles
+ *  @param      unsigned int    The number of threads to solve with, 0 or 1 solves on the calling thread
+ *
+ *  @returns    unsigned int    The number of puzzles solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API unsigned int SudokuSolveBatch(const unsigned char *puzzles, unsigned char *solutions, unsigned char *results, unsigned int count, unsigned int threads);
+
+//! Function to count the solutions of a puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle laid out as for SudokuSolve
+ *  @param      unsigned int    The number of solutions to stop counting at, 0 to count them all
+ *  @param      unsigned int    The number of threads to search with
+ *
+ *  @returns    unsigned int    The number of solutions found, 0 for an invalid puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A limit of 2 is enough to tell whether a puzzle has a unique solution
+ */
+SUDOKU_API unsigned int SudokuCountSolutions(const unsigned char puzzle[81], unsigned int limit, unsigned int threads);
+
+//! Function to check an array of puzzles or solutions
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each laid out as for SudokuSolve
+ *  @param      unsigned char * The solutions to check against the puzzles, or NULL to check the puzzles alone
+ *  @param      SudokuValidation * Receives what is wrong with every grid, or NULL
+ *  @param      unsigned int    The number of grids
+ *
+ *  @returns    unsigned int    The number of valid grids
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A valid solution has every cell from 1 - 9, no value twice in a row, column or box
+ *        and keeps every given of its puzzle
+ */
+SUDOKU_API unsigned int SudokuValidate(const unsigned char *puzzles, const unsigned char *solutions, SudokuValidation *results, unsigned int count);
+
+//! Function to read the running totals of the library
+/*!
+ *  @param      SudokuStats *   Receives the totals
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API void SudokuGetStats(SudokuStats *stats);
+
+//! Function to zero the running totals of the library
+/*!
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+SUDOKU_API void SudokuResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
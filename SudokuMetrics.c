@@ -0,0 +1,532 @@
+#include <time.h>
+
+#include "SudokuSolver.h"
+
+#ifndef SUDOKU_NO_STDIO
+#include <signal.h>
+#endif
+
+// hands every set of metrics a different generation
+static atomic_ullong MetricsGenerations;
+
+// the shard this thread last recorded into, and the metrics it belongs to
+static _Thread_local MetricsShard *CachedShard;
+static _Thread_local unsigned long long CachedGeneration;
+
+//! Function to read a monotonic clock
+/*!
+ *  @returns    unsigned long long The time in nanoseconds
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned long long MetricsNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((unsigned long long)now.tv_sec * 1000000000ull) + (unsigned long long)now.tv_nsec;
+}
+
+//! Function to find the bucket a latency is counted in
+/*!
+ *  @param      unsigned long long The latency
+ *
+ *  @returns    unsigned int    The bucket
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Latencies below METRICSUBBUCKETS get a bucket each, above that every power of two
+ *        is split into METRICSUBBUCKETS buckets by the bits below its highest
+ */
+static unsigned int MetricBucket(unsigned long long value)
+{
+    unsigned int magnitude = 0;
+
+    if (value < METRICSUBBUCKETS) {
+        return (unsigned int)value;
+    }
+
+    // the position of the highest set bit
+#if defined(__GNUC__)
+    magnitude = 63 - (unsigned int)__builtin_clzll(value);
+#else
+    while (value >> (magnitude + 1)) {
+        magnitude++;
+    }
+#endif
+
+    return ((magnitude - METRICSUBBITS + 1) << METRICSUBBITS) + (unsigned int)((value >> (magnitude - METRICSUBBITS)) - METRICSUBBUCKETS);
+}
+
+//! Function to find the highest latency counted in a bucket
+/*!
+ *  @param      unsigned int    The bucket
+ *
+ *  @returns    unsigned long long The highest latency
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned long long MetricBucketHighest(unsigned int bucket)
+{
+    unsigned int shift = 0;
+
+    if (bucket < METRICSUBBUCKETS) {
+        return bucket;
+    }
+
+    // undo MetricBucket, every bucket is 2^shift latencies wide
+    shift = (bucket >> METRICSUBBITS) - 1;
+
+    return ((((unsigned long long)(bucket & (METRICSUBBUCKETS - 1)) + METRICSUBBUCKETS) << shift) + ((1ull << shift) - 1));
+}
+
+//! Function to find the shard the calling thread records into
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *
+ *  @returns    MetricsShard *  The shard
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A thread claims a shard the first time it records and keeps it, threads past
+ *        MAXMETRICSHARDS share the shards round robin
+ */
+static MetricsShard *ThreadShard(SudokuMetrics *metrics)
+{
+    unsigned int index = 0;
+
+    if (CachedGeneration != metrics->generation) {
+        index = atomic_fetch_add_explicit(&metrics->shardcount, 1, memory_order_relaxed);
+        CachedShard = &metrics->shards[index % MAXMETRICSHARDS];
+        CachedGeneration = metrics->generation;
+    }
+
+    return CachedShard;
+}
+
+//! Function to initialize an empty set of metrics
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics to initialize
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the metrics were initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudokuMetrics(SudokuMetrics *metrics, const SudokuAllocator *allocator)
+{
+    // sanity
+    if (!metrics) {
+        return false;
+    }
+
+    memset(metrics, 0, sizeof(SudokuMetrics));
+
+    // zeroed memory is a valid empty atomic on every platform we build for
+    metrics->shards = AllocateMemory(allocator, MAXMETRICSHARDS * sizeof(MetricsShard));
+
+    if (!metrics->shards) {
+        return false;
+    }
+
+    atomic_init(&metrics->shardcount, 0);
+    metrics->allocator = allocator;
+    metrics->started = MetricsNanoseconds();
+
+    // generation 0 is what a thread that has never recorded holds
+    metrics->generation = atomic_fetch_add(&MetricsGenerations, 1) + 1;
+
+    return true;
+}
+
+//! Function to cleanup a set of metrics
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: No thread may be recording into the metrics
+ */
+void DestroySudokuMetrics(SudokuMetrics *metrics)
+{
+    // sanity
+    if (!metrics) {
+        return;
+    }
+
+    FreeMemory(metrics->allocator, metrics->shards, MAXMETRICSHARDS * sizeof(MetricsShard));
+    memset(metrics, 0, sizeof(SudokuMetrics));
+}
+
+//! Function to record how long a solve took and how it ended
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *  @param      unsigned long long The latency in nanoseconds
+ *  @param      unsigned int    METRIC_SOLVED, METRIC_UNSOLVED or METRIC_GAVEUP
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Each thread records into its own shard so threads never share a cache line,
+ *        nothing is locked and a snapshot can be taken at any time
+ */
+void RecordSolveMetrics(SudokuMetrics *metrics, unsigned long long nanoseconds, unsigned int outcome)
+{
+    MetricsShard *shard = NULL;
+    unsigned long long longest = 0;
+
+    // sanity
+    if (!metrics
+        || !metrics->shards) {
+        return;
+    }
+
+    shard = ThreadShard(metrics);
+
+    // the shard is normally ours alone, the adds only contend once threads share shards
+    atomic_fetch_add_explicit(&shard->buckets[MetricBucket(nanoseconds)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->total, nanoseconds, memory_order_relaxed);
+
+    switch (outcome) {
+        case METRIC_SOLVED:
+            atomic_fetch_add_explicit(&shard->solved, 1, memory_order_relaxed);
+            break;
+        case METRIC_GAVEUP:
+            atomic_fetch_add_explicit(&shard->gaveup, 1, memory_order_relaxed);
+            break;
+        default:
+            atomic_fetch_add_explicit(&shard->unsolved, 1, memory_order_relaxed);
+            break;
+    }
+
+    longest = atomic_load_explicit(&shard->longest, memory_order_relaxed);
+
+    while (nanoseconds > longest
+        && !atomic_compare_exchange_weak_explicit(&shard->longest, &longest, nanoseconds, memory_order_relaxed, memory_order_relaxed));
+}
+
+//! Function to merge every shard of a set of metrics
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *  @param      MetricsSnapshot * Receives the totals
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Threads keep recording while the shards are read, so a solve may be counted in
+ *        some totals of a snapshot and not yet in others
+ */
+void SnapshotSudokuMetrics(SudokuMetrics *metrics, MetricsSnapshot *snapshot)
+{
+    unsigned int s = 0, b = 0, shards = 0;
+    unsigned long long longest = 0;
+    MetricsShard *shard = NULL;
+
+    // sanity
+    if (!snapshot) {
+        return;
+    }
+
+    memset(snapshot, 0, sizeof(MetricsSnapshot));
+
+    if (!metrics
+        || !metrics->shards) {
+        return;
+    }
+
+    // only the shards that have been claimed can hold anything
+    shards = MIN(atomic_load_explicit(&metrics->shardcount, memory_order_relaxed), MAXMETRICSHARDS);
+
+    for (s = 0; s < shards; ++s) {
+        shard = &metrics->shards[s];
+
+        for (b = 0; b < METRICBUCKETS; ++b) {
+            snapshot->buckets[b] += atomic_load_explicit(&shard->buckets[b], memory_order_relaxed);
+        }
+
+        snapshot->count += atomic_load_explicit(&shard->count, memory_order_relaxed);
+        snapshot->solved += atomic_load_explicit(&shard->solved, memory_order_relaxed);
+        snapshot->unsolved += atomic_load_explicit(&shard->unsolved, memory_order_relaxed);
+        snapshot->gaveup += atomic_load_explicit(&shard->gaveup, memory_order_relaxed);
+        snapshot->total += atomic_load_explicit(&shard->total, memory_order_relaxed);
+
+        longest = atomic_load_explicit(&shard->longest, memory_order_relaxed);
+        snapshot->longest = MAX(snapshot->longest, longest);
+    }
+
+    if (metrics->transpositions) {
+        snapshot->cachehits = atomic_load_explicit(&((TranspositionTable*)metrics->transpositions)->hits, memory_order_relaxed);
+    }
+
+    snapshot->uptime = MetricsNanoseconds() - metrics->started;
+}
+
+//! Function to find a percentile of the latencies in a snapshot
+/*!
+ *  @param      MetricsSnapshot * A pointer to the snapshot
+ *  @param      double          The percentile from 0 - 100
+ *
+ *  @returns    unsigned long long The latency that percent of solves took no longer than in nanoseconds, 0 with no solves
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The highest latency of the bucket is returned so it is never under the real value
+ *        by more than 1 part in 2^METRICSUBBITS
+ */
+unsigned long long MetricsPercentile(const MetricsSnapshot *snapshot, double percentile)
+{
+    unsigned long long target = 0, seen = 0, count = 0;
+    unsigned int b = 0;
+
+    // sanity
+    if (!snapshot) {
+        return 0;
+    }
+
+    // the buckets are the only totals guaranteed to agree with each other mid recording
+    for (b = 0; b < METRICBUCKETS; ++b) {
+        count += snapshot->buckets[b];
+    }
+
+    if (!count) {
+        return 0;
+    }
+
+    // the number of solves that must be at or below the answer, at least one
+    target = (unsigned long long)((MAX(MIN(percentile, 100.0), 0.0) / 100.0) * (double)count + 0.5);
+    target = MAX(target, 1);
+
+    for (b = 0; b < METRICBUCKETS; ++b) {
+        seen += snapshot->buckets[b];
+
+        // the longest latency is exact, so nothing needs to be reported above it
+        if (seen >= target) {
+            if (snapshot->longest
+                && snapshot->longest < MetricBucketHighest(b)) {
+                return snapshot->longest;
+            }
+
+            return MetricBucketHighest(b);
+        }
+    }
+
+    return snapshot->longest;
+}
+
+//! Function to write a snapshot as a single line of JSON
+/*!
+ *  @param      MetricsSnapshot * A pointer to the snapshot
+ *  @param      char *          The buffer to write to
+ *  @param      size_t          The size of the buffer, METRICSJSONSIZE is always enough
+ *
+ *  @returns    size_t          The length of the JSON, 0 if it didn't fit
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every latency is in nanoseconds
+ */
+size_t FormatMetricsJson(const MetricsSnapshot *snapshot, char *buffer, size_t size)
+{
+    int length = 0;
+
+    // sanity
+    if (!snapshot
+        || !buffer
+        || !size) {
+        return 0;
+    }
+
+    length = snprintf(buffer, size,
+        "{\"uptime\":%llu,\"puzzles\":%llu,\"solved\":%llu,\"unsolved\":%llu,\"gaveup\":%llu,\"cachehits\":%llu,"
+        "\"latency\":{\"mean\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}}\n",
+        snapshot->uptime,
+        snapshot->count,
+        snapshot->solved,
+        snapshot->unsolved,
+        snapshot->gaveup,
+        snapshot->cachehits,
+        snapshot->count ? snapshot->total / snapshot->count : 0,
+        MetricsPercentile(snapshot, 50.0),
+        MetricsPercentile(snapshot, 90.0),
+        MetricsPercentile(snapshot, 99.0),
+        MetricsPercentile(snapshot, 99.9),
+        snapshot->longest);
+
+    if (length < 0
+        || (size_t)length >= size) {
+        return 0;
+    }
+
+    return (size_t)length;
+}
+
+#ifndef SUDOKU_NO_STDIO
+// raised by the signal handler, a handler has nowhere else to put it
+static atomic_int MetricsRequested;
+
+//! Function run when the snapshot signal arrives
+/*!
+ *  @param      int             The signal
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only a lock free atomic is touched so this is safe inside a signal handler
+ */
+static void RequestMetrics(int signum)
+{
+    (void)signum;
+
+    atomic_store_explicit(&MetricsRequested, 1, memory_order_relaxed);
+}
+
+//! Function to write a snapshot of a set of metrics to a file
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *  @param      char *          The file to replace with the snapshot
+ *
+ *  @returns    boolean         Whether the snapshot was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool WriteMetricsFile(SudokuMetrics *metrics, const char *path)
+{
+    MetricsSnapshot *snapshot = NULL;
+    char buffer[METRICSJSONSIZE];
+    size_t length = 0;
+    FILE *file = NULL;
+    bool written = false;
+
+    // sanity
+    if (!metrics
+        || !path) {
+        return false;
+    }
+
+    // the buckets are too big for the stack of some threads
+    snapshot = AllocateMemory(metrics->allocator, sizeof(MetricsSnapshot));
+
+    if (!snapshot) {
+        return false;
+    }
+
+    SnapshotSudokuMetrics(metrics, snapshot);
+    length = FormatMetricsJson(snapshot, buffer, sizeof(buffer));
+    FreeMemory(metrics->allocator, snapshot, sizeof(MetricsSnapshot));
+
+    if (!length) {
+        return false;
+    }
+
+    // write the whole snapshot in one go so readers see the last one or this one
+    file = fopen(path, "w");
+
+    if (!file) {
+        return false;
+    }
+
+    written = fwrite(buffer, 1, length, file) == length;
+
+    if (fclose(file) != 0) {
+        written = false;
+    }
+
+    return written;
+}
+
+//! Function run by the thread of a reporter
+/*!
+ *  @param      void *          A pointer to the MetricsReporter
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *RunMetricsReporter(void *argument)
+{
+    MetricsReporter *reporter = (MetricsReporter*)argument;
+    struct timespec pause = { 0, METRICSPOLLINTERVAL * 1000000L };
+    unsigned long long next = MetricsNanoseconds() + ((unsigned long long)reporter->interval * 1000000ull);
+
+    while (!atomic_load(&reporter->stop)) {
+        nanosleep(&pause, NULL);
+
+        // write when signalled or when the interval is up
+        if (atomic_exchange(&MetricsRequested, 0)
+            || (reporter->interval && MetricsNanoseconds() >= next)) {
+            WriteMetricsFile(reporter->metrics, reporter->path);
+            next = MetricsNanoseconds() + ((unsigned long long)reporter->interval * 1000000ull);
+        }
+    }
+
+    // one last snapshot with everything in it
+    WriteMetricsFile(reporter->metrics, reporter->path);
+
+    return NULL;
+}
+
+//! Function to start a thread writing a set of metrics out
+/*!
+ *  @param      MetricsReporter * A pointer to the reporter to start
+ *  @param      SudokuMetrics * A pointer to the metrics to write
+ *  @param      char *          The file every snapshot replaces
+ *  @param      unsigned int    How often to write a snapshot in milliseconds, 0 to only write when signalled
+ *  @param      int             The signal that asks for a snapshot straight away, 0 for none
+ *
+ *  @returns    boolean         Whether the reporter was started
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The signal handler only raises a flag the reporter picks up within METRICSPOLLINTERVAL,
+ *        the snapshot itself is never taken inside the handler
+ */
+bool StartMetricsReporter(MetricsReporter *reporter, SudokuMetrics *metrics, const char *path, unsigned int interval, int signum)
+{
+    struct sigaction action;
+
+    // sanity
+    if (!reporter
+        || !metrics
+        || !path) {
+        return false;
+    }
+
+    memset(reporter, 0, sizeof(MetricsReporter));
+    reporter->metrics = metrics;
+    reporter->path = path;
+    reporter->interval = interval;
+    atomic_init(&reporter->stop, false);
+
+    // ask for a snapshot whenever the signal arrives, restarting anything it interrupts
+    if (signum) {
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = RequestMetrics;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+
+        if (sigaction(signum, &action, NULL) != 0) {
+            return false;
+        }
+    }
+
+    return pthread_create(&reporter->thread, NULL, RunMetricsReporter, reporter) == 0;
+}
+
+//! Function to stop a reporter once it has written a last snapshot
+/*!
+ *  @param      MetricsReporter * A pointer to the reporter to stop
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void StopMetricsReporter(MetricsReporter *reporter)
+{
+    // sanity
+    if (!reporter
+        || !reporter->metrics) {
+        return;
+    }
+
+    atomic_store(&reporter->stop, true);
+    pthread_join(reporter->thread, NULL);
+    reporter->metrics = NULL;
+}
+#endif
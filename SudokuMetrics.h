@@ -0,0 +1,248 @@
+#ifndef SUDOKU_METRICS_H
+#define SUDOKU_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "SudokuAllocator.h"
+#include "SudokuTransposition.h"
+
+// latencies are kept to 1 part in 2^METRICSUBBITS, every power of two is split into this many buckets
+#define METRICSUBBITS     5
+#define METRICSUBBUCKETS  (1u << METRICSUBBITS)
+
+// enough buckets for any 64 bit latency in nanoseconds
+#define METRICBUCKETS     ((64 - METRICSUBBITS + 1) * METRICSUBBUCKETS)
+
+// the most threads that get a shard to themselves, any more share them
+#define MAXMETRICSHARDS   32
+
+// how a solve ended
+#define METRIC_SOLVED     0
+#define METRIC_UNSOLVED   1
+#define METRIC_GAVEUP     2
+
+// the most bytes FormatMetricsJson writes
+#define METRICSJSONSIZE   1024
+
+// A structure defining the latencies and outcomes recorded by one thread
+typedef struct {
+    // the number of solves that took the latencies of each bucket
+    atomic_ullong buckets[METRICBUCKETS];
+
+    // the number of solves recorded
+    atomic_ullong count;
+
+    // the number of solves with a solution
+    atomic_ullong solved;
+
+    // the number of solves proven to have no solution
+    atomic_ullong unsolved;
+
+    // the number of solves given up on when the guess limit ran out
+    atomic_ullong gaveup;
+
+    // the sum of every latency in nanoseconds
+    atomic_ullong total;
+
+    // the longest latency in nanoseconds
+    atomic_ullong longest;
+
+    // keeps the next shard off our cache lines
+    char padding[64];
+} MetricsShard;
+
+// A structure defining the metrics shared by every thread solving puzzles
+typedef struct {
+    // a shard for every thread recording, claimed the first time a thread records
+    MetricsShard *shards;
+
+    // the number of shards claimed, it keeps counting past MAXMETRICSHARDS
+    atomic_uint shardcount;
+
+    // tells these metrics apart from any that were at the same address before
+    unsigned long long generation;
+
+    // the table whose hits are reported as cache hits, or NULL
+    const TranspositionTable *transpositions;
+
+    // when the metrics were initialized in nanoseconds
+    unsigned long long started;
+
+    // where the metrics get their memory from
+    const SudokuAllocator *allocator;
+} SudokuMetrics;
+
+// A structure defining every shard of a set of metrics merged together
+typedef struct {
+    // the number of solves that took the latencies of each bucket
+    unsigned long long buckets[METRICBUCKETS];
+
+    // the number of solves recorded
+    unsigned long long count;
+
+    // the number of solves with a solution
+    unsigned long long solved;
+
+    // the number of solves proven to have no solution
+    unsigned long long unsolved;
+
+    // the number of solves given up on when the guess limit ran out
+    unsigned long long gaveup;
+
+    // the number of boards the transposition table already knew were dead
+    unsigned long long cachehits;
+
+    // the sum of every latency in nanoseconds
+    unsigned long long total;
+
+    // the longest latency in nanoseconds
+    unsigned long long longest;
+
+    // the time since the metrics were initialized in nanoseconds
+    unsigned long long uptime;
+} MetricsSnapshot;
+
+//! Function to read a monotonic clock
+/*!
+ *  @returns    unsigned long long The time in nanoseconds
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned long long MetricsNanoseconds(void);
+
+//! Function to initialize an empty set of metrics
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics to initialize
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the metrics were initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudokuMetrics(SudokuMetrics *metrics, const SudokuAllocator *allocator);
+
+//! Function to cleanup a set of metrics
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: No thread may be recording into the metrics
+ */
+void DestroySudokuMetrics(SudokuMetrics *metrics);
+
+//! Function to record how long a solve took and how it ended
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *  @param      unsigned long long The latency in nanoseconds
+ *  @param      unsigned int    METRIC_SOLVED, METRIC_UNSOLVED or METRIC_GAVEUP
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Each thread records into its own shard so threads never share a cache line,
+ *        nothing is locked and a snapshot can be taken at any time
+ */
+void RecordSolveMetrics(SudokuMetrics *metrics, unsigned long long nanoseconds, unsigned int outcome);
+
+//! Function to merge every shard of a set of metrics
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *  @param      MetricsSnapshot * Receives the totals
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Threads keep recording while the shards are read, so a solve may be counted in
+ *        some totals of a snapshot and not yet in others
+ */
+void SnapshotSudokuMetrics(SudokuMetrics *metrics, MetricsSnapshot *snapshot);
+
+//! Function to find a percentile of the latencies in a snapshot
+/*!
+ *  @param      MetricsSnapshot * A pointer to the snapshot
+ *  @param      double          The percentile from 0 - 100
+ *
+ *  @returns    unsigned long long The latency that percent of solves took no longer than in nanoseconds, 0 with no solves
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The highest latency of the bucket is returned so it is never under the real value
+ *        by more than 1 part in 2^METRICSUBBITS
+ */
+unsigned long long MetricsPercentile(const MetricsSnapshot *snapshot, double percentile);
+
+//! Function to write a snapshot as a single line of JSON
+/*!
+ *  @param      MetricsSnapshot * A pointer to the snapshot
+ *  @param      char *          The buffer to write to
+ *  @param      size_t          The size of the buffer, METRICSJSONSIZE is always enough
+ *
+ *  @returns    size_t          The length of the JSON, 0 if it didn't fit
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+size_t FormatMetricsJson(const MetricsSnapshot *snapshot, char *buffer, size_t size);
+
+#ifndef SUDOKU_NO_STDIO
+#include <pthread.h>
+
+// how often the reporter checks whether a snapshot was asked for, in milliseconds
+#define METRICSPOLLINTERVAL 50
+
+// A structure defining a thread that writes a set of metrics out
+typedef struct {
+    // the metrics to write
+    SudokuMetrics *metrics;
+
+    // the file every snapshot replaces
+    const char *path;
+
+    // how often a snapshot is written in milliseconds, 0 to only write when signalled and when stopped
+    unsigned int interval;
+
+    // tells the thread to write its last snapshot and finish
+    atomic_bool stop;
+
+    // the thread
+    pthread_t thread;
+} MetricsReporter;
+
+//! Function to write a snapshot of a set of metrics to a file
+/*!
+ *  @param      SudokuMetrics * A pointer to the metrics
+ *  @param      char *          The file to replace with the snapshot
+ *
+ *  @returns    boolean         Whether the snapshot was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool WriteMetricsFile(SudokuMetrics *metrics, const char *path);
+
+//! Function to start a thread writing a set of metrics out
+/*!
+ *  @param      MetricsReporter * A pointer to the reporter to start
+ *  @param      SudokuMetrics * A pointer to the metrics to write
+ *  @param      char *          The file every snapshot replaces
+ *  @param      unsigned int    How often to write a snapshot in milliseconds, 0 to only write when signalled
+ *  @param      int             The signal that asks for a snapshot straight away, 0 for none
+ *
+ *  @returns    boolean         Whether the reporter was started
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The signal handler only raises a flag the reporter picks up within METRICSPOLLINTERVAL,
+ *        the snapshot itself is never taken inside the handler
+ */
+bool StartMetricsReporter(MetricsReporter *reporter, SudokuMetrics *metrics, const char *path, unsigned int interval, int signum);
+
+//! Function to stop a reporter once it has written a last snapshot
+/*!
+ *  @param      MetricsReporter * A pointer to the reporter to stop
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void StopMetricsReporter(MetricsReporter *reporter);
+#endif
+
+#endif
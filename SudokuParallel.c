@@ -0,0 +1,726 @@
+#include <sched.h>
+
+#include "SudokuParallel.h"
+
+//! Function to initialize a pool of boards
+/*!
+ *  @param      SudokuPool *    A pointer to the pool to initialize
+ *  @param      Sudoku*         Storage for the boards, or NULL for the pool to allocate them
+ *  @param      unsigned int    The number of boards in the pool
+ *  @param      unsigned int    The probabilty threshold required for a guess to be made
+ *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the pool was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: All the allocation happens here, checking boards out and returning them never allocates
+ */
+bool InitializeSudokuPool(SudokuPool *pool, Sudoku *storage, unsigned int count, unsigned int guessthreshold, unsigned int maxguesses, const SudokuAllocator *allocator)
+{
+    unsigned int i = 0;
+
+    // sanity
+    if (!pool
+        || !count) {
+        return false;
+    }
+
+    memset(pool, 0, sizeof(SudokuPool));
+
+    // use the caller's boards if we were given any
+    pool->allocator = allocator;
+    pool->count = count;
+    pool->ownsboards = !storage;
+    pool->boards = storage ? storage : (Sudoku*)AllocateMemory(allocator, count * sizeof(Sudoku));
+    pool->available = (Sudoku**)AllocateMemory(allocator, count * sizeof(Sudoku*));
+
+    // sanity check them
+    if (!pool->boards
+        || !pool->available) {
+        if (pool->ownsboards) {
+            FreeMemory(allocator, pool->boards, count * sizeof(Sudoku));
+        }
+
+        FreeMemory(allocator, pool->available, count * sizeof(Sudoku*));
+        memset(pool, 0, sizeof(SudokuPool));
+        return false;
+    }
+
+    // every board starts out available and quiet
+    for (i = 0; i < count; ++i) {
+        InitializeSudokuStorage(&pool->boards[i], guessthreshold, maxguesses);
+        pool->boards[i].verbose = false;
+        pool->available[i] = &pool->boards[i];
+    }
+
+    pool->availablecount = count;
+    pthread_mutex_init(&pool->lock, NULL);
+
+    return true;
+}
+
+//! Function to cleanup a pool of boards
+/*!
+ *  @param      SudokuPool *    A pointer to the pool to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Storage given by the caller is left for the caller to free
+ */
+void DestroySudokuPool(SudokuPool *pool)
+{
+    // sanity
+    if (!pool) {
+        return;
+    }
+
+    // nothing to do for a pool that was never set up
+    if (!pool->count) {
+        return;
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+
+    if (pool->ownsboards) {
+        FreeMemory(pool->allocator, pool->boards, pool->count * sizeof(Sudoku));
+    }
+
+    FreeMemory(pool->allocator, pool->available, pool->count * sizeof(Sudoku*));
+    memset(pool, 0, sizeof(SudokuPool));
+}
+
+//! Function to check a cleared board out of a pool
+/*!
+ *  @param      SudokuPool *    A pointer to the pool
+ *
+ *  @returns    Sudoku*         The board, or NULL if every board is checked out
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+Sudoku *CheckOutSudoku(SudokuPool *pool)
+{
+    Sudoku *sudoku = NULL;
+
+    // sanity
+    if (!pool
+        || !pool->count) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->availablecount) {
+        sudoku = pool->available[--pool->availablecount];
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    // hand it out clear
+    if (sudoku) {
+        ResetSudoku(sudoku);
+    }
+
+    return sudoku;
+}
+
+//! Function to return a board to the pool it was checked out of
+/*!
+ *  @param      SudokuPool *    A pointer to the pool
+ *  @param      Sudoku*         The board to return
+ *
+ *  @returns    boolean         Whether the board was returned
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ReturnSudoku(SudokuPool *pool, Sudoku *sudoku)
+{
+    bool returned = false;
+
+    // sanity, the board has to be one of ours
+    if (!pool
+        || !sudoku
+        || sudoku < pool->boards
+        || sudoku >= pool->boards + pool->count) {
+        return false;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->availablecount < pool->count) {
+        pool->available[pool->availablecount++] = sudoku;
+        returned = true;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return returned;
+}
+
+//! Function to push a task onto the newest end of a worker's queue
+/*!
+ *  @param      SearchPool *    The pool the queue belongs to
+ *  @param      unsigned int    The index of the worker's queue
+ *  @param      Sudoku*         The board to search, ownership passes to the queue
+ *  @param      unsigned int    The number of guesses made to reach the board
+ *
+ *  @returns    boolean         Whether the task was queued
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool PushTask(SearchPool *pool, unsigned int index, Sudoku *sudoku, unsigned int depth)
+{
+    SearchDeque *deque = &pool->deques[index];
+    SearchTask *tasks = NULL;
+    unsigned int capacity = 0;
+    bool pushed = false;
+
+    pthread_mutex_lock(&deque->lock);
+
+    // slide everything back to the start once thieves have emptied the front
+    if (deque->head == deque->tail) {
+        deque->head = 0;
+        deque->tail = 0;
+    }
+
+    // grow the queue when full
+    if (deque->tail == deque->capacity) {
+        capacity = deque->capacity ? deque->capacity * 2 : 16;
+        tasks = (SearchTask*)ReallocateMemory(pool->allocator, deque->tasks, deque->capacity * sizeof(SearchTask), capacity * sizeof(SearchTask));
+
+        // sanity the realloc
+        if (tasks) {
+            deque->tasks = tasks;
+            deque->capacity = capacity;
+        }
+    }
+
+    // insert the task if there is room
+    if (deque->tail < deque->capacity) {
+        // count the task before anyone can see it
+        atomic_fetch_add(&pool->pending, 1);
+
+        deque->tasks[deque->tail].sudoku = sudoku;
+        deque->tasks[deque->tail].depth = depth;
+        deque->tail++;
+        pushed = true;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return pushed;
+}
+
+//! Function to pop the newest task from a worker's own queue
+/*!
+ *  @param      SearchDeque *   The worker's queue
+ *  @param      SearchTask *    Receives the task
+ *
+ *  @returns    boolean         Whether a task was popped
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool PopTask(SearchDeque *deque, SearchTask *task)
+{
+    bool popped = false;
+
+    pthread_mutex_lock(&deque->lock);
+
+    // the owner works depth first from the newest end
+    if (deque->tail > deque->head) {
+        deque->tail--;
+        *task = deque->tasks[deque->tail];
+        popped = true;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return popped;
+}
+
+//! Function to steal the oldest task from another worker's queue
+/*!
+ *  @param      SearchPool *    The pool to steal from
+ *  @param      unsigned int    The index of the worker doing the stealing
+ *  @param      SearchTask *    Receives the task
+ *
+ *  @returns    boolean         Whether a task was stolen
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The oldest task is closest to the top of the tree so it is the biggest one to take
+ */
+static bool StealTask(SearchPool *pool, unsigned int index, SearchTask *task)
+{
+    unsigned int i = 0, victim = 0;
+    bool stolen = false;
+    SearchDeque *deque = NULL;
+
+    // try every other worker once starting with our neighbour
+    for (i = 1; i < pool->threadcount && !stolen; ++i) {
+        victim = (index + i) % pool->threadcount;
+        deque = &pool->deques[victim];
+
+        pthread_mutex_lock(&deque->lock);
+
+        if (deque->tail > deque->head) {
+            *task = deque->tasks[deque->head];
+            deque->head++;
+            stolen = true;
+        }
+
+        pthread_mutex_unlock(&deque->lock);
+    }
+
+    return stolen;
+}
+
+//! Function to record a solution found by a worker
+/*!
+ *  @param      SearchPool *    The pool the solution was found in
+ *  @param      Sudoku*         The solved board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void RecordSolution(SearchPool *pool, Sudoku *sudoku)
+{
+    unsigned int count = atomic_fetch_add(&pool->solutions, 1) + 1;
+
+    // keep the first solution
+    if (count == 1) {
+        pthread_mutex_lock(&pool->solutionlock);
+        CopySudoku(pool->solution, sudoku);
+        pthread_mutex_unlock(&pool->solutionlock);
+    }
+
+    // tell everyone to stop once we've found enough
+    if (pool->limit
+        && count >= pool->limit) {
+        atomic_store(&pool->stop, true);
+    }
+}
+
+//! Function to add the guesses a worker has made to its pool's count
+/*!
+ *  @param      SearchWorker *  The worker
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void FlushSearchGuesses(SearchWorker *worker)
+{
+    if (worker->guesses) {
+        atomic_fetch_add(&worker->pool->guesses, worker->guesses);
+        worker->guesses = 0;
+    }
+}
+
+//! Function to tell whether a search pool should stop, stopping every worker when the sudoku has been cancelled
+/*!
+ *  @param      SearchPool *    The pool the search is running in
+ *
+ *  @returns    boolean         Whether the search should be abandoned
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The guess limit counts the guesses the workers have added so far, so it can be
+ *        overshot by up to SEARCHGUESSBATCH guesses for each worker
+ */
+static bool SearchStopped(SearchPool *pool)
+{
+    Sudoku *sudoku = pool->sudoku;
+
+    if (atomic_load(&pool->stop)) {
+        return true;
+    }
+
+    // the sudoku's guess counter isn't added to until the workers finish, so count theirs too
+    if (SEARCH_CANCELLED(sudoku)
+        || (sudoku->guesslimit
+            && sudoku->guesscounter
+            && *sudoku->guesscounter + atomic_load(&pool->guesses) >= sudoku->guesslimit)) {
+        atomic_store(&pool->stop, true);
+        return true;
+    }
+
+    return false;
+}
+
+//! Function which searches a board depth first, handing branches to idle workers
+/*!
+ *  @param      SearchWorker *  The worker searching
+ *  @param      Sudoku*         The board to search
+ *  @param      unsigned int    The number of guesses made to reach the board
+ *
+ *  @returns    boolean         Returns true if the board was proven to have no solution
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool SearchBranch(SearchWorker *worker, Sudoku *sudoku, unsigned int depth)
+{
+    unsigned int x = 0, y = 0, g = 0;
+    bool dead = true;
+    GuessRanking ranking;
+    Sudoku branch;
+    Sudoku *task = NULL;
+    SearchPool *pool = worker->pool;
+
+    // abandon the search once we're told to
+    if (SearchStopped(pool)) {
+        return false;
+    }
+
+    // place everything that is forced, a dead board has nothing to search
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            RecordSolution(pool, sudoku);
+            return false;
+        case PROPAGATE_CONTRADICTION:
+            return true;
+    }
+
+    // don't guess any deeper than we're allowed, or at all on a dead end
+    if (depth >= sudoku->maxguesscount) {
+        return false;
+    }
+
+    if (!FindMostConstrainedCell(sudoku, &x, &y)) {
+        return true;
+    }
+
+    // another order of guesses may already have shown this board is a dead end
+    if (sudoku->transpositions
+        && IsKnownDead(sudoku->transpositions, HashSudoku(sudoku))) {
+        return true;
+    }
+
+    // grab our guesses and a board on the stack for the branches we search ourself
+    if (!RankCellGuesses(sudoku, x, y, &ranking)
+        || !InitializeSudokuStorage(&branch, sudoku->threshold, sudoku->maxguesscount)) {
+        return false;
+    }
+
+    // branches work quietly
+    branch.verbose = false;
+
+    // try each guess until we're told to stop
+    for (g = 0; g < ranking.count && !SearchStopped(pool); ++g) {
+        // count the guess, handing our count to the pool every so often for the guess limit
+        if (++worker->guesses >= SEARCHGUESSBATCH) {
+            FlushSearchGuesses(worker);
+        }
+
+        // near the top of the tree give all but our last branch to anyone idle on a pooled board
+        if (depth < SPLITDEPTH
+            && g + 1 < ranking.count
+            && atomic_load(&pool->idle) > 0
+            && (task = CheckOutSudoku(&pool->boards))) {
+            CopySudoku(task, sudoku);
+            PlaceNumber(task,
+                ranking.guesses[g].x,
+                ranking.guesses[g].y,
+                ranking.guesses[g].value);
+
+            // we won't know how a branch we give away turns out
+            if (PushTask(pool, worker->index, task, depth + 1)) {
+                dead = false;
+                continue;
+            }
+
+            ReturnSudoku(&pool->boards, task);
+        }
+
+        // otherwise search it ourself
+        CopySudoku(&branch, sudoku);
+        PlaceNumber(&branch,
+            ranking.guesses[g].x,
+            ranking.guesses[g].y,
+            ranking.guesses[g].value);
+
+        if (!SearchBranch(worker, &branch, depth + 1)) {
+            dead = false;
+        }
+    }
+
+    // a search that was stopped or cancelled didn't try everything, so it proves nothing
+    if (SearchStopped(pool)) {
+        return false;
+    }
+
+    // remember a dead end unless the guess limit could have cut a branch short
+    if (dead
+        && sudoku->transpositions
+        && depth + CountEmptyCells(sudoku) <= sudoku->maxguesscount) {
+        RecordDead(sudoku->transpositions, HashSudoku(sudoku));
+    }
+
+    return dead;
+}
+
+
+
+//! Function run by each thread of a search pool
+/*!
+ *  @param      void *          A pointer to the SearchWorker for this thread
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *RunSearchWorker(void *argument)
+{
+    SearchWorker *worker = (SearchWorker*)argument;
+    SearchPool *pool = worker->pool;
+    SearchTask task;
+    bool idle = false;
+
+    // keep working until we're told to stop
+    while (!atomic_load(&pool->stop)) {
+        // our own work first, then someone else's
+        if (PopTask(&pool->deques[worker->index], &task)
+            || StealTask(pool, worker->index, &task)) {
+            // we're busy again
+            if (idle) {
+                atomic_fetch_sub(&pool->idle, 1);
+                idle = false;
+            }
+
+            SearchBranch(worker, task.sudoku, task.depth);
+            ReturnSudoku(&pool->boards, task.sudoku);
+
+            // this task is finished
+            atomic_fetch_sub(&pool->pending, 1);
+        } else {
+            // let the busy workers know we want something to do
+            if (!idle) {
+                atomic_fetch_add(&pool->idle, 1);
+                idle = true;
+            }
+
+            // when nothing is queued or running the search is over
+            if (atomic_load(&pool->pending) == 0) {
+                break;
+            }
+
+            sched_yield();
+        }
+    }
+
+    // leave the idle count how we found it
+    if (idle) {
+        atomic_fetch_sub(&pool->idle, 1);
+    }
+
+    FlushSearchGuesses(worker);
+
+    // give back the blocks our branches pooled
+    ReleasePoolMemory();
+
+    return NULL;
+}
+
+//! Function which searches a sudoku for solutions using a pool of threads
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the first solution
+ *  @param      unsigned int    The number of threads to search with
+ *  @param      unsigned int    The number of solutions to stop at, 0 to find them all
+ *
+ *  @returns    unsigned int    The number of solutions found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The top of the search tree is split at the most constrained cells into tasks
+ *        that idle workers steal from each other. Tasks are handed out on boards from a
+ *        pool set up before the search starts, when it runs dry workers keep their branches.
+ *        Every worker stops when the sudoku is cancelled or its guess limit is reached, and
+ *        their guesses are added to the sudoku's guess counter once they have all finished.
+ */
+unsigned int SearchSudokuParallel(Sudoku *sudoku, unsigned int threads, unsigned int limit)
+{
+    unsigned int i = 0, started = 0, solutions = 0;
+    SearchPool *pool = NULL;
+    SearchWorker *workers = NULL;
+    Sudoku *root = NULL;
+
+    // sanity
+    if (!sudoku) {
+        return 0;
+    }
+
+    // keep our thread count sensible
+    threads = MAX(MIN(threads, MAXSEARCHTHREADS), 1);
+
+    // allocate our pool and workers
+    pool = (SearchPool*)AllocateMemory(sudoku->allocator, sizeof(SearchPool));
+    workers = (SearchWorker*)AllocateMemory(sudoku->allocator, threads * sizeof(SearchWorker));
+
+    // sanity check them
+    if (!pool
+        || !workers) {
+        FreeMemory(sudoku->allocator, pool, sizeof(SearchPool));
+        FreeMemory(sudoku->allocator, workers, threads * sizeof(SearchWorker));
+        return 0;
+    }
+
+    // initialize our pool
+    pool->threadcount = threads;
+    pool->allocator = sudoku->allocator;
+    pool->limit = limit;
+    pool->sudoku = sudoku;
+    atomic_init(&pool->stop, false);
+    atomic_init(&pool->guesses, 0);
+    atomic_init(&pool->solutions, 0);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->idle, 0);
+    pthread_mutex_init(&pool->solutionlock, NULL);
+
+    for (i = 0; i < threads; ++i) {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+
+    // the whole board starts as a single task on the first worker
+    if (InitializeSudokuWithAllocator(&pool->solution, sudoku->threshold, sudoku->maxguesscount, pool->allocator)
+        && InitializeSudokuPool(&pool->boards, NULL, (threads * POOLEDBOARDSPERTHREAD) + 1, sudoku->threshold, sudoku->maxguesscount, pool->allocator)
+        && (root = CheckOutSudoku(&pool->boards))) {
+        CopySudoku(root, sudoku);
+
+        if (PushTask(pool, 0, root, 0)) {
+            root = NULL;
+
+            // start our workers
+            for (started = 0; started < threads; ++started) {
+                workers[started].pool = pool;
+                workers[started].index = started;
+                workers[started].guesses = 0;
+
+                if (pthread_create(&workers[started].thread, NULL, RunSearchWorker, &workers[started]) != 0) {
+                    break;
+                }
+            }
+
+            // with no workers at all there is nobody to search
+            if (started == 0) {
+                RunSearchWorker(&workers[0]);
+            }
+
+            // wait for them to finish
+            for (i = 0; i < started; ++i) {
+                pthread_join(workers[i].thread, NULL);
+            }
+        }
+    }
+
+    // cleanup anything left behind after we stopped early
+    for (i = 0; i < threads; ++i) {
+        while (pool->deques[i].tail > pool->deques[i].head) {
+            pool->deques[i].tail--;
+            ReturnSudoku(&pool->boards, pool->deques[i].tasks[pool->deques[i].tail].sudoku);
+        }
+
+        FreeMemory(pool->allocator, pool->deques[i].tasks, pool->deques[i].capacity * sizeof(SearchTask));
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+
+    // every worker has finished, so the sudoku's guess counter is ours to add to
+    if (sudoku->guesscounter) {
+        *sudoku->guesscounter += atomic_load(&pool->guesses);
+    }
+
+    // hand back the solution
+    solutions = atomic_load(&pool->solutions);
+
+    if (solutions) {
+        CopySudoku(sudoku, pool->solution);
+    }
+
+    // racing workers can overshoot our limit
+    if (limit) {
+        solutions = MIN(solutions, limit);
+    }
+
+    // cleanup
+    if (root) {
+        ReturnSudoku(&pool->boards, root);
+    }
+
+    DestroySudokuPool(&pool->boards);
+
+    if (pool->solution) {
+        DestroySudoku(pool->solution);
+    }
+
+    pthread_mutex_destroy(&pool->solutionlock);
+    FreeMemory(pool->allocator, workers, threads * sizeof(SearchWorker));
+    FreeMemory(pool->allocator, pool, sizeof(SearchPool));
+
+    return solutions;
+}
+
+//! Function which attempts to solve the sudoku using a pool of threads
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *
+ *  @returns    boolean         Returns true if the sudoku was successfully solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This uses the sudoku's thread count and behaves like SolveSudoku otherwise
+ */
+bool SolveSudokuParallel(Sudoku *sudoku)
+{
+    unsigned long long started = 0;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    // only read the clock if someone wants the latency
+    if (sudoku->metrics) {
+        started = MetricsNanoseconds();
+    }
+
+    // place everything we can, then guess if we're allowed to and the board isn't dead
+    if (PropagateSudoku(sudoku) == PROPAGATE_INCOMPLETE
+        && sudoku->maxguesscount) {
+        SearchSudokuParallel(sudoku, sudoku->threads, 1);
+    }
+
+    if (sudoku->metrics) {
+        RecordSolveMetrics(sudoku->metrics, MetricsNanoseconds() - started, SolveOutcome(sudoku));
+    }
+
+    // print our sudoku after all attempts to solve have been made
+    PrintSudoku(sudoku);
+
+    // return whether we completed or not
+    return IsSudokuComplete(sudoku);
+}
+
+//! Function which counts the solutions of a sudoku using a pool of threads
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to count the solutions of
+ *  @param      unsigned int    The number of solutions to stop counting at, 0 to count them all
+ *
+ *  @returns    unsigned int    The number of solutions found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The sudoku is left unchanged
+ */
+unsigned int CountSolutionsParallel(Sudoku *sudoku, unsigned int limit)
+{
+    Sudoku board;
+
+    // sanity
+    if (!sudoku) {
+        return 0;
+    }
+
+    // search a copy so the caller's board is untouched
+    InitializeSudokuStorage(&board, sudoku->threshold, sudoku->maxguesscount);
+    board.verbose = false;
+    CopySudoku(&board, sudoku);
+
+    return SearchSudokuParallel(&board, sudoku->threads, limit);
+}
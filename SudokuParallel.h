@@ -0,0 +1,220 @@
+#ifndef SUDOKU_PARALLEL_H
+#define SUDOKU_PARALLEL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "SudokuSolver.h"
+
+// the most worker threads a search pool will start
+#define MAXSEARCHTHREADS 64
+
+// boards at this many guesses or deeper are always searched by the worker that made them
+#define SPLITDEPTH 8
+
+// the boards a search pool keeps for each worker to hand branches out on
+#define POOLEDBOARDSPERTHREAD 32
+
+// the guesses a worker makes before adding them to its search pool's count
+#define SEARCHGUESSBATCH 64
+
+// A structure defining a pool of boards that threads check out and return
+typedef struct {
+    // protects the boards that aren't checked out
+    pthread_mutex_t lock;
+
+    // every board in the pool
+    Sudoku *boards;
+
+    // the boards that aren't checked out
+    Sudoku **available;
+
+    // the number of boards in the pool
+    unsigned int count;
+
+    // the number of boards that aren't checked out
+    unsigned int availablecount;
+
+    // whether the pool allocated the boards itself
+    bool ownsboards;
+
+    // where the pool gets its memory from
+    const SudokuAllocator *allocator;
+} SudokuPool;
+
+// A structure defining a subproblem waiting to be searched
+typedef struct {
+    // the board to search, checked out of the search pool's boards
+    Sudoku *sudoku;
+
+    // the number of guesses already made to reach this board
+    unsigned int depth;
+} SearchTask;
+
+// A structure defining a worker's double ended queue of tasks
+typedef struct {
+    // protects the queue between its owner and thieves
+    pthread_mutex_t lock;
+
+    // the tasks, thieves take from head and the owner works at tail
+    SearchTask *tasks;
+
+    // the index of the oldest task
+    unsigned int head;
+
+    // the index after the newest task
+    unsigned int tail;
+
+    // the number of tasks the queue has room for
+    unsigned int capacity;
+} SearchDeque;
+
+// A structure defining a pool of threads searching a single sudoku
+typedef struct {
+    // the number of worker threads
+    unsigned int threadcount;
+
+    // where the pool gets its memory from, the same as the sudoku being searched
+    const SudokuAllocator *allocator;
+
+    // stop after this many solutions, 0 to find them all
+    unsigned int limit;
+
+    // set once the search should be abandoned by every worker
+    atomic_bool stop;
+
+    // the sudoku being searched, whose cancel and guess limit stop every worker
+    Sudoku *sudoku;
+
+    // the guesses the workers have added so far, given to the sudoku's guess counter once they finish
+    atomic_ullong guesses;
+
+    // the number of solutions found so far
+    atomic_uint solutions;
+
+    // the number of tasks queued or being searched
+    atomic_uint pending;
+
+    // the number of workers looking for something to do
+    atomic_uint idle;
+
+    // protects the solution board
+    pthread_mutex_t solutionlock;
+
+    // receives the first solution found
+    Sudoku *solution;
+
+    // the boards branches are handed out on
+    SudokuPool boards;
+
+    // a queue of tasks for every worker
+    SearchDeque deques[MAXSEARCHTHREADS];
+} SearchPool;
+
+// A structure defining a single thread of a search pool
+typedef struct {
+    // the pool this worker belongs to
+    SearchPool *pool;
+
+    // the index of this worker's queue
+    unsigned int index;
+
+    // the thread running this worker
+    pthread_t thread;
+
+    // the guesses this worker has made but not yet added to the pool's
+    unsigned long long guesses;
+} SearchWorker;
+
+//! Function to initialize a pool of boards
+/*!
+ *  @param      SudokuPool *    A pointer to the pool to initialize
+ *  @param      Sudoku*         Storage for the boards, or NULL for the pool to allocate them
+ *  @param      unsigned int    The number of boards in the pool
+ *  @param      unsigned int    The probabilty threshold required for a guess to be made
+ *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the pool was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: All the allocation happens here, checking boards out and returning them never allocates
+ */
+bool InitializeSudokuPool(SudokuPool *pool, Sudoku *storage, unsigned int count, unsigned int guessthreshold, unsigned int maxguesses, const SudokuAllocator *allocator);
+
+//! Function to cleanup a pool of boards
+/*!
+ *  @param      SudokuPool *    A pointer to the pool to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Storage given by the caller is left for the caller to free
+ */
+void DestroySudokuPool(SudokuPool *pool);
+
+//! Function to check a cleared board out of a pool
+/*!
+ *  @param      SudokuPool *    A pointer to the pool
+ *
+ *  @returns    Sudoku*         The board, or NULL if every board is checked out
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+Sudoku *CheckOutSudoku(SudokuPool *pool);
+
+//! Function to return a board to the pool it was checked out of
+/*!
+ *  @param      SudokuPool *    A pointer to the pool
+ *  @param      Sudoku*         The board to return
+ *
+ *  @returns    boolean         Whether the board was returned
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ReturnSudoku(SudokuPool *pool, Sudoku *sudoku);
+
+//! Function which searches a sudoku for solutions using a pool of threads
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the first solution
+ *  @param      unsigned int    The number of threads to search with
+ *  @param      unsigned int    The number of solutions to stop at, 0 to find them all
+ *
+ *  @returns    unsigned int    The number of solutions found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The top of the search tree is split at the most constrained cells into tasks
+ *        that idle workers steal from each other. Tasks are handed out on boards from a
+ *        pool set up before the search starts, when it runs dry workers keep their branches.
+ *        Every worker stops when the sudoku is cancelled or its guess limit is reached, and
+ *        their guesses are added to the sudoku's guess counter once they have all finished.
+ */
+unsigned int SearchSudokuParallel(Sudoku *sudoku, unsigned int threads, unsigned int limit);
+
+//! Function which attempts to solve the sudoku using a pool of threads
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *
+ *  @returns    boolean         Returns true if the sudoku was successfully solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This uses the sudoku's thread count and behaves like SolveSudoku otherwise
+ */
+bool SolveSudokuParallel(Sudoku *sudoku);
+
+//! Function which counts the solutions of a sudoku using a pool of threads
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to count the solutions of
+ *  @param      unsigned int    The number of solutions to stop counting at, 0 to count them all
+ *
+ *  @returns    unsigned int    The number of solutions found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The sudoku is left unchanged
+ */
+unsigned int CountSolutionsParallel(Sudoku *sudoku, unsigned int limit);
+
+#endif
@@ -0,0 +1,332 @@
+#include "SudokuParser.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! Function to record the outcome of a parse
+/*!
+ *  @param      ParseResult *   Where to report the outcome
+ *  @param      unsigned int    The column the error was found at, starting from 0
+ *  @param      unsigned int    Why the line failed to parse
+ *
+ *  @returns    boolean         Always false so errors can be returned straight away
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool ParseFailed(ParseResult *result, unsigned int column, unsigned int error)
+{
+    result->column = column + 1;
+    result->error = error;
+
+    return false;
+}
+
+//! Function to add a given to a grid being parsed
+/*!
+ *  @param      unsigned int *  The cells of the grid
+ *  @param      unsigned short[27] The numbers already given in every unit
+ *  @param      unsigned int    The cell to fill
+ *  @param      unsigned int    The number to fill it with
+ *
+ *  @returns    boolean         Returns false if the cell is taken or the number is already in one of its units
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool AddGiven(unsigned int *cells, unsigned short units[27], unsigned int cell, unsigned int value)
+{
+    unsigned short bit = VALUE_BIT(value);
+
+    // the cell is taken or the number clashes with another given
+    if (cells[cell]
+        || ((units[ROW_UNIT(CellRow[cell])]
+            | units[COLUMN_UNIT(CellColumn[cell])]
+            | units[BOX_UNIT(CellBox[cell])]) & bit)) {
+        return false;
+    }
+
+    cells[cell] = value;
+    units[ROW_UNIT(CellRow[cell])] |= bit;
+    units[COLUMN_UNIT(CellColumn[cell])] |= bit;
+    units[BOX_UNIT(CellBox[cell])] |= bit;
+
+    return true;
+}
+
+//! Function to parse a puzzle written as 81 characters
+/*!
+ *  @param      char *          The characters to parse
+ *  @param      unsigned int    The number of characters, not counting any line ending
+ *  @param      unsigned int[9][9] The grid to fill
+ *  @param      ParseResult *   Where to report the outcome
+ *
+ *  @returns    boolean         Whether the line held a puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Digits 1 - 9 are givens and '.', '0' and '_' are blanks. The givens are checked
+ *        for two of the same number in a row, column or box.
+ *        With SSE2 the characters are checked and converted 16 at a time.
+ */
+bool ParseGridLine(const char *line, unsigned int length, unsigned int grid[9][9], ParseResult *result)
+{
+    unsigned int *cells = &grid[0][0];
+    unsigned short units[SUDOKU_UNITS];
+    unsigned int i = 0, value = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i ascii = _mm_set1_epi8('0');
+    const __m128i dot = _mm_set1_epi8('.');
+    const __m128i underscore = _mm_set1_epi8('_');
+    __m128i chunk, digits, numeric, blank, low, high;
+    unsigned int mask = 0;
+#endif
+
+    // sanity
+    if (!line
+        || !grid
+        || !result) {
+        return false;
+    }
+
+    result->column = 0;
+    result->error = PARSE_OK;
+
+    // a short line is missing the character after its end, a long one has one too many
+    if (length != PUZZLELINELENGTH) {
+        return ParseFailed(result, MIN(length, PUZZLELINELENGTH), PARSE_BADLENGTH);
+    }
+
+#ifdef __SSE2__
+    for (i = 0; i + 16 <= PUZZLELINELENGTH; i += 16) {
+        chunk = _mm_loadu_si128((const __m128i*)(line + i));
+
+        // digits are the characters that land on 0 - 9 once '0' is taken off
+        digits = _mm_sub_epi8(chunk, ascii);
+        numeric = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+        blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, dot), _mm_cmpeq_epi8(chunk, underscore));
+
+        // every character has to be one or the other
+        mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(numeric, blank));
+        if (mask != 0xFFFF) {
+            return ParseFailed(result, i + LOWBIT(~mask), PARSE_BADCHARACTER);
+        }
+
+        // blanks become 0, then widen every byte out to a cell
+        digits = _mm_and_si128(digits, numeric);
+        low = _mm_unpacklo_epi8(digits, zero);
+        high = _mm_unpackhi_epi8(digits, zero);
+        _mm_storeu_si128((__m128i*)(cells + i), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128((__m128i*)(cells + i + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128((__m128i*)(cells + i + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128((__m128i*)(cells + i + 12), _mm_unpackhi_epi16(high, zero));
+    }
+#endif
+
+    // whatever is left one character at a time
+    for (; i < PUZZLELINELENGTH; ++i) {
+        if (line[i] >= '0' && line[i] <= '9') {
+            cells[i] = line[i] - '0';
+        } else if (line[i] == '.'
+            || line[i] == '_') {
+            cells[i] = 0;
+        } else {
+            return ParseFailed(result, i, PARSE_BADCHARACTER);
+        }
+    }
+
+    memset(units, 0, sizeof(units));
+
+    // check the givens against each other
+    for (i = 0; i < SUDOKU_CELLS; ++i) {
+        if (!cells[i]) {
+            continue;
+        }
+
+        // take the given out so it can be added back with the checks
+        value = cells[i];
+        cells[i] = 0;
+
+        if (!AddGiven(cells, units, i, value)) {
+            return ParseFailed(result, i, PARSE_CONFLICT);
+        }
+    }
+
+    return true;
+}
+
+//! Function to parse a puzzle written as a list of xyv numbers separated by spaces
+/*!
+ *  @param      char *          The characters to parse
+ *  @param      unsigned int    The number of characters, not counting any line ending
+ *  @param      unsigned int[9][9] The grid to fill
+ *  @param      ParseResult *   Where to report the outcome
+ *
+ *  @returns    boolean         Whether the line held a puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: x, y and v all run from 1 to 9, the same as the console input. A cell given twice
+ *        or a number that clashes with an earlier given is a conflict.
+ *        With SSE2 runs of 4 numbers are checked 16 characters at a time, anything that
+ *        doesn't match is left for the character by character loop to report.
+ */
+bool ParseXYVLine(const char *line, unsigned int length, unsigned int grid[9][9], ParseResult *result)
+{
+    unsigned int *cells = &grid[0][0];
+    unsigned short units[SUDOKU_UNITS];
+    unsigned int i = 0, k = 0;
+#ifdef __SSE2__
+    const __m128i eight = _mm_set1_epi8(8);
+    const __m128i ascii = _mm_set1_epi8('1');
+    const __m128i space = _mm_set1_epi8(' ');
+    __m128i chunk, digits, numeric, spaces;
+#endif
+
+    // sanity
+    if (!line
+        || !grid
+        || !result) {
+        return false;
+    }
+
+    result->column = 0;
+    result->error = PARSE_OK;
+
+    memset(grid, 0, sizeof(unsigned int) * SUDOKU_CELLS);
+    memset(units, 0, sizeof(units));
+
+#ifdef __SSE2__
+    while (i + 16 <= length) {
+        chunk = _mm_loadu_si128((const __m128i*)(line + i));
+
+        // "xyv xyv xyv xyv " is digits 1 - 9 everywhere but every fourth character
+        digits = _mm_sub_epi8(chunk, ascii);
+        numeric = _mm_cmpeq_epi8(_mm_min_epu8(digits, eight), digits);
+        spaces = _mm_cmpeq_epi8(chunk, space);
+
+        if (_mm_movemask_epi8(numeric) != 0x7777
+            || _mm_movemask_epi8(spaces) != 0x8888) {
+            break;
+        }
+
+        for (k = i; k < i + 16; k += 4) {
+            if (!AddGiven(cells, units, CELL(line[k] - '1', line[k + 1] - '1'), line[k + 2] - '0')) {
+                return ParseFailed(result, k, PARSE_CONFLICT);
+            }
+        }
+
+        i += 16;
+    }
+#endif
+
+    // loop till we hit the end of the line
+    while (i < length) {
+        // make sure we have a whole xyv
+        if (i + 3 > length) {
+            return ParseFailed(result, length, PARSE_BADLENGTH);
+        }
+
+        // make sure each character is from 1-9
+        for (k = i; k < i + 3; ++k) {
+            if (line[k] < '1'
+                || line[k] > '9') {
+                return ParseFailed(result, k, PARSE_BADCHARACTER);
+            }
+        }
+
+        if (!AddGiven(cells, units, CELL(line[i] - '1', line[i + 1] - '1'), line[i + 2] - '0')) {
+            return ParseFailed(result, i, PARSE_CONFLICT);
+        }
+
+        i += 3;
+
+        // if there is more numbers, scoot forward
+        if (i < length) {
+            if (line[i] != ' ') {
+                return ParseFailed(result, i, PARSE_BADCHARACTER);
+            }
+
+            i++;
+        }
+    }
+
+    return true;
+}
+
+//! Function to parse a puzzle in either form
+/*!
+ *  @param      char *          The line to parse, ending at a line ending or a null character
+ *  @param      unsigned int    The line number to report errors with
+ *  @param      unsigned int[9][9] The grid to fill
+ *  @param      ParseResult *   Where to report the outcome
+ *
+ *  @returns    boolean         Whether the line held a puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Trailing whitespace is ignored and a line with nothing else is PARSE_EMPTY. A line
+ *        of more than 3 characters, all digits or blanks, is a grid of the wrong length unless
+ *        it has exactly 81. Anything else is read as an xyv list.
+ */
+bool ParsePuzzleLine(const char *line, unsigned int line_number, unsigned int grid[9][9], ParseResult *result)
+{
+    unsigned int length = 0;
+
+    // sanity
+    if (!line
+        || !result) {
+        return false;
+    }
+
+    result->line = line_number;
+    length = strcspn(line, "\r\n");
+
+    // trailing spaces, tabs and carriage returns aren't part of either form
+    while (length
+        && (line[length - 1] == ' '
+            || line[length - 1] == '\t'
+            || line[length - 1] == '\r')) {
+        length--;
+    }
+
+    if (!length) {
+        return ParseFailed(result, 0, PARSE_EMPTY);
+    }
+
+    // a run of digits and blanks longer than one xyv can only be a grid, whatever its length
+    if (length == PUZZLELINELENGTH
+        || (length > 3
+            && strspn(line, "0123456789._") >= length)) {
+        return ParseGridLine(line, length, grid, result);
+    }
+
+    return ParseXYVLine(line, length, grid, result);
+}
+
+//! Function to describe a parse error
+/*!
+ *  @param      unsigned int    The error from a ParseResult
+ *
+ *  @returns    char *          A short description of the error
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+const char *ParseErrorString(unsigned int error)
+{
+    switch (error) {
+        case PARSE_OK:
+            return "ok";
+        case PARSE_BADLENGTH:
+            return "line is the wrong length";
+        case PARSE_BADCHARACTER:
+            return "unexpected character";
+        case PARSE_CONFLICT:
+            return "given clashes with another given";
+        case PARSE_EMPTY:
+            return "line is empty";
+        default:
+            return "unknown error";
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SUDOKU_PARSER_H
+#define SUDOKU_PARSER_H
+
+#include "SudokuSolver.h"
+
+// the number of characters in a puzzle written on one line
+#define PUZZLELINELENGTH 81
+
+// the reasons a line can fail to parse
+#define PARSE_OK            0
+#define PARSE_BADLENGTH     1
+#define PARSE_BADCHARACTER  2
+#define PARSE_CONFLICT      3
+#define PARSE_EMPTY         4
+
+// A structure defining the outcome of parsing a line
+typedef struct {
+    // the line of input that was parsed, as given by the caller
+    unsigned int line;
+
+    // the column the error was found at, starting from 1, or 0 if there was no error
+    unsigned int column;
+
+    // why the line failed to parse, PARSE_OK if it didn't
+    unsigned int error;
+} ParseResult;
+
+//! Function to parse a puzzle written as 81 characters
+/*!
+ *  @param      char *          The characters to parse
+ *  @param      unsigned int    The number of characters, not counting any line ending
+ *  @param      unsigned int[9][9] The grid to fill
+ *  @param      ParseResult *   Where to report the outcome
+ *
+ *  @returns    boolean         Whether the line held a puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Digits 1 - 9 are givens and '.', '0' and '_' are blanks. The givens are checked
+ *        for two of the same number in a row, column or box.
+ */
+bool ParseGridLine(const char *line, unsigned int length, unsigned int grid[9][9], ParseResult *result);
+
+//! Function to parse a puzzle written as a list of xyv numbers separated by spaces
+/*!
+ *  @param      char *          The characters to parse
+ *  @param      unsigned int    The number of characters, not counting any line ending
+ *  @param      unsigned int[9][9] The grid to fill
+ *  @param      ParseResult *   Where to report the outcome
+ *
+ *  @returns    boolean         Whether the line held a puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: x, y and v all run from 1 to 9, the same as the console input. A cell given twice
+ *        or a number that clashes with an earlier given is a conflict.
+ */
+bool ParseXYVLine(const char *line, unsigned int length, unsigned int grid[9][9], ParseResult *result);
+
+//! Function to parse a puzzle in either form
+/*!
+ *  @param      char *          The line to parse, ending at a line ending or a null character
+ *  @param      unsigned int    The line number to report errors with
+ *  @param      unsigned int[9][9] The grid to fill
+ *  @param      ParseResult *   Where to report the outcome
+ *
+ *  @returns    boolean         Whether the line held a puzzle
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Trailing whitespace is ignored and a line with nothing else is PARSE_EMPTY. A line
+ *        of more than 3 characters, all digits or blanks, is a grid of the wrong length unless
+ *        it has exactly 81. Anything else is read as an xyv list.
+ */
+bool ParsePuzzleLine(const char *line, unsigned int line_number, unsigned int grid[9][9], ParseResult *result);
+
+//! Function to describe a parse error
+/*!
+ *  @param      unsigned int    The error from a ParseResult
+ *
+ *  @returns    char *          A short description of the error
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+const char *ParseErrorString(unsigned int error);
+
+#endif
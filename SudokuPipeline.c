@@ -0,0 +1,751 @@
+#include <sched.h>
+
+#include "SudokuPipeline.h"
+#include "SudokuParser.h"
+#include "SudokuDecisions.h"
+
+// A structure defining what each solver thread of a pipeline is given
+typedef struct {
+    // the pipeline the solver belongs to
+    SudokuPipeline *pipeline;
+
+    // the thread running the solver
+    pthread_t thread;
+} PipelineSolver;
+
+//! Function to initialize a new batch queue
+/*!
+ *  @param      BatchQueue *    A pointer to the queue to initialize
+ *  @param      unsigned int    The smallest number of batches the queue must hold
+ *
+ *  @returns    boolean         Whether the queue was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeBatchQueue(BatchQueue *queue, unsigned int capacity)
+{
+    unsigned int i = 0, size = 2;
+
+    // sanity
+    if (!queue) {
+        return false;
+    }
+
+    // round our capacity up to a power of two so positions wrap with a mask
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    queue->slots = (BatchSlot*)calloc(size, sizeof(BatchSlot));
+
+    // sanity check our slots
+    if (!queue->slots) {
+        return false;
+    }
+
+    if (pthread_mutex_init(&queue->lock, NULL) != 0) {
+        free(queue->slots);
+        queue->slots = NULL;
+        return false;
+    }
+
+    if (pthread_cond_init(&queue->changed, NULL) != 0) {
+        pthread_mutex_destroy(&queue->lock);
+        free(queue->slots);
+        queue->slots = NULL;
+        return false;
+    }
+
+    // every slot starts ready for the push of its own position
+    for (i = 0; i < size; ++i) {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+
+    queue->mask = size - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->waiting, 0);
+
+    return true;
+}
+
+//! Function to cleanup a batch queue
+/*!
+ *  @param      BatchQueue *    A pointer to the queue to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The batches in the queue are not owned by it and are left alone
+ */
+void DestroyBatchQueue(BatchQueue *queue)
+{
+    // sanity
+    if (!queue
+        || !queue->slots) {
+        return;
+    }
+
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->slots);
+    queue->slots = NULL;
+}
+
+//! Function to wake every stage asleep on a queue after a batch was pushed or popped
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The fence pairs with the one a stage makes before it last tries the queue, so
+ *        either the stage is counted here or it sees the batch and never sleeps
+ */
+static void WakeBatchQueue(BatchQueue *queue)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&queue->waiting, memory_order_relaxed)) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_broadcast(&queue->changed);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+//! Function to push a batch onto a queue without blocking or waking anyone
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *  @param      PipelineBatch * The batch to push
+ *
+ *  @returns    boolean         Returns false if the queue is full
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool TryPushBatch(BatchQueue *queue, PipelineBatch *batch)
+{
+    unsigned int position = atomic_load_explicit(&queue->head, memory_order_relaxed), sequence = 0;
+    BatchSlot *slot = NULL;
+    int difference = 0;
+
+    for (;;) {
+        slot = &queue->slots[position & queue->mask];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        difference = (int)(sequence - position);
+
+        if (difference == 0) {
+            // the slot is ready for us, claim it if nobody beat us to it
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1,
+                memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // the slot still holds a batch from a lap ago, we're full
+            return false;
+        } else {
+            // someone else pushed here, try the new head
+            position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+
+    // fill the slot and hand it to the poppers
+    slot->batch = batch;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    return true;
+}
+
+//! Function to pop a batch from a queue without blocking or waking anyone
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *
+ *  @returns    PipelineBatch * The oldest batch in the queue or NULL if it is empty
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static PipelineBatch *TryPopBatch(BatchQueue *queue)
+{
+    unsigned int position = atomic_load_explicit(&queue->tail, memory_order_relaxed), sequence = 0;
+    BatchSlot *slot = NULL;
+    PipelineBatch *batch = NULL;
+    int difference = 0;
+
+    for (;;) {
+        slot = &queue->slots[position & queue->mask];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        difference = (int)(sequence - (position + 1));
+
+        if (difference == 0) {
+            // the slot has been filled, claim it if nobody beat us to it
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + 1,
+                memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // nothing has been pushed here yet, we're empty
+            return NULL;
+        } else {
+            // someone else popped here, try the new tail
+            position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    // empty the slot and hand it back to the pushers for the next lap
+    batch = slot->batch;
+    atomic_store_explicit(&slot->sequence, position + queue->mask + 1, memory_order_release);
+
+    return batch;
+}
+
+//! Function to push a batch onto a queue without blocking
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *  @param      PipelineBatch * The batch to push
+ *
+ *  @returns    boolean         Returns false if the queue is full
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool PushBatch(BatchQueue *queue, PipelineBatch *batch)
+{
+    if (!TryPushBatch(queue, batch)) {
+        return false;
+    }
+
+    WakeBatchQueue(queue);
+
+    return true;
+}
+
+//! Function to pop a batch from a queue without blocking
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *
+ *  @returns    PipelineBatch * The oldest batch in the queue or NULL if it is empty
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+PipelineBatch *PopBatch(BatchQueue *queue)
+{
+    PipelineBatch *batch = TryPopBatch(queue);
+
+    if (batch) {
+        WakeBatchQueue(queue);
+    }
+
+    return batch;
+}
+
+//! Function to push a batch onto a queue, waiting for room if it is full
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *  @param      PipelineBatch * The batch to push
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The queue is tried PIPELINESPINS times, yielding in between, before we sleep until it changes
+ */
+static void WaitPushBatch(BatchQueue *queue, PipelineBatch *batch)
+{
+    unsigned int spins = 0;
+    bool pushed = false;
+
+    while (!pushed) {
+        if (spins++ < PIPELINESPINS) {
+            pushed = PushBatch(queue, batch);
+
+            if (!pushed) {
+                sched_yield();
+            }
+
+            continue;
+        }
+
+        // count ourself as asleep before the last try, so a pop after it has to wake us
+        pthread_mutex_lock(&queue->lock);
+        atomic_fetch_add(&queue->waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        pushed = TryPushBatch(queue, batch);
+
+        if (pushed) {
+            pthread_cond_broadcast(&queue->changed);
+        } else {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        }
+
+        atomic_fetch_sub(&queue->waiting, 1);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+//! Function to pop a batch from a queue, waiting for one if it is empty
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *
+ *  @returns    PipelineBatch * The oldest batch in the queue
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Like WaitPushBatch this only sleeps once PIPELINESPINS tries have come up empty
+ */
+static PipelineBatch *WaitPopBatch(BatchQueue *queue)
+{
+    PipelineBatch *batch = NULL;
+    unsigned int spins = 0;
+
+    while (!batch) {
+        if (spins++ < PIPELINESPINS) {
+            batch = PopBatch(queue);
+
+            if (!batch) {
+                sched_yield();
+            }
+
+            continue;
+        }
+
+        // count ourself as asleep before the last try, so a push after it has to wake us
+        pthread_mutex_lock(&queue->lock);
+        atomic_fetch_add(&queue->waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        batch = TryPopBatch(queue);
+
+        if (batch) {
+            pthread_cond_broadcast(&queue->changed);
+        } else {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        }
+
+        atomic_fetch_sub(&queue->waiting, 1);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    return batch;
+}
+
+//! Function run by each solver thread of a pipeline
+/*!
+ *  @param      void *          A pointer to the PipelineSolver for this thread
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *RunPipelineSolver(void *argument)
+{
+    SudokuPipeline *pipeline = ((PipelineSolver*)argument)->pipeline;
+    PipelineBatch *batch = NULL;
+    PipelinePuzzle *puzzle = NULL;
+    Sudoku sudoku;
+    TraceRing ring;
+    DecisionLog decisions;
+    unsigned int i = 0, c = 0;
+    unsigned long long started = 0, latency = 0;
+    unsigned char givens[SUDOKU_CELLS];
+    char path[PIPELINETRACEPATHSIZE];
+    bool tracing = false, logging = false, sampled = false;
+
+    // one board on our stack is reused for every puzzle this thread solves
+    InitializeSudokuStorage(&sudoku, 0, pipeline->maxguesses);
+    sudoku.verbose = false;
+    sudoku.transpositions = pipeline->transpositions;
+    sudoku.engine = pipeline->engine;
+    sudoku.seed = pipeline->seed;
+    sudoku.dispatcher = pipeline->dispatcher;
+
+    if (pipeline->scorer) {
+        sudoku.scorer = pipeline->scorer;
+    }
+
+    // every solve is traced into a ring of our own, only slow ones are written out
+    tracing = pipeline->tracethreshold
+        && pipeline->tracepath
+        && InitializeTraceRing(&ring, 0, NULL);
+
+    // only sampled solves record their decisions, the rest pay for a check of a thread local
+    logging = pipeline->decisionsample
+        && pipeline->decisionpath
+        && InitializeDecisionLog(&decisions, 0, NULL);
+
+    for (;;) {
+        batch = WaitPopBatch(&pipeline->parsed);
+
+        // pass the end of the input along to the writer
+        if (batch->last) {
+            WaitPushBatch(&pipeline->solved, batch);
+            break;
+        }
+
+        for (i = 0; i < batch->count; ++i) {
+            puzzle = &batch->puzzles[i];
+
+            if (!puzzle->valid) {
+                continue;
+            }
+
+            // only read the clock if someone wants the latency
+            if (pipeline->metrics
+                || tracing) {
+                started = MetricsNanoseconds();
+            }
+
+            // clear the last puzzle and load this one
+            ResetSudoku(&sudoku);
+            memcpy(sudoku.grid, puzzle->grid, sizeof(sudoku.grid));
+
+            if (tracing) {
+                for (c = 0; c < SUDOKU_CELLS; ++c) {
+                    givens[c] = (unsigned char)CELL_VALUE(&sudoku, c);
+                }
+
+                BeginTrace(&ring);
+            }
+
+            sampled = logging
+                && (puzzle->line % pipeline->decisionsample) == 0;
+
+            if (sampled) {
+                BeginDecisionLog(&decisions, &sudoku);
+            }
+
+            SearchSudokuEngine(&sudoku);
+            puzzle->solved = IsSudokuComplete(&sudoku);
+
+            if (sampled) {
+                EndDecisionLog(&decisions, &sudoku);
+                snprintf(path, sizeof(path), "%s.%u.decisions", pipeline->decisionpath, puzzle->line);
+                WriteDecisionFile(&decisions, path);
+            }
+
+            if (pipeline->metrics
+                || tracing) {
+                latency = MetricsNanoseconds() - started;
+            }
+
+            if (pipeline->metrics) {
+                RecordSolveMetrics(pipeline->metrics, latency, SolveOutcome(&sudoku));
+            }
+
+            // keep a record of anything that took too long, named after its line of input
+            if (tracing) {
+                EndTrace(&ring);
+
+                if (latency >= pipeline->tracethreshold) {
+                    snprintf(path, sizeof(path), "%s.%u.trace", pipeline->tracepath, puzzle->line);
+                    WriteTraceFile(&ring, givens, latency, path);
+                }
+            }
+
+            memcpy(puzzle->grid, sudoku.grid, sizeof(puzzle->grid));
+
+            if (puzzle->solved) {
+                atomic_fetch_add(&pipeline->solvedcount, 1);
+            }
+        }
+
+        WaitPushBatch(&pipeline->solved, batch);
+    }
+
+    if (tracing) {
+        DestroyTraceRing(&ring);
+    }
+
+    if (logging) {
+        DestroyDecisionLog(&decisions);
+    }
+
+    // return anything this solver pooled
+    ReleasePoolMemory();
+
+    return NULL;
+}
+
+//! Function to write a batch of solutions
+/*!
+ *  @param      SudokuPipeline * The pipeline writing the batch
+ *  @param      PipelineBatch * The batch to write
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Unreadable puzzles and blank lines are written as an empty line so output lines match input lines
+ */
+static void WriteBatch(SudokuPipeline *pipeline, PipelineBatch *batch)
+{
+    char buffer[PIPELINEBATCHSIZE * 82];
+    char *ptr = buffer;
+    unsigned int i = 0, c = 0;
+
+    // format the whole batch so it goes out in one write
+    for (i = 0; i < batch->count; ++i) {
+        if (batch->puzzles[i].valid) {
+            for (c = 0; c < 81; ++c) {
+                *ptr++ = batch->puzzles[i].grid[c / 9][c % 9] ? (char)('0' + batch->puzzles[i].grid[c / 9][c % 9]) : '.';
+            }
+        }
+
+        *ptr++ = '\n';
+    }
+
+    fwrite(buffer, 1, ptr - buffer, pipeline->output);
+}
+
+//! Function run by the writer thread of a pipeline
+/*!
+ *  @param      void *          A pointer to the SudokuPipeline
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: When the pipeline is ordered, batches that arrive early wait in a reorder buffer
+ *        with a slot for every batch the pipeline owns
+ */
+static void *RunPipelineWriter(void *argument)
+{
+    SudokuPipeline *pipeline = (SudokuPipeline*)argument;
+    PipelineBatch *batch = NULL;
+    PipelineBatch **reorder = NULL;
+    unsigned int finished = 0, next = 0;
+
+    // nothing can be ordered without somewhere to wait
+    if (pipeline->ordered) {
+        reorder = (PipelineBatch**)calloc(pipeline->batchcount, sizeof(PipelineBatch*));
+    }
+
+    // keep going until every solver has passed on the end of the input
+    while (finished < pipeline->threads) {
+        batch = WaitPopBatch(&pipeline->solved);
+
+        if (batch->last) {
+            finished++;
+            WaitPushBatch(&pipeline->empty, batch);
+            continue;
+        }
+
+        if (!reorder) {
+            // write in whatever order the solvers finish
+            WriteBatch(pipeline, batch);
+            WaitPushBatch(&pipeline->empty, batch);
+            continue;
+        }
+
+        // hold on to it until everything read before it is written
+        reorder[batch->sequence % pipeline->batchcount] = batch;
+
+        while ((batch = reorder[next % pipeline->batchcount])
+            && batch->sequence == next) {
+            reorder[next % pipeline->batchcount] = NULL;
+            WriteBatch(pipeline, batch);
+            WaitPushBatch(&pipeline->empty, batch);
+            next++;
+        }
+    }
+
+    fflush(pipeline->output);
+    free(reorder);
+
+    return NULL;
+}
+
+//! Function to initialize a new pipeline
+/*!
+ *  @param      SudokuPipeline * A pointer to the pipeline to initialize
+ *  @param      FILE *          Where to read puzzles from
+ *  @param      FILE *          Where to write solutions to
+ *  @param      unsigned int    The number of solver threads
+ *  @param      unsigned int    The maximum number of consecutive guesses while solving
+ *  @param      boolean         Whether solutions must be written in the order puzzles were read
+ *
+ *  @returns    boolean         Whether the pipeline was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudokuPipeline(SudokuPipeline *pipeline, FILE *input, FILE *output, unsigned int threads, unsigned int maxguesses, bool ordered)
+{
+    unsigned int i = 0;
+
+    // sanity
+    if (!pipeline
+        || !input
+        || !output) {
+        return false;
+    }
+
+    memset(pipeline, 0, sizeof(SudokuPipeline));
+
+    pipeline->input = input;
+    pipeline->output = output;
+    pipeline->threads = MAX(MIN(threads, MAXPIPELINETHREADS), 1);
+    pipeline->maxguesses = maxguesses;
+    pipeline->ordered = ordered;
+    atomic_init(&pipeline->puzzlecount, 0);
+    atomic_init(&pipeline->solvedcount, 0);
+
+    // enough batches to keep every stage busy while others wait
+    pipeline->batchcount = 4 * (pipeline->threads + 2);
+    pipeline->batches = (PipelineBatch*)calloc(pipeline->batchcount, sizeof(PipelineBatch));
+
+    // every queue can hold every batch so a push only ever waits on a slow consumer
+    if (!pipeline->batches
+        || !InitializeBatchQueue(&pipeline->empty, pipeline->batchcount)
+        || !InitializeBatchQueue(&pipeline->parsed, pipeline->batchcount)
+        || !InitializeBatchQueue(&pipeline->solved, pipeline->batchcount)) {
+        DestroySudokuPipeline(pipeline);
+        return false;
+    }
+
+    // every batch starts out empty
+    for (i = 0; i < pipeline->batchcount; ++i) {
+        PushBatch(&pipeline->empty, &pipeline->batches[i]);
+    }
+
+    return true;
+}
+
+//! Function to cleanup a pipeline
+/*!
+ *  @param      SudokuPipeline * A pointer to the pipeline to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroySudokuPipeline(SudokuPipeline *pipeline)
+{
+    // sanity
+    if (!pipeline) {
+        return;
+    }
+
+    DestroyBatchQueue(&pipeline->empty);
+    DestroyBatchQueue(&pipeline->parsed);
+    DestroyBatchQueue(&pipeline->solved);
+
+    free(pipeline->batches);
+    pipeline->batches = NULL;
+}
+
+//! Function to read, solve and write every puzzle of a pipeline's input
+/*!
+ *  @param      SudokuPipeline * A pointer to the pipeline to run
+ *
+ *  @returns    boolean         Whether every stage ran to completion
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The calling thread reads while the solvers and the writer run on their own threads.
+ *        Each input line is either 81 characters of digits with '.', '0' or '_' as blanks,
+ *        or a list of xyv entries, and each output line is the 81 character solution.
+ *        Blank and unreadable lines give an empty line, so output lines match input lines
+ */
+bool RunSudokuPipeline(SudokuPipeline *pipeline)
+{
+    char line[PIPELINELINESIZE];
+    unsigned int i = 0, started = 0, line_number = 0, sequence = 0;
+    int character = 0;
+    PipelineSolver solvers[MAXPIPELINETHREADS];
+    PipelineBatch *batch = NULL;
+    PipelinePuzzle *puzzle = NULL;
+    ParseResult result;
+    pthread_t writer;
+    bool writing = false, blank = false, overlong = false;
+
+    // sanity
+    if (!pipeline
+        || !pipeline->batches) {
+        return false;
+    }
+
+    // start the solvers first so the writer knows how many of them to wait on before it runs
+    for (started = 0; started < pipeline->threads; ++started) {
+        solvers[started].pipeline = pipeline;
+
+        if (pthread_create(&solvers[started].thread, NULL, RunPipelineSolver, &solvers[started]) != 0) {
+            break;
+        }
+    }
+
+    // the writer waits on one end of input from every solver we managed to start
+    pipeline->threads = started;
+    writing = started
+        && pthread_create(&writer, NULL, RunPipelineWriter, pipeline) == 0;
+
+    // read every line of input into batches, there's no point without a writer
+    while (writing && fgets(line, sizeof(line), pipeline->input)) {
+        line_number++;
+
+        // a line that filled our buffer is too long to be a puzzle, throw the rest of it away so it's still one line
+        overlong = strlen(line) == sizeof(line) - 1
+            && line[sizeof(line) - 2] != '\n';
+
+        if (overlong) {
+            do {
+                character = fgetc(pipeline->input);
+            } while (character != EOF
+                && character != '\n');
+        }
+
+        // grab an empty batch to fill
+        if (!batch) {
+            batch = WaitPopBatch(&pipeline->empty);
+            batch->sequence = sequence++;
+            batch->count = 0;
+            batch->last = false;
+        }
+
+        puzzle = &batch->puzzles[batch->count++];
+        puzzle->line = line_number;
+        puzzle->solved = false;
+        puzzle->valid = false;
+
+        if (overlong) {
+            result.line = line_number;
+            result.column = sizeof(line);
+            result.error = PARSE_BADLENGTH;
+        } else {
+            puzzle->valid = ParsePuzzleLine(line, line_number, puzzle->grid, &result);
+        }
+
+        // blank lines go through as an empty line of output, they aren't puzzles
+        blank = !puzzle->valid
+            && result.error == PARSE_EMPTY;
+
+        if (!blank) {
+            atomic_fetch_add(&pipeline->puzzlecount, 1);
+        }
+
+        // say what was wrong with lines we couldn't read
+        if (!puzzle->valid
+            && !blank) {
+            fprintf(stderr, "line %u, column %u: %s\n", result.line, result.column, ParseErrorString(result.error));
+        }
+
+        // hand off full batches
+        if (batch->count == PIPELINEBATCHSIZE) {
+            WaitPushBatch(&pipeline->parsed, batch);
+            batch = NULL;
+        }
+    }
+
+    // hand off whatever is left
+    if (batch) {
+        WaitPushBatch(&pipeline->parsed, batch);
+    }
+
+    // tell every solver there is nothing left
+    for (i = 0; i < started; ++i) {
+        batch = WaitPopBatch(&pipeline->empty);
+        batch->count = 0;
+        batch->last = true;
+        WaitPushBatch(&pipeline->parsed, batch);
+    }
+
+    // wait for everyone to finish
+    for (i = 0; i < started; ++i) {
+        pthread_join(solvers[i].thread, NULL);
+    }
+
+    if (writing) {
+        pthread_join(writer, NULL);
+    }
+
+    return writing;
+}
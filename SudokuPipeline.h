@@ -0,0 +1,241 @@
+#ifndef SUDOKU_PIPELINE_H
+#define SUDOKU_PIPELINE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "SudokuSolver.h"
+
+// the number of puzzles carried between stages at once
+#define PIPELINEBATCHSIZE 64
+
+// the longest path a trace is written to
+#define PIPELINETRACEPATHSIZE 1024
+
+// the most solver threads a pipeline will start
+#define MAXPIPELINETHREADS 64
+
+// the longest input line a pipeline will read
+#define PIPELINELINESIZE 1024
+
+// the times a stage tries a queue again before sleeping until the queue changes
+#define PIPELINESPINS 64
+
+// A structure defining a single puzzle moving through a pipeline
+typedef struct {
+    // the line of input the puzzle was read from
+    unsigned int line;
+
+    // whether the line held a puzzle we could read
+    bool valid;
+
+    // whether the puzzle was solved
+    bool solved;
+
+    // the puzzle, replaced with the solution by the solve stage
+    unsigned int grid[9][9];
+} PipelinePuzzle;
+
+// A structure defining a batch of puzzles moving through a pipeline
+typedef struct {
+    // the order the batch was read in
+    unsigned int sequence;
+
+    // the number of puzzles in the batch
+    unsigned int count;
+
+    // set on the batch that tells a stage there is nothing left to read
+    bool last;
+
+    // the puzzles
+    PipelinePuzzle puzzles[PIPELINEBATCHSIZE];
+} PipelineBatch;
+
+// A structure defining a slot of a batch queue
+typedef struct {
+    // the turn of the slot, says whether it's ready to be pushed or popped
+    atomic_uint sequence;
+
+    // the batch held by the slot
+    PipelineBatch *batch;
+} BatchSlot;
+
+// A structure defining a bounded lock-free queue of batches for any number of producers and consumers,
+// stages that find it full or empty for long enough sleep on it
+typedef struct {
+    // the slots, a power of two of them
+    BatchSlot *slots;
+
+    // the number of slots less one
+    unsigned int mask;
+
+    // keeps pushing and popping threads off each other's cache lines
+    char headpadding[64];
+
+    // the next position to push to
+    atomic_uint head;
+
+    // keeps the head and tail apart
+    char tailpadding[64];
+
+    // the next position to pop from
+    atomic_uint tail;
+
+    // the number of stages asleep on the queue, pushes and pops only wake them when there are any
+    atomic_uint waiting;
+
+    // guards sleeping on the queue, and wakes the sleepers whenever a batch is pushed or popped
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} BatchQueue;
+
+// A structure defining a reader, solver and writer pipeline for solving many puzzles
+typedef struct {
+    // where puzzles are read from, one per line
+    FILE *input;
+
+    // where solutions are written to, one per line
+    FILE *output;
+
+    // the number of solver threads
+    unsigned int threads;
+
+    // the maximum number of consecutive guesses while solving
+    unsigned int maxguesses;
+
+    // whether solutions are written in the order puzzles were read
+    bool ordered;
+
+    // remembers dead boards for every solver thread when set, NULL after initializing
+    TranspositionTable *transpositions;
+
+    // the engine every puzzle is searched with, ENGINE_PROBABILITY after initializing
+    unsigned int engine;
+
+    // the seed every puzzle's randomized search starts from, 0 after initializing
+    unsigned long long seed;
+
+    // chooses the engine of every puzzle when the engine is ENGINE_ADAPTIVE, NULL after initializing
+    const struct SudokuDispatcher *dispatcher;
+
+    // scores the guesses of every puzzle, NULL for ProbabilityScore after initializing
+    GuessScorer scorer;
+
+    // records the latency and outcome of every puzzle when set, NULL after initializing
+    SudokuMetrics *metrics;
+
+    // puzzles taking at least this many nanoseconds have their trace written, 0 after initializing
+    unsigned long long tracethreshold;
+
+    // traces are written to this path followed by .<line>.trace, NULL after initializing
+    const char *tracepath;
+
+    // puzzles on every this many lines of input have their decisions written, 0 after initializing
+    unsigned int decisionsample;
+
+    // decisions are written to this path followed by .<line>.decisions, NULL after initializing
+    const char *decisionpath;
+
+    // every batch the pipeline owns
+    PipelineBatch *batches;
+
+    // the number of batches the pipeline owns
+    unsigned int batchcount;
+
+    // batches waiting to be filled by the reader
+    BatchQueue empty;
+
+    // batches waiting to be solved
+    BatchQueue parsed;
+
+    // batches waiting to be written
+    BatchQueue solved;
+
+    // the number of puzzles read
+    atomic_uint puzzlecount;
+
+    // the number of puzzles solved
+    atomic_uint solvedcount;
+} SudokuPipeline;
+
+//! Function to initialize a new batch queue
+/*!
+ *  @param      BatchQueue *    A pointer to the queue to initialize
+ *  @param      unsigned int    The smallest number of batches the queue must hold
+ *
+ *  @returns    boolean         Whether the queue was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeBatchQueue(BatchQueue *queue, unsigned int capacity);
+
+//! Function to cleanup a batch queue
+/*!
+ *  @param      BatchQueue *    A pointer to the queue to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The batches in the queue are not owned by it and are left alone
+ */
+void DestroyBatchQueue(BatchQueue *queue);
+
+//! Function to push a batch onto a queue without blocking
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *  @param      PipelineBatch * The batch to push
+ *
+ *  @returns    boolean         Returns false if the queue is full
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool PushBatch(BatchQueue *queue, PipelineBatch *batch);
+
+//! Function to pop a batch from a queue without blocking
+/*!
+ *  @param      BatchQueue *    A pointer to the queue
+ *
+ *  @returns    PipelineBatch * The oldest batch in the queue or NULL if it is empty
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+PipelineBatch *PopBatch(BatchQueue *queue);
+
+//! Function to initialize a new pipeline
+/*!
+ *  @param      SudokuPipeline * A pointer to the pipeline to initialize
+ *  @param      FILE *          Where to read puzzles from
+ *  @param      FILE *          Where to write solutions to
+ *  @param      unsigned int    The number of solver threads
+ *  @param      unsigned int    The maximum number of consecutive guesses while solving
+ *  @param      boolean         Whether solutions must be written in the order puzzles were read
+ *
+ *  @returns    boolean         Whether the pipeline was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudokuPipeline(SudokuPipeline *pipeline, FILE *input, FILE *output, unsigned int threads, unsigned int maxguesses, bool ordered);
+
+//! Function to cleanup a pipeline
+/*!
+ *  @param      SudokuPipeline * A pointer to the pipeline to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroySudokuPipeline(SudokuPipeline *pipeline);
+
+//! Function to read, solve and write every puzzle of a pipeline's input
+/*!
+ *  @param      SudokuPipeline * A pointer to the pipeline to run
+ *
+ *  @returns    boolean         Whether every stage ran to completion
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The calling thread reads while the solvers and the writer run on their own threads.
+ *        Each input line is either 81 characters of digits with '.', '0' or '_' as blanks,
+ *        or a list of xyv entries, and each output line is the 81 character solution.
+ *        Blank and unreadable lines give an empty line, so output lines match input lines
+ */
+bool RunSudokuPipeline(SudokuPipeline *pipeline);
+
+#endif
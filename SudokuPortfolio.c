@@ -0,0 +1,356 @@
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include "SudokuPortfolio.h"
+
+// the sudoku's own search, then guesses by fewest candidates, nogood learning, the sat solver and
+// randomized restarts
+const SudokuPortfolio DefaultPortfolio = {
+    {
+        { ENGINE_PROBABILITY, NULL, 0 },
+        { ENGINE_PROBABILITY, CandidateScore, 0 },
+        { ENGINE_LEARNING, NULL, 0 },
+        { ENGINE_SAT, NULL, 0 },
+        { ENGINE_RESTARTS, NULL, 0 }
+    },
+    5,
+    PORTFOLIOHEADSTART
+};
+
+// A structure defining what the members of a race share
+typedef struct {
+    // set once a member has won, every other member stops at its next guess or conflict
+    atomic_bool cancel;
+
+    // the member that won, PORTFOLIONOWINNER until one has
+    atomic_uint winner;
+
+    // the members still searching on their own threads
+    unsigned int running;
+
+    // guards running, and wakes the caller whenever a member stops
+    pthread_mutex_t lock;
+    pthread_cond_t stopped;
+} PortfolioRace;
+
+// A structure defining a member of a race
+typedef struct {
+    // the race the member is in
+    PortfolioRace *race;
+
+    // the member's place in the portfolio
+    unsigned int index;
+
+    // the board the member searches, a copy of the puzzle set up with the member's configuration
+    Sudoku board;
+
+    // the guesses the member made
+    unsigned long long guesses;
+
+    // whether the member found a solution
+    bool solved;
+
+    // the thread the member searches on, the head start is searched on the calling thread
+    pthread_t thread;
+
+    // whether the member searches on a thread of its own
+    bool started;
+} PortfolioRunner;
+
+//! Function to tell whether a member's search settled the puzzle one way or the other
+/*!
+ *  @param      Sudoku*         A pointer to the member's board after searching
+ *  @param      boolean         Whether the member found a solution
+ *
+ *  @returns    boolean         Whether the member found a solution or proved there is none
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool MemberConcluded(Sudoku *board, bool solved)
+{
+    if (solved) {
+        return true;
+    }
+
+    // a cancelled search didn't try everything
+    if (SEARCH_CANCELLED(board)) {
+        return false;
+    }
+
+    switch (board->engine) {
+        case ENGINE_LEARNING:
+            // learning ignores the guess limit so every failure is a proof
+            return true;
+        case ENGINE_SAT:
+            // only a proof leaves a contradiction behind, running out of memory doesn't
+            return board->contradiction != CONTRADICTION_NONE;
+        default:
+            // the guess limit may have cut the search short
+            return CountEmptyCells(board) <= board->maxguesscount;
+    }
+}
+
+//! Function to set up a member's board with its configuration
+/*!
+ *  @param      PortfolioRunner * A pointer to the member
+ *  @param      PortfolioRace * A pointer to the race the member is in
+ *  @param      unsigned int    The member's place in the portfolio
+ *  @param      PortfolioMember * The member's configuration
+ *  @param      Sudoku*         The puzzle to copy
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void SetupPortfolioMember(PortfolioRunner *runner, PortfolioRace *race, unsigned int index, const PortfolioMember *member, Sudoku *sudoku)
+{
+    runner->race = race;
+    runner->index = index;
+    runner->solved = false;
+    runner->started = false;
+
+    InitializeSudokuStorage(&runner->board, sudoku->threshold, sudoku->maxguesscount);
+    runner->board.verbose = false;
+    CopySudoku(&runner->board, sudoku);
+
+    // a portfolio can't race itself
+    runner->board.engine = (member->engine == ENGINE_PORTFOLIO) ? ENGINE_PROBABILITY : member->engine;
+    runner->board.threads = 1;
+    runner->board.metrics = NULL;
+    runner->board.guesscounter = &runner->guesses;
+    runner->board.guesslimit = 0;
+    runner->board.cancel = &race->cancel;
+
+    if (member->scorer) {
+        runner->board.scorer = member->scorer;
+    }
+
+    if (member->maxguesscount) {
+        runner->board.maxguesscount = member->maxguesscount;
+    }
+}
+
+//! Function run by every member of a race
+/*!
+ *  @param      void *          A pointer to the PortfolioRunner of the member
+ *
+ *  @returns    void *          Always NULL
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void *RunPortfolioMember(void *argument)
+{
+    PortfolioRunner *runner = (PortfolioRunner*)argument;
+    PortfolioRace *race = runner->race;
+    unsigned int expected = PORTFOLIONOWINNER;
+
+    runner->solved = SearchSudokuEngine(&runner->board);
+
+    // the first to settle the puzzle wins and stops everyone else
+    if (MemberConcluded(&runner->board, runner->solved)
+        && atomic_compare_exchange_strong(&race->winner, &expected, runner->index)) {
+        atomic_store(&race->cancel, true);
+    }
+
+    // let the caller know one less member is searching
+    if (runner->started) {
+        pthread_mutex_lock(&race->lock);
+        race->running--;
+        pthread_cond_signal(&race->stopped);
+        pthread_mutex_unlock(&race->lock);
+
+        // the engine may have pooled blocks on this thread
+        ReleasePoolMemory();
+    }
+
+    return NULL;
+}
+
+//! Function to wait for every member of a race to stop, passing on a cancel from the caller
+/*!
+ *  @param      PortfolioRace * A pointer to the race
+ *  @param      Sudoku*         The sudoku the caller asked us to search
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The members only watch the race's own flag, so whoever cancelled the caller is
+ *        heard within PORTFOLIOCANCELPOLL microseconds
+ */
+static void WaitPortfolioRace(PortfolioRace *race, Sudoku *sudoku)
+{
+    struct timespec deadline;
+
+    pthread_mutex_lock(&race->lock);
+
+    while (race->running) {
+        if (SEARCH_CANCELLED(sudoku)) {
+            atomic_store(&race->cancel, true);
+        }
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += PORTFOLIOCANCELPOLL * 1000l;
+
+        if (deadline.tv_nsec >= 1000000000l) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000l;
+        }
+
+        pthread_cond_timedwait(&race->stopped, &race->lock, &deadline);
+    }
+
+    pthread_mutex_unlock(&race->lock);
+}
+
+//! Function which searches for a solution by racing several configurations against each other
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      SudokuPortfolio * The configurations to race, or NULL for DefaultPortfolio
+ *  @param      unsigned int *  Receives the member that finished first, or NULL
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The first member searches alone on the calling thread until it has made the head
+ *        start's guesses. If it hasn't finished by then every member starts again from the top
+ *        on a thread of its own, while the calling thread passes on any cancel of the sudoku.
+ *        The first member to find a solution or prove there is none wins and the rest are
+ *        cancelled, they stop at their next guess or conflict. The winner is PORTFOLIONOWINNER
+ *        when nobody could finish.
+ */
+bool SearchSudokuPortfolio(Sudoku *sudoku, const SudokuPortfolio *portfolio, unsigned int *winner)
+{
+    PortfolioRace race;
+    PortfolioRunner *runners = NULL, *won = NULL;
+    unsigned int i = 0, count = 0, first = PORTFOLIONOWINNER;
+    unsigned long long guesses = 0;
+    bool solved = false;
+
+    if (winner) {
+        *winner = PORTFOLIONOWINNER;
+    }
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    if (!portfolio) {
+        portfolio = &DefaultPortfolio;
+    }
+
+    // only race what propagation alone can't settle, most puzzles never start a thread
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            return false;
+    }
+
+    count = MIN(portfolio->count, MAXPORTFOLIOMEMBERS);
+
+    if (!count
+        || !(runners = (PortfolioRunner*)AllocateMemory(sudoku->allocator, count * sizeof(PortfolioRunner)))) {
+        return false;
+    }
+
+    if (pthread_mutex_init(&race.lock, NULL) != 0) {
+        FreeMemory(sudoku->allocator, runners, count * sizeof(PortfolioRunner));
+        return false;
+    }
+
+    if (pthread_cond_init(&race.stopped, NULL) != 0) {
+        pthread_mutex_destroy(&race.lock);
+        FreeMemory(sudoku->allocator, runners, count * sizeof(PortfolioRunner));
+        return false;
+    }
+
+    atomic_init(&race.cancel, false);
+    atomic_init(&race.winner, PORTFOLIONOWINNER);
+    race.running = 0;
+
+    // the first member searches alone until it has used up its head start, most puzzles never start a thread,
+    // nobody else can win yet so it answers to the caller's cancel rather than the race's
+    SetupPortfolioMember(&runners[0], &race, 0, &portfolio->members[0], sudoku);
+    runners[0].board.guesslimit = portfolio->headstart;
+
+    if (sudoku->cancel) {
+        runners[0].board.cancel = sudoku->cancel;
+    }
+
+    RunPortfolioMember(&runners[0]);
+
+    // otherwise everyone races from the top, the head start is all the first member throws away
+    if (atomic_load(&race.winner) == PORTFOLIONOWINNER
+        && portfolio->headstart
+        && !SEARCH_CANCELLED(sudoku)) {
+        for (i = 0; i < count; ++i) {
+            SetupPortfolioMember(&runners[i], &race, i, &portfolio->members[i], sudoku);
+        }
+
+        // count each member before it starts so it can't finish before it is counted
+        for (i = 0; i < count; ++i) {
+            pthread_mutex_lock(&race.lock);
+            race.running++;
+            pthread_mutex_unlock(&race.lock);
+
+            runners[i].started = true;
+
+            if (pthread_create(&runners[i].thread, NULL, RunPortfolioMember, &runners[i]) != 0) {
+                runners[i].started = false;
+
+                pthread_mutex_lock(&race.lock);
+                race.running--;
+                pthread_mutex_unlock(&race.lock);
+            }
+        }
+
+        // the calling thread only waits, watching for the caller to cancel us, unless it has to search itself
+        if (!runners[0].started) {
+            RunPortfolioMember(&runners[0]);
+        }
+
+        WaitPortfolioRace(&race, sudoku);
+
+        for (i = 0; i < count; ++i) {
+            if (runners[i].started) {
+                pthread_join(runners[i].thread, NULL);
+            }
+        }
+    }
+
+    pthread_cond_destroy(&race.stopped);
+    pthread_mutex_destroy(&race.lock);
+
+    // everyone has stopped so the winner's board can be read
+    first = atomic_load(&race.winner);
+
+    for (i = 0; i < count; ++i) {
+        guesses += runners[i].guesses;
+    }
+
+    if (first < count) {
+        won = &runners[first];
+        solved = won->solved;
+
+        // take the winner's solution, or its proof there is none
+        if (solved) {
+            memcpy(sudoku->grid, won->board.grid, sizeof(sudoku->grid));
+            sudoku->candidatesvalid = false;
+            sudoku->branchvalid = false;
+        } else if (sudoku->contradiction == CONTRADICTION_NONE) {
+            sudoku->contradiction = CONTRADICTION_NOGOOD;
+        }
+    }
+
+    if (winner) {
+        *winner = first;
+    }
+
+    if (sudoku->guesscounter) {
+        *sudoku->guesscounter += guesses;
+    }
+
+    FreeMemory(sudoku->allocator, runners, count * sizeof(PortfolioRunner));
+
+    return solved;
+}
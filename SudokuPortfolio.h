@@ -0,0 +1,67 @@
+#ifndef SUDOKU_PORTFOLIO_H
+#define SUDOKU_PORTFOLIO_H
+
+#include <stdbool.h>
+
+#include "SudokuSolver.h"
+
+// the most configurations a portfolio races
+#define MAXPORTFOLIOMEMBERS 8
+
+// the winner of a race nobody could finish
+#define PORTFOLIONOWINNER   MAXPORTFOLIOMEMBERS
+
+// the guesses the first member makes alone before the rest join in, more than most puzzles need
+#define PORTFOLIOHEADSTART  128
+
+// the microseconds between checks of whether the caller has cancelled a race
+#define PORTFOLIOCANCELPOLL 1000
+
+// A structure defining one configuration a portfolio races
+typedef struct {
+    // the ENGINE_ to search with, anything but ENGINE_PORTFOLIO
+    unsigned int engine;
+
+    // scores the guesses, NULL for the sudoku's own scorer
+    GuessScorer scorer;
+
+    // the maximum number of consecutive guesses, 0 for the sudoku's own
+    unsigned int maxguesscount;
+} PortfolioMember;
+
+// A structure defining the configurations raced on a puzzle
+typedef struct {
+    // the configurations, the first is the one trusted to finish most puzzles alone
+    PortfolioMember members[MAXPORTFOLIOMEMBERS];
+
+    // the number of configurations
+    unsigned int count;
+
+    // the guesses the first member makes alone before the rest join in, 0 to only run the first member
+    unsigned int headstart;
+} SudokuPortfolio;
+
+// the sudoku's own search, then guesses by fewest candidates, nogood learning, the sat solver and
+// randomized restarts
+extern const SudokuPortfolio DefaultPortfolio;
+
+//! Function which searches for a solution by racing several configurations against each other
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      SudokuPortfolio * The configurations to race, or NULL for DefaultPortfolio
+ *  @param      unsigned int *  Receives the member that finished first, or NULL
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The first member searches alone on the calling thread until it has made the head
+ *        start's guesses. If it hasn't finished by then every member starts again from the top
+ *        on a thread of its own, while the calling thread passes on any cancel of the sudoku.
+ *        The first member to find a solution or prove there is none wins and the rest are
+ *        cancelled, they stop at their next guess or conflict. The winner is PORTFOLIONOWINNER
+ *        when nobody could finish.
+ */
+bool SearchSudokuPortfolio(Sudoku *sudoku, const SudokuPortfolio *portfolio, unsigned int *winner);
+
+#endif
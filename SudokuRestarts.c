@@ -0,0 +1,354 @@
+#include "SudokuRestarts.h"
+#include "SudokuTrace.h"
+#include "SudokuDecisions.h"
+
+// A structure defining a search that starts again whenever it runs out of guesses
+typedef struct {
+    // the state of the random numbers ties are broken with, starts as the seed of the sudoku
+    unsigned long long random;
+
+    // the guesses the current restart may make
+    unsigned long long budget;
+
+    // the guesses the current restart has made
+    unsigned long long guesses;
+
+    // whether the current restart ran out of guesses, so its failure proves nothing
+    bool exhausted;
+} RestartSearch;
+
+//! Function to draw the next random number of a search
+/*!
+ *  @param      RestartSearch * A pointer to the search
+ *
+ *  @returns    unsigned long long The next random number
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This is splitmix64, any seed including 0 gives a good sequence
+ */
+static unsigned long long NextRandom(RestartSearch *search)
+{
+    unsigned long long z = (search->random += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+//! Function to pick one of the cells with the fewest candidates at random
+/*!
+ *  @param      RestartSearch * A pointer to the search
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int *  A pointer that will receive the x position of the cell
+ *  @param      unsigned int *  A pointer that will receive the y position of the cell
+ *
+ *  @returns    boolean         Returns false if there are no empty cells or an empty cell has no candidates
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every tied cell is equally likely to be picked, without having to remember them all
+ */
+static bool PickRandomCell(RestartSearch *search, Sudoku *sudoku, unsigned int *X, unsigned int *Y)
+{
+    unsigned int c = 0, count = 0, degree = 0, best = 10, bestdegree = 0, ties = 0, cell = SUDOKU_CELLS;
+
+    // make sure our candidates match the grid
+    if (!RefreshCandidates(sudoku)) {
+        return false;
+    }
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        if (CELL_VALUE(sudoku, c)) {
+            continue;
+        }
+
+        count = POPCOUNT(CELL_CANDIDATES(sudoku, c));
+        degree = sudoku->unitempty[ROW_UNIT(CellRow[c])] + sudoku->unitempty[COLUMN_UNIT(CellColumn[c])] + sudoku->unitempty[BOX_UNIT(CellBox[c])];
+
+        // an empty cell with nothing that fits means this board is a dead end
+        if (!count) {
+            return false;
+        }
+
+        // the n'th tie replaces the cell kept so far one time in n
+        if (count < best
+            || (count == best && degree > bestdegree)) {
+            best = count;
+            bestdegree = degree;
+            ties = 1;
+            cell = c;
+        } else if (count == best
+            && degree == bestdegree
+            && NextRandom(search) % ++ties == 0) {
+            cell = c;
+        }
+    }
+
+    if (cell == SUDOKU_CELLS) {
+        return false;
+    }
+
+    *X = CellColumn[cell];
+    *Y = CellRow[cell];
+
+    return true;
+}
+
+//! Function to shuffle the guesses of a ranking that scored the same
+/*!
+ *  @param      RestartSearch * A pointer to the search
+ *  @param      GuessRanking *  The ranking, best first
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void ShuffleTiedGuesses(RestartSearch *search, GuessRanking *ranking)
+{
+    unsigned int g = 0, end = 0, i = 0, j = 0;
+    Guess swap;
+
+    for (g = 0; g < ranking->count; g = end) {
+        // find the run of guesses scored the same as this one
+        for (end = g + 1; end < ranking->count && ranking->guesses[end].probability == ranking->guesses[g].probability; ++end);
+
+        // and shuffle it in place
+        for (i = end - 1; i > g; --i) {
+            j = g + (unsigned int)(NextRandom(search) % (i - g + 1));
+
+            swap = ranking->guesses[i];
+            ranking->guesses[i] = ranking->guesses[j];
+            ranking->guesses[j] = swap;
+        }
+    }
+}
+
+//! Function which searches a board until it is solved, proven dead or the restart runs out of guesses
+/*!
+ *  @param      RestartSearch * A pointer to the search
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      unsigned int    The number of guesses already made above this board
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool SearchRestart(RestartSearch *search, Sudoku *sudoku, unsigned int depth)
+{
+    unsigned int x = 0, y = 0, g = 0;
+    bool solved = false;
+    GuessRanking ranking;
+    Sudoku branch;
+
+    // someone else has already finished
+    if (SEARCH_CANCELLED(sudoku)) {
+        return false;
+    }
+
+    // place everything that is forced, we may not need to guess at all
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            return false;
+    }
+
+    // don't guess any deeper than we're allowed
+    if (depth >= sudoku->maxguesscount) {
+        return false;
+    }
+
+    // find the cell to guess in, if there isn't one this board is a dead end
+    if (!PickRandomCell(search, sudoku, &x, &y)) {
+        return false;
+    }
+
+    // an earlier restart may already have shown this board is a dead end
+    if (sudoku->transpositions
+        && IsKnownDead(sudoku->transpositions, HashSudoku(sudoku))) {
+        TRACE_EVENT(TRACE_KNOWNDEAD, 0, 0, depth);
+        return false;
+    }
+
+    // grab our guesses, best first with the ties in a random order
+    if (!RankCellGuesses(sudoku, x, y, &ranking)
+        || !InitializeSudokuStorage(&branch, sudoku->threshold, sudoku->maxguesscount)) {
+        return false;
+    }
+
+    ShuffleTiedGuesses(search, &ranking);
+    branch.verbose = false;
+
+    // try each guess on a fresh copy of this board until the budget runs out
+    for (g = 0; g < ranking.count && !solved && !search->exhausted && !SEARCH_CANCELLED(sudoku); ++g) {
+        if (search->guesses >= search->budget) {
+            search->exhausted = true;
+            break;
+        }
+
+        CopySudoku(&branch, sudoku);
+        TRACE_EVENT(TRACE_GUESS, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, depth);
+        DECISION_EVENT(DECISION_GUESS, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, ranking.guesses[g].probability, depth);
+        PlaceNumber(&branch,
+            ranking.guesses[g].x,
+            ranking.guesses[g].y,
+            ranking.guesses[g].value);
+
+        search->guesses++;
+
+        // count the guess if anyone is keeping track
+        if (sudoku->guesscounter) {
+            (*sudoku->guesscounter)++;
+        }
+
+        // if this guess leads to a solution keep it
+        if (SearchRestart(search, &branch, depth + 1)) {
+            CopySudoku(sudoku, &branch);
+            solved = true;
+        } else {
+            TRACE_EVENT(TRACE_BACKTRACK, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, depth);
+            DECISION_EVENT(DECISION_BACKTRACK, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, 0, depth);
+        }
+    }
+
+    // every guess failed, remember it for the restarts to come unless something cut a branch short
+    if (!solved
+        && sudoku->transpositions
+        && !search->exhausted
+        && !SEARCH_CANCELLED(sudoku)
+        && depth + CountEmptyCells(sudoku) <= sudoku->maxguesscount) {
+        RecordDead(sudoku->transpositions, HashSudoku(sudoku));
+    }
+
+    return solved;
+}
+
+//! Function to work out the guesses a restart is allowed
+/*!
+ *  @param      unsigned int    The RESTART_ schedule
+ *  @param      unsigned int    The restart from 0
+ *
+ *  @returns    unsigned long long The guesses the restart may make before the search starts again
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The luby schedule goes 1, 1, 2, 1, 1, 2, 4, 1 ... times RESTARTBASE, so short runs keep
+ *        trying new luck while every so often one is allowed twice as long as any before it
+ */
+unsigned long long RestartBudget(unsigned int schedule, unsigned int restart)
+{
+    unsigned long long size = 1, i = restart, budget = RESTARTBASE;
+    unsigned int r = 0;
+
+    if (schedule == RESTART_GEOMETRIC) {
+        // grow until there's no more room, by then the restart searches everything anyway
+        for (r = 0; r < restart && budget < (~0ull / RESTARTGROWTH); ++r) {
+            budget = (budget * RESTARTGROWTH) / 2;
+        }
+
+        return budget;
+    }
+
+    // find the smallest complete run of the sequence, 2^k - 1 long, that holds the restart
+    while (size < i + 1) {
+        size = (size * 2) + 1;
+        budget *= 2;
+    }
+
+    // the run is two copies of the one before followed by its largest value, step into the copy holding us
+    while (size - 1 != i) {
+        size = (size - 1) / 2;
+        budget /= 2;
+        i %= size;
+    }
+
+    return budget;
+}
+
+//! Function which searches for a solution with random tie breaks, starting again when a guess budget runs out
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      unsigned int    The RESTART_ schedule the budgets follow
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Guesses are made in a cell with the fewest candidates like SearchSudoku, but ties between
+ *        cells and between equally scored values are broken at random from the seed of the sudoku,
+ *        so the same seed always makes the same guesses. An unlucky first guess only costs the
+ *        budget of one restart. Boards proven dead are kept between restarts so no restart
+ *        searches them again. The budgets grow without end so a restart eventually searches
+ *        everything, a restart that fails within its budget proves there is no solution.
+ */
+bool SearchSudokuRestarts(Sudoku *sudoku, unsigned int schedule)
+{
+    unsigned int restart = 0;
+    TranspositionTable table;
+    TranspositionTable *transpositions = NULL;
+    RestartSearch search;
+    Sudoku board;
+    bool solved = false, owned = false;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    // place everything that is forced once, every restart starts from here
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            return false;
+    }
+
+    if (!InitializeSudokuStorage(&board, sudoku->threshold, sudoku->maxguesscount)) {
+        return false;
+    }
+
+    board.verbose = false;
+    search.random = sudoku->seed;
+    transpositions = sudoku->transpositions;
+
+    for (restart = 0; !SEARCH_CANCELLED(sudoku); ++restart) {
+        search.budget = RestartBudget(schedule, restart);
+        search.guesses = 0;
+        search.exhausted = false;
+
+        // most puzzles finish in the first restart, the rest get a table of their own to remember dead boards in
+        if (restart == 1
+            && !transpositions
+            && InitializeTranspositionTable(&table, RESTARTTABLEBYTES, sudoku->allocator)) {
+            transpositions = &table;
+            owned = true;
+        }
+
+        if (restart) {
+            TRACE_EVENT(TRACE_RESTART, 0, 0, restart);
+            DECISION_EVENT(DECISION_RESTART, 0, 0, 0, 0);
+        }
+
+        CopySudoku(&board, sudoku);
+        board.transpositions = transpositions;
+
+        if (SearchRestart(&search, &board, 0)) {
+            // keep the table the sudoku came with
+            board.transpositions = sudoku->transpositions;
+            CopySudoku(sudoku, &board);
+            solved = true;
+            break;
+        }
+
+        // searched everything within the budget, there's nothing to find
+        if (!search.exhausted) {
+            break;
+        }
+    }
+
+    if (owned) {
+        DestroyTranspositionTable(&table);
+    }
+
+    return solved;
+}
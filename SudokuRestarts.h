@@ -0,0 +1,54 @@
+#ifndef SUDOKU_RESTARTS_H
+#define SUDOKU_RESTARTS_H
+
+#include <stdbool.h>
+
+#include "SudokuSolver.h"
+#include "SudokuTransposition.h"
+
+// the schedules the guess budget of each restart can follow
+#define RESTART_LUBY       0
+#define RESTART_GEOMETRIC  1
+
+// the guesses a restart is allowed for every unit of its schedule, most puzzles finish in the first
+#define RESTARTBASE        32
+
+// the bytes of the table a search keeps its dead boards in between restarts, when the sudoku has none of its own
+#define RESTARTTABLEBYTES  (1 << 18)
+
+// a geometric schedule gives each restart this many guesses for every 2 the one before had
+#define RESTARTGROWTH      3
+
+//! Function to work out the guesses a restart is allowed
+/*!
+ *  @param      unsigned int    The RESTART_ schedule
+ *  @param      unsigned int    The restart from 0
+ *
+ *  @returns    unsigned long long The guesses the restart may make before the search starts again
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The luby schedule goes 1, 1, 2, 1, 1, 2, 4, 1 ... times RESTARTBASE, so short runs keep
+ *        trying new luck while every so often one is allowed twice as long as any before it
+ */
+unsigned long long RestartBudget(unsigned int schedule, unsigned int restart);
+
+//! Function which searches for a solution with random tie breaks, starting again when a guess budget runs out
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      unsigned int    The RESTART_ schedule the budgets follow
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Guesses are made in a cell with the fewest candidates like SearchSudoku, but ties between
+ *        cells and between equally scored values are broken at random from the seed of the sudoku,
+ *        so the same seed always makes the same guesses. An unlucky first guess only costs the
+ *        budget of one restart. Boards proven dead are kept between restarts so no restart
+ *        searches them again. The budgets grow without end so a restart eventually searches
+ *        everything, a restart that fails within its budget proves there is no solution.
+ */
+bool SearchSudokuRestarts(Sudoku *sudoku, unsigned int schedule);
+
+#endif
@@ -0,0 +1,931 @@
+#include "SudokuSat.h"
+
+// the values a variable can have
+#define SAT_FALSE  0
+#define SAT_TRUE   1
+#define SAT_UNSET  2
+
+// the reason of a variable that wasn't forced by a clause
+#define SAT_NOREASON  (~0u)
+
+// literals are held as twice their variable, plus one when the variable must be false
+#define SAT_LITERAL(v, negative)  (((v) << 1) | (negative))
+#define SAT_NEGATE(l)             ((l) ^ 1u)
+#define SAT_LITERALVARIABLE(l)    ((l) >> 1)
+
+// activity is scaled down before it can overflow, and decays by this much every conflict
+#define SATACTIVITYLIMIT  1e100
+#define SATACTIVITYDECAY  0.95
+
+//! Function to add an item to a list, growing it when full
+/*!
+ *  @param      SatList *       A pointer to the list
+ *  @param      unsigned int    The item to add
+ *  @param      SudokuAllocator * The allocator the list gets its memory from
+ *
+ *  @returns    boolean         Whether the item was added
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool PushSatList(SatList *list, unsigned int item, const SudokuAllocator *allocator)
+{
+    unsigned int capacity = 0;
+    unsigned int *items = NULL;
+
+    if (list->count == list->capacity) {
+        capacity = list->capacity ? list->capacity * 2 : 4;
+        items = ReallocateMemory(allocator, list->items, list->capacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+
+        if (!items) {
+            return false;
+        }
+
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    list->items[list->count++] = item;
+
+    return true;
+}
+
+//! Function to free the memory of a list
+/*!
+ *  @param      SatList *       A pointer to the list
+ *  @param      SudokuAllocator * The allocator the list gets its memory from
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void FreeSatList(SatList *list, const SudokuAllocator *allocator)
+{
+    FreeMemory(allocator, list->items, list->capacity * sizeof(unsigned int));
+    memset(list, 0, sizeof(SatList));
+}
+
+//! Function to get the value of a literal
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned int    The literal
+ *
+ *  @returns    unsigned int    SAT_TRUE, SAT_FALSE or SAT_UNSET
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static inline unsigned int LiteralValue(const SatSolver *solver, unsigned int literal)
+{
+    unsigned int value = solver->values[SAT_LITERALVARIABLE(literal)];
+
+    // a negative literal is true when its variable is false
+    return (value == SAT_UNSET) ? SAT_UNSET : (value ^ (literal & 1));
+}
+
+//! Function to make a literal true at the current decision level
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned int    The literal
+ *  @param      unsigned int    The clause that forced it, SAT_NOREASON for a decision
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void AssignLiteral(SatSolver *solver, unsigned int literal, unsigned int reason)
+{
+    unsigned int variable = SAT_LITERALVARIABLE(literal);
+
+    solver->values[variable] = (literal & 1) ? SAT_FALSE : SAT_TRUE;
+    solver->levels[variable] = solver->level;
+    solver->reasons[variable] = reason;
+    solver->trail[solver->trailcount++] = literal;
+}
+
+//! Function to undo every assignment made above a decision level
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned int    The decision level to go back to
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every variable remembers the value it had so it is tried again when next decided
+ */
+static void Backtrack(SatSolver *solver, unsigned int level)
+{
+    unsigned int i = 0, variable = 0;
+
+    if (solver->level <= level) {
+        return;
+    }
+
+    for (i = solver->trailcount; i > solver->levelstarts[level]; --i) {
+        variable = SAT_LITERALVARIABLE(solver->trail[i - 1]);
+        solver->phases[variable] = solver->values[variable];
+        solver->values[variable] = SAT_UNSET;
+    }
+
+    solver->trailcount = solver->levelstarts[level];
+    solver->propagated = solver->trailcount;
+    solver->level = level;
+}
+
+//! Function to store a clause and watch its first two literals
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned int *  The literals, at least two
+ *  @param      unsigned int    The number of literals
+ *
+ *  @returns    unsigned int    The index of the clause, SAT_NOREASON if it couldn't be stored
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int StoreClause(SatSolver *solver, const unsigned int *literals, unsigned int count)
+{
+    unsigned int i = 0, capacity = 0, index = solver->clausecount;
+    SatClause *clauses = NULL;
+
+    // make room for another clause
+    if (solver->clausecount == solver->clausecapacity) {
+        capacity = solver->clausecapacity ? solver->clausecapacity * 2 : 256;
+        clauses = ReallocateMemory(solver->allocator, solver->clauses, solver->clausecapacity * sizeof(SatClause), capacity * sizeof(SatClause));
+
+        if (!clauses) {
+            solver->failed = true;
+            return SAT_NOREASON;
+        }
+
+        solver->clauses = clauses;
+        solver->clausecapacity = capacity;
+    }
+
+    solver->clauses[index].start = solver->literals.count;
+    solver->clauses[index].size = count;
+
+    for (i = 0; i < count; ++i) {
+        if (!PushSatList(&solver->literals, literals[i], solver->allocator)) {
+            solver->literals.count = solver->clauses[index].start;
+            solver->failed = true;
+            return SAT_NOREASON;
+        }
+    }
+
+    // the clause only needs looking at once one of its first two literals is false
+    if (!PushSatList(&solver->watches[literals[0]], index, solver->allocator)
+        || !PushSatList(&solver->watches[literals[1]], index, solver->allocator)) {
+        solver->failed = true;
+        return SAT_NOREASON;
+    }
+
+    solver->clausecount++;
+
+    return index;
+}
+
+//! Function to make true everything the assignments so far force
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *
+ *  @returns    unsigned int    The clause left with every literal false, SAT_NOREASON if there's none
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only the clauses watching a literal made false are looked at. Each either finds
+ *        another literal to watch, is already true, forces its other watched literal or is
+ *        a conflict.
+ */
+static unsigned int Propagate(SatSolver *solver)
+{
+    unsigned int i = 0, j = 0, k = 0, index = 0, falsified = 0, swap = 0;
+    unsigned int *literals = NULL;
+    SatClause *clause = NULL;
+    SatList *watches = NULL;
+    bool moved = false;
+
+    while (solver->propagated < solver->trailcount) {
+        falsified = SAT_NEGATE(solver->trail[solver->propagated++]);
+        watches = &solver->watches[falsified];
+
+        for (i = 0, j = 0; i < watches->count; ++i) {
+            index = watches->items[i];
+            clause = &solver->clauses[index];
+            literals = solver->literals.items + clause->start;
+
+            // keep the literal made false second
+            if (literals[0] == falsified) {
+                literals[0] = literals[1];
+                literals[1] = falsified;
+            }
+
+            // already satisfied by the other watched literal
+            if (LiteralValue(solver, literals[0]) == SAT_TRUE) {
+                watches->items[j++] = index;
+                continue;
+            }
+
+            // watch any other literal that isn't false instead
+            moved = false;
+
+            for (k = 2; k < clause->size; ++k) {
+                if (LiteralValue(solver, literals[k]) != SAT_FALSE) {
+                    // a clause that can't be moved stays where it is and the search gives up
+                    if (!PushSatList(&solver->watches[literals[k]], index, solver->allocator)) {
+                        solver->failed = true;
+                        break;
+                    }
+
+                    swap = literals[1];
+                    literals[1] = literals[k];
+                    literals[k] = swap;
+                    moved = true;
+                    break;
+                }
+            }
+
+            if (moved) {
+                continue;
+            }
+
+            watches->items[j++] = index;
+
+            // every literal is false
+            if (LiteralValue(solver, literals[0]) == SAT_FALSE) {
+                for (++i; i < watches->count; ++i) {
+                    watches->items[j++] = watches->items[i];
+                }
+
+                watches->count = j;
+                solver->propagated = solver->trailcount;
+
+                return index;
+            }
+
+            // only the first literal is left
+            AssignLiteral(solver, literals[0], index);
+            solver->propagations++;
+        }
+
+        watches->count = j;
+    }
+
+    return SAT_NOREASON;
+}
+
+//! Function to make a variable more likely to be decided next
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned int    The variable
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void BumpVariable(SatSolver *solver, unsigned int variable)
+{
+    unsigned int i = 0;
+
+    solver->activity[variable] += solver->increment;
+
+    // scale every activity down together before they overflow
+    if (solver->activity[variable] > SATACTIVITYLIMIT) {
+        for (i = 1; i <= solver->variables; ++i) {
+            solver->activity[i] /= SATACTIVITYLIMIT;
+        }
+
+        solver->increment /= SATACTIVITYLIMIT;
+    }
+}
+
+//! Function to learn a clause from a conflict
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned int    The clause with every literal false
+ *
+ *  @returns    unsigned int    The decision level to go back to
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The conflict is resolved with the reasons of the literals set at the current level,
+ *        latest first, until only one is left. The clause learned is left in the solver with
+ *        that literal first and the literal set at the highest level of the rest second.
+ */
+static unsigned int AnalyzeConflict(SatSolver *solver, unsigned int conflict)
+{
+    unsigned int i = 0, pending = 0, literal = 0, variable = 0, position = solver->trailcount;
+    unsigned int backtrack = 0, highest = 1, swap = 0;
+    unsigned int *literals = NULL;
+    SatClause *clause = NULL;
+    bool first = true;
+
+    solver->learned.count = 1;
+
+    do {
+        clause = &solver->clauses[conflict];
+        literals = solver->literals.items + clause->start;
+
+        // the first literal of a reason is the one it forced, which is being resolved away
+        for (i = first ? 0 : 1; i < clause->size; ++i) {
+            variable = SAT_LITERALVARIABLE(literals[i]);
+
+            if (solver->seen[variable]
+                || !solver->levels[variable]) {
+                continue;
+            }
+
+            solver->seen[variable] = 1;
+            BumpVariable(solver, variable);
+
+            if (solver->levels[variable] == solver->level) {
+                pending++;
+            } else {
+                solver->learned.items[solver->learned.count++] = literals[i];
+            }
+        }
+
+        // the latest literal on the trail that is part of the conflict
+        do {
+            literal = solver->trail[--position];
+        } while (!solver->seen[SAT_LITERALVARIABLE(literal)]);
+
+        variable = SAT_LITERALVARIABLE(literal);
+        solver->seen[variable] = 0;
+        conflict = solver->reasons[variable];
+        first = false;
+    } while (--pending);
+
+    solver->learned.items[0] = SAT_NEGATE(literal);
+
+    // the clause forces its first literal once we go back to the highest level of the rest
+    for (i = 1; i < solver->learned.count; ++i) {
+        variable = SAT_LITERALVARIABLE(solver->learned.items[i]);
+        solver->seen[variable] = 0;
+
+        if (solver->levels[variable] > backtrack) {
+            backtrack = solver->levels[variable];
+            highest = i;
+        }
+    }
+
+    if (solver->learned.count > 1) {
+        swap = solver->learned.items[1];
+        solver->learned.items[1] = solver->learned.items[highest];
+        solver->learned.items[highest] = swap;
+    }
+
+    return backtrack;
+}
+
+//! Function to pick the next variable to decide
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *
+ *  @returns    unsigned int    The unset variable with the most activity, 0 if every variable is set
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A sudoku only has 729 variables so they are simply scanned
+ */
+static unsigned int PickVariable(SatSolver *solver)
+{
+    unsigned int i = 0, best = 0;
+
+    for (i = 1; i <= solver->variables; ++i) {
+        if (solver->values[i] == SAT_UNSET
+            && (!best || solver->activity[i] > solver->activity[best])) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+//! Function to find a term of the luby sequence
+/*!
+ *  @param      unsigned long long The position in the sequence from 0
+ *
+ *  @returns    unsigned long long The term, 1 1 2 1 1 2 4 1 1 2 ...
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned long long Luby(unsigned long long position)
+{
+    unsigned long long size = 1, term = 1;
+
+    // find the smallest finished run 2^k - 1 long the position falls in
+    while (size < position + 1) {
+        size = (size * 2) + 1;
+        term *= 2;
+    }
+
+    // positions in the second copy of the run before its last term repeat the first
+    while (size - 1 != position) {
+        size >>= 1;
+        term >>= 1;
+
+        if (position >= size) {
+            position -= size;
+        }
+    }
+
+    return term;
+}
+
+//! Function to initialize a sat solver with no clauses
+/*!
+ *  @param      SatSolver *     A pointer to the solver to initialize
+ *  @param      unsigned int    The number of variables, numbered from 1
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the solver was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSatSolver(SatSolver *solver, unsigned int variables, const SudokuAllocator *allocator)
+{
+    unsigned int count = variables + 1;
+
+    // sanity
+    if (!solver
+        || !variables) {
+        return false;
+    }
+
+    memset(solver, 0, sizeof(SatSolver));
+
+    solver->variables = variables;
+    solver->allocator = allocator;
+    solver->increment = 1.0;
+
+    solver->watches = AllocateMemory(allocator, count * 2 * sizeof(SatList));
+    solver->values = AllocateMemory(allocator, count * sizeof(unsigned char));
+    solver->phases = AllocateMemory(allocator, count * sizeof(unsigned char));
+    solver->levels = AllocateMemory(allocator, count * sizeof(unsigned int));
+    solver->reasons = AllocateMemory(allocator, count * sizeof(unsigned int));
+    solver->activity = AllocateMemory(allocator, count * sizeof(double));
+    solver->trail = AllocateMemory(allocator, count * sizeof(unsigned int));
+    solver->levelstarts = AllocateMemory(allocator, count * sizeof(unsigned int));
+    solver->seen = AllocateMemory(allocator, count * sizeof(unsigned char));
+
+    // a clause never holds more than one literal of a variable, so the one being learned never grows
+    solver->learned.items = AllocateMemory(allocator, count * sizeof(unsigned int));
+    solver->learned.capacity = count;
+
+    if (!solver->watches
+        || !solver->values
+        || !solver->phases
+        || !solver->levels
+        || !solver->reasons
+        || !solver->activity
+        || !solver->trail
+        || !solver->levelstarts
+        || !solver->seen
+        || !solver->learned.items) {
+        DestroySatSolver(solver);
+        return false;
+    }
+
+    // every variable starts unset and is first tried as false, most are false in a sudoku
+    memset(solver->values, SAT_UNSET, count * sizeof(unsigned char));
+
+    return true;
+}
+
+//! Function to cleanup a sat solver
+/*!
+ *  @param      SatSolver *     A pointer to the solver to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroySatSolver(SatSolver *solver)
+{
+    unsigned int i = 0, count = 0;
+
+    // sanity
+    if (!solver) {
+        return;
+    }
+
+    count = solver->variables + 1;
+
+    if (solver->watches) {
+        for (i = 0; i < count * 2; ++i) {
+            FreeSatList(&solver->watches[i], solver->allocator);
+        }
+    }
+
+    FreeSatList(&solver->literals, solver->allocator);
+    FreeSatList(&solver->learned, solver->allocator);
+    FreeMemory(solver->allocator, solver->clauses, solver->clausecapacity * sizeof(SatClause));
+    FreeMemory(solver->allocator, solver->watches, count * 2 * sizeof(SatList));
+    FreeMemory(solver->allocator, solver->values, count * sizeof(unsigned char));
+    FreeMemory(solver->allocator, solver->phases, count * sizeof(unsigned char));
+    FreeMemory(solver->allocator, solver->levels, count * sizeof(unsigned int));
+    FreeMemory(solver->allocator, solver->reasons, count * sizeof(unsigned int));
+    FreeMemory(solver->allocator, solver->activity, count * sizeof(double));
+    FreeMemory(solver->allocator, solver->trail, count * sizeof(unsigned int));
+    FreeMemory(solver->allocator, solver->levelstarts, count * sizeof(unsigned int));
+    FreeMemory(solver->allocator, solver->seen, count * sizeof(unsigned char));
+
+    memset(solver, 0, sizeof(SatSolver));
+}
+
+//! Function to add a clause to a sat solver
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      int *           The literals, variable n is n when true and -n when false
+ *  @param      unsigned int    The number of literals
+ *
+ *  @returns    boolean         False if the clause couldn't be added or leaves nothing to satisfy
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Clauses can be added between runs, the decisions of the last run are undone first.
+ *        Literals already false are dropped and a clause already true isn't kept.
+ */
+bool AddSatClause(SatSolver *solver, const int *literals, unsigned int count)
+{
+    unsigned int i = 0, j = 0, literal = 0, variable = 0;
+
+    // sanity
+    if (!solver
+        || (count && !literals)) {
+        return false;
+    }
+
+    if (solver->unsatisfiable
+        || solver->failed) {
+        return false;
+    }
+
+    Backtrack(solver, 0);
+    solver->learned.count = 0;
+
+    for (i = 0; i < count; ++i) {
+        variable = (unsigned int)abs(literals[i]);
+
+        if (!variable
+            || variable > solver->variables) {
+            return false;
+        }
+
+        literal = SAT_LITERAL(variable, literals[i] < 0 ? 1u : 0u);
+
+        // a clause with a true literal, or a literal and its negation, is always satisfied
+        if (LiteralValue(solver, literal) == SAT_TRUE) {
+            return true;
+        }
+
+        for (j = 0; j < solver->learned.count; ++j) {
+            if (solver->learned.items[j] == SAT_NEGATE(literal)) {
+                return true;
+            }
+
+            if (solver->learned.items[j] == literal) {
+                break;
+            }
+        }
+
+        // drop repeats and literals that can never be true
+        if (j < solver->learned.count
+            || LiteralValue(solver, literal) == SAT_FALSE) {
+            continue;
+        }
+
+        solver->learned.items[solver->learned.count++] = literal;
+    }
+
+    // nothing left to make true
+    if (!solver->learned.count) {
+        solver->unsatisfiable = true;
+        return false;
+    }
+
+    // a single literal is simply made true
+    if (solver->learned.count == 1) {
+        AssignLiteral(solver, solver->learned.items[0], SAT_NOREASON);
+
+        if (Propagate(solver) != SAT_NOREASON
+            || solver->failed) {
+            solver->unsatisfiable = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    return StoreClause(solver, solver->learned.items, solver->learned.count) != SAT_NOREASON;
+}
+
+//! Function to search for an assignment that satisfies every clause
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned long long The number of conflicts to give up after, 0 to never give up
+ *
+ *  @returns    unsigned int    SAT_SATISFIABLE, SAT_UNSATISFIABLE or SAT_UNKNOWN
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every conflict is explained back to its first unique implication point and the clause
+ *        learned is kept. Decisions take the most active variable, and restarts follow the luby
+ *        sequence. Once satisfiable the assignment is kept until the solver is next changed.
+ */
+unsigned int RunSatSolver(SatSolver *solver, unsigned long long conflictlimit)
+{
+    unsigned long long budget = 0, conflicts = 0, limit = 0;
+    unsigned int conflict = 0, level = 0, clause = 0, variable = 0;
+
+    // sanity
+    if (!solver) {
+        return SAT_UNKNOWN;
+    }
+
+    if (solver->unsatisfiable) {
+        return SAT_UNSATISFIABLE;
+    }
+
+    if (solver->failed) {
+        return SAT_UNKNOWN;
+    }
+
+    // start from nothing but what the clauses force alone
+    Backtrack(solver, 0);
+    limit = conflictlimit ? solver->conflicts + conflictlimit : 0;
+    budget = Luby(solver->restarts) * SATRESTARTBASE;
+
+    while (true) {
+        conflict = Propagate(solver);
+
+        if (solver->failed) {
+            Backtrack(solver, 0);
+            return SAT_UNKNOWN;
+        }
+
+        if (conflict != SAT_NOREASON) {
+            solver->conflicts++;
+            conflicts++;
+
+            // a conflict no decision led to can never be avoided
+            if (!solver->level) {
+                solver->unsatisfiable = true;
+                return SAT_UNSATISFIABLE;
+            }
+
+            level = AnalyzeConflict(solver, conflict);
+            Backtrack(solver, level);
+
+            // the learned clause forces its first literal straight away
+            if (solver->learned.count == 1) {
+                AssignLiteral(solver, solver->learned.items[0], SAT_NOREASON);
+            } else {
+                clause = StoreClause(solver, solver->learned.items, solver->learned.count);
+
+                if (clause == SAT_NOREASON) {
+                    Backtrack(solver, 0);
+                    return SAT_UNKNOWN;
+                }
+
+                AssignLiteral(solver, solver->learned.items[0], clause);
+            }
+
+            solver->increment /= SATACTIVITYDECAY;
+
+            // give up once we've used up our conflicts or been cancelled
+            if ((limit
+                && solver->conflicts >= limit)
+                || (solver->cancel
+                && atomic_load_explicit(solver->cancel, memory_order_relaxed))) {
+                Backtrack(solver, 0);
+                return SAT_UNKNOWN;
+            }
+
+            continue;
+        }
+
+        // start again from the top once the restart's conflicts are used up, keeping what was learned
+        if (conflicts >= budget) {
+            Backtrack(solver, 0);
+            solver->restarts++;
+            conflicts = 0;
+            budget = Luby(solver->restarts) * SATRESTARTBASE;
+            continue;
+        }
+
+        variable = PickVariable(solver);
+
+        // every variable is set without a conflict
+        if (!variable) {
+            return SAT_SATISFIABLE;
+        }
+
+        solver->decisions++;
+        solver->levelstarts[solver->level++] = solver->trailcount;
+        AssignLiteral(solver, SAT_LITERAL(variable, solver->phases[variable] == SAT_TRUE ? 0u : 1u), SAT_NOREASON);
+    }
+}
+
+//! Function to read a variable of a satisfying assignment
+/*!
+ *  @param      SatSolver *     A pointer to the solver after RunSatSolver found it satisfiable
+ *  @param      int             The variable
+ *
+ *  @returns    boolean         Whether the variable is true
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool SatValue(const SatSolver *solver, int variable)
+{
+    // sanity
+    if (!solver
+        || variable < 1
+        || (unsigned int)variable > solver->variables) {
+        return false;
+    }
+
+    return solver->values[variable] == SAT_TRUE;
+}
+
+//! Function to add the rules of sudoku and the board so far to a sat solver
+/*!
+ *  @param      SatSolver *     A pointer to a solver with at least SAT_SUDOKUVARIABLES variables
+ *  @param      Sudoku*         A pointer to the sudoku object to encode
+ *
+ *  @returns    boolean         False if the clauses couldn't be added or the board has no solution
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every cell holds exactly one value and every row, column and box holds every value
+ *        exactly once. Placed values are added as units, as are the values ruled out of a cell
+ *        while the candidates are up to date. Variant rules can be added as further clauses
+ *        over SAT_VARIABLE before running the solver.
+ *        Both halves of every rule are kept even though either implies the other, the
+ *        redundant clauses give the solver the same hidden singles the other engines use.
+ */
+bool EncodeSudoku(SatSolver *solver, Sudoku *sudoku)
+{
+    int clause[SUDOKU_SIZE];
+    unsigned int c = 0, u = 0, v = 0, i = 0, j = 0;
+
+    // sanity
+    if (!solver
+        || !sudoku
+        || solver->variables < SAT_SUDOKUVARIABLES) {
+        return false;
+    }
+
+    // every cell holds one value and no more
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            clause[v - 1] = SAT_VARIABLE(c, v);
+        }
+
+        if (!AddSatClause(solver, clause, SUDOKU_SIZE)) {
+            return false;
+        }
+
+        for (i = 1; i <= SUDOKU_SIZE; ++i) {
+            for (j = i + 1; j <= SUDOKU_SIZE; ++j) {
+                clause[0] = -SAT_VARIABLE(c, i);
+                clause[1] = -SAT_VARIABLE(c, j);
+
+                if (!AddSatClause(solver, clause, 2)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // every unit holds each value once and no more
+    for (u = 0; u < SUDOKU_UNITS; ++u) {
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            for (i = 0; i < SUDOKU_SIZE; ++i) {
+                clause[i] = SAT_VARIABLE(UnitCells[u][i], v);
+            }
+
+            if (!AddSatClause(solver, clause, SUDOKU_SIZE)) {
+                return false;
+            }
+
+            for (i = 0; i < SUDOKU_SIZE; ++i) {
+                for (j = i + 1; j < SUDOKU_SIZE; ++j) {
+                    clause[0] = -SAT_VARIABLE(UnitCells[u][i], v);
+                    clause[1] = -SAT_VARIABLE(UnitCells[u][j], v);
+
+                    if (!AddSatClause(solver, clause, 2)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    // the board so far
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        if (CELL_VALUE(sudoku, c)) {
+            clause[0] = SAT_VARIABLE(c, CELL_VALUE(sudoku, c));
+
+            if (!AddSatClause(solver, clause, 1)) {
+                return false;
+            }
+
+            continue;
+        }
+
+        if (!sudoku->candidatesvalid) {
+            continue;
+        }
+
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            if (CELL_CANDIDATES(sudoku, c) & VALUE_BIT(v)) {
+                continue;
+            }
+
+            clause[0] = -SAT_VARIABLE(c, v);
+
+            if (!AddSatClause(solver, clause, 1)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//! Function to place the values of a satisfying assignment on a sudoku
+/*!
+ *  @param      SatSolver *     A pointer to the solver after RunSatSolver found it satisfiable
+ *  @param      Sudoku*         A pointer to the sudoku object that was encoded
+ *
+ *  @returns    boolean         Whether every empty cell was given a value
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool DecodeSudoku(SatSolver *solver, Sudoku *sudoku)
+{
+    unsigned int c = 0, v = 0;
+
+    // sanity
+    if (!solver
+        || !sudoku
+        || solver->variables < SAT_SUDOKUVARIABLES) {
+        return false;
+    }
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        if (CELL_VALUE(sudoku, c)) {
+            continue;
+        }
+
+        for (v = 1; v <= SUDOKU_SIZE; ++v) {
+            if (SatValue(solver, SAT_VARIABLE(c, v))) {
+                break;
+            }
+        }
+
+        if (v > SUDOKU_SIZE
+            || !PlaceNumber(sudoku, CellColumn[c], CellRow[c], v)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Function which solves a sudoku with the sat solver
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to solve, receives the solution
+ *
+ *  @returns    boolean         Whether the sudoku was solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The guess threshold and guess limit don't apply, the solver runs until it has an answer.
+ *        Decisions are counted as guesses.
+ */
+bool SolveSudokuSat(Sudoku *sudoku)
+{
+    SatSolver solver;
+    bool solved = false;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    if (!InitializeSatSolver(&solver, SAT_SUDOKUVARIABLES, sudoku->allocator)) {
+        return false;
+    }
+
+    solver.cancel = sudoku->cancel;
+
+    if (EncodeSudoku(&solver, sudoku)
+        && RunSatSolver(&solver, 0) == SAT_SATISFIABLE) {
+        solved = DecodeSudoku(&solver, sudoku);
+    }
+
+    if (sudoku->guesscounter) {
+        *sudoku->guesscounter += solver.decisions;
+    }
+
+    // a board the solver proved has no solution is dead
+    if (solver.unsatisfiable
+        && sudoku->contradiction == CONTRADICTION_NONE) {
+        sudoku->contradiction = CONTRADICTION_NOGOOD;
+    }
+
+    DestroySatSolver(&solver);
+
+    return solved;
+}
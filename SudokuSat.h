@@ -0,0 +1,224 @@
+#ifndef SUDOKU_SAT_H
+#define SUDOKU_SAT_H
+
+#include "SudokuSolver.h"
+
+// the number of variables a sudoku is encoded with, one for every value of every cell
+#define SAT_SUDOKUVARIABLES (SUDOKU_CELLS * SUDOKU_SIZE)
+
+// the variable that is true when cell c holds value v, variables count from 1
+#define SAT_VARIABLE(c, v)  ((int)(((c) * SUDOKU_SIZE) + (v)))
+
+// the outcomes of running a sat solver
+#define SAT_UNKNOWN          0
+#define SAT_SATISFIABLE      1
+#define SAT_UNSATISFIABLE    2
+
+// the number of conflicts the first restart waits for, later ones follow the luby sequence
+#define SATRESTARTBASE 64
+
+// A structure defining a growable list of clauses or literals
+typedef struct {
+    // the items
+    unsigned int *items;
+
+    // the number of items held
+    unsigned int count;
+
+    // the number of items there is room for
+    unsigned int capacity;
+} SatList;
+
+// A structure defining where a clause is kept
+typedef struct {
+    // the position of the first literal in the literal pool
+    unsigned int start;
+
+    // the number of literals
+    unsigned int size;
+} SatClause;
+
+// A structure defining a small conflict driven clause learning solver
+typedef struct {
+    // the number of variables, numbered from 1
+    unsigned int variables;
+
+    // the literals of every clause back to back, the two watched literals of a clause come first
+    SatList literals;
+
+    // the clauses, the ones added come first and the learned ones follow
+    SatClause *clauses;
+
+    // the number of clauses held
+    unsigned int clausecount;
+
+    // the number of clauses there is room for
+    unsigned int clausecapacity;
+
+    // the clauses watching each literal, looked at when the literal becomes false
+    SatList *watches;
+
+    // the value of every variable, 1 for true, 0 for false and 2 while unset
+    unsigned char *values;
+
+    // the value each variable was last given, tried first when it is next decided
+    unsigned char *phases;
+
+    // the decision level every variable was set at
+    unsigned int *levels;
+
+    // the clause that forced every variable, ~0 for decisions
+    unsigned int *reasons;
+
+    // how often every variable has been part of a conflict lately
+    double *activity;
+
+    // what a variable's activity grows by, it grows after every conflict so recent ones count most
+    double increment;
+
+    // the literals made true in the order they were made
+    unsigned int *trail;
+
+    // the number of literals on the trail
+    unsigned int trailcount;
+
+    // the number of literals on the trail that have been propagated
+    unsigned int propagated;
+
+    // where each decision level starts on the trail
+    unsigned int *levelstarts;
+
+    // the current decision level
+    unsigned int level;
+
+    // marks the variables seen while learning a clause
+    unsigned char *seen;
+
+    // the clause being learned
+    SatList learned;
+
+    // whether a conflict with no decisions made has been found
+    bool unsatisfiable;
+
+    // whether memory ran out, the solver gives up on anything it is asked after
+    bool failed;
+
+    // the number of conflicts found
+    unsigned long long conflicts;
+
+    // the number of decisions made
+    unsigned long long decisions;
+
+    // the number of literals made true by propagation
+    unsigned long long propagations;
+
+    // the number of restarts
+    unsigned long long restarts;
+
+    // makes RunSatSolver give up once set, NULL if it can't be cancelled
+    atomic_bool *cancel;
+
+    // where the solver gets its memory from
+    const SudokuAllocator *allocator;
+} SatSolver;
+
+//! Function to initialize a sat solver with no clauses
+/*!
+ *  @param      SatSolver *     A pointer to the solver to initialize
+ *  @param      unsigned int    The number of variables, numbered from 1
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the solver was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSatSolver(SatSolver *solver, unsigned int variables, const SudokuAllocator *allocator);
+
+//! Function to cleanup a sat solver
+/*!
+ *  @param      SatSolver *     A pointer to the solver to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroySatSolver(SatSolver *solver);
+
+//! Function to add a clause to a sat solver
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      int *           The literals, variable n is n when true and -n when false
+ *  @param      unsigned int    The number of literals
+ *
+ *  @returns    boolean         False if the clause couldn't be added or leaves nothing to satisfy
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Clauses can be added between runs, the decisions of the last run are undone first
+ */
+bool AddSatClause(SatSolver *solver, const int *literals, unsigned int count);
+
+//! Function to search for an assignment that satisfies every clause
+/*!
+ *  @param      SatSolver *     A pointer to the solver
+ *  @param      unsigned long long The number of conflicts to give up after, 0 to never give up
+ *
+ *  @returns    unsigned int    SAT_SATISFIABLE, SAT_UNSATISFIABLE or SAT_UNKNOWN
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every conflict is explained back to its first unique implication point and the clause
+ *        learned is kept. Decisions take the most active variable, and restarts follow the luby
+ *        sequence. Once satisfiable the assignment is kept until the solver is next changed.
+ */
+unsigned int RunSatSolver(SatSolver *solver, unsigned long long conflictlimit);
+
+//! Function to read a variable of a satisfying assignment
+/*!
+ *  @param      SatSolver *     A pointer to the solver after RunSatSolver found it satisfiable
+ *  @param      int             The variable
+ *
+ *  @returns    boolean         Whether the variable is true
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool SatValue(const SatSolver *solver, int variable);
+
+//! Function to add the rules of sudoku and the board so far to a sat solver
+/*!
+ *  @param      SatSolver *     A pointer to a solver with at least SAT_SUDOKUVARIABLES variables
+ *  @param      Sudoku*         A pointer to the sudoku object to encode
+ *
+ *  @returns    boolean         False if the clauses couldn't be added or the board has no solution
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every cell holds exactly one value and every row, column and box holds every value
+ *        exactly once. Placed values are added as units, as are the values ruled out of a cell
+ *        while the candidates are up to date. Variant rules can be added as further clauses
+ *        over SAT_VARIABLE before running the solver.
+ */
+bool EncodeSudoku(SatSolver *solver, Sudoku *sudoku);
+
+//! Function to place the values of a satisfying assignment on a sudoku
+/*!
+ *  @param      SatSolver *     A pointer to the solver after RunSatSolver found it satisfiable
+ *  @param      Sudoku*         A pointer to the sudoku object that was encoded
+ *
+ *  @returns    boolean         Whether every empty cell was given a value
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool DecodeSudoku(SatSolver *solver, Sudoku *sudoku);
+
+//! Function which solves a sudoku with the sat solver
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to solve, receives the solution
+ *
+ *  @returns    boolean         Whether the sudoku was solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The guess threshold and guess limit don't apply, the solver runs until it has an answer
+ */
+bool SolveSudokuSat(Sudoku *sudoku);
+
+#endif
@@ -1,4 +1,33 @@
 #include "SudokuSolver.h"
+#include "SudokuLearning.h"
+#include "SudokuSat.h"
+#include "SudokuPortfolio.h"
+#include "SudokuRestarts.h"
+#include "SudokuDispatch.h"
+#include "SudokuDecisions.h"
+
+//! Function to count the set bits of a candidate mask
+/*!
+ *  @param      unsigned int    The mask to count
+ *
+ *  @returns    unsigned int    The number of bits set in the mask
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only used by POPCOUNT when the compiler has no builtin
+ */
+unsigned int PopCount(unsigned int mask)
+{
+    unsigned int count = 0;
+
+    // clear the lowest set bit until there are none left
+    while (mask) {
+        mask &= mask - 1;
+        count++;
+    }
+
+    return count;
+}
 
 //! Function to create an initialize a new guess
 /*!
@@ -6,12 +35,13 @@
  *  @param      unsigned int    The y position of the new guess
  *  @param      unsigned int    The value of the new guess
  *  @param      unsigned int    The probability of the new guess
+ *  @param      SudokuAllocator * Where to allocate the guess, or NULL for the system allocator
  *
  *  @returns    Guess *         A pointer to the new guess object or NULL
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-Guess *CreateGuess(unsigned int X, unsigned int Y, unsigned int Value, unsigned int Probability)
+Guess *CreateGuess(unsigned int X, unsigned int Y, unsigned int Value, unsigned int Probability, const SudokuAllocator *allocator)
 {
     Guess *new_guess = NULL;
 
@@ -29,7 +59,7 @@ Guess *CreateGuess(unsigned int X, unsigned int Y, unsigned int Value, unsigned
     }
 
     // allocate our new guess
-    new_guess = (Guess*)calloc(1, sizeof(Guess));
+    new_guess = (Guess*)AllocateMemory(allocator, sizeof(Guess));
 
     // sanity our new guess
     if (!new_guess) {
@@ -49,12 +79,13 @@ Guess *CreateGuess(unsigned int X, unsigned int Y, unsigned int Value, unsigned
 //! Function to destroy an initialized new guess
 /*!
  *  @param      Guess *         A pointer to the guess object to destroy
+ *  @param      SudokuAllocator * The allocator the guess came from, or NULL for the system allocator
  *
  *  @returns    boolean         Whether the guess object was successfully destroyed
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-bool DestroyGuess(Guess *guess)
+bool DestroyGuess(Guess *guess, const SudokuAllocator *allocator)
 {
     // sanity
     if (!guess) {
@@ -62,20 +93,21 @@ bool DestroyGuess(Guess *guess)
     }
 
     // free it
-    free(guess);
+    FreeMemory(allocator, guess, sizeof(Guess));
 
     return true;
 }
 
-//! Function to initialize a new guess list
+//! Function to initialize a new guess list that gets its memory from an allocator
 /*!
  *  @param      Guesslist **    A pointer to a pointer that will receive the initialized guess list
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
  *
  *  @returns    boolean         Whether the guess list was initialized
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-bool InitializeGuessList(GuessList **list)
+bool InitializeGuessListWithAllocator(GuessList **list, const SudokuAllocator *allocator)
 {
     GuessList *new_list = NULL;
 
@@ -85,20 +117,37 @@ bool InitializeGuessList(GuessList **list)
     }
 
     // allocate memory for our guess list
-    new_list = (GuessList*)calloc(1, sizeof(GuessList));
+    new_list = (GuessList*)AllocateMemory(allocator, sizeof(GuessList));
 
     // sanity check our guess list
     if (!new_list) {
         return false;
     }
 
-    // zero out our new guess list
-    memset(new_list, 0, sizeof(GuessList));
+    // remember where our memory comes from
+    new_list->allocator = allocator;
+
+    // assign the guess list
+    *list = new_list;
 
     // success
     return true;
 }
 
+//! Function to initialize a new guess list
+/*!
+ *  @param      Guesslist **    A pointer to a pointer that will receive the initialized guess list
+ *
+ *  @returns    boolean         Whether the guess list was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeGuessList(GuessList **list)
+{
+    return InitializeGuessListWithAllocator(list, NULL);
+}
+
+
 //! Function to safely cleanup all guesses within a guess list without destroying the list
 /*!
  *  @param      GuessList *     A pointer ot the guess list to clean up
@@ -151,7 +200,7 @@ bool DestroyGuessList(GuessList *list)
     }
 
     // cleanup the list
-    free(list);
+    FreeMemory(list->allocator, list, sizeof(GuessList));
 
     // success
     return true;
@@ -173,6 +222,7 @@ bool AppendGuess(GuessList *list, unsigned int X, unsigned int Y, unsigned int V
 {
     unsigned int guesscount = 0;
     Guess *new_guess = NULL;
+    Guess **guesses = NULL;
 
     // sanity
     if (!list
@@ -184,7 +234,7 @@ bool AppendGuess(GuessList *list, unsigned int X, unsigned int Y, unsigned int V
     }
 
     // try to create our new guess
-    new_guess = CreateGuess(X, Y, Value, Probability);
+    new_guess = CreateGuess(X, Y, Value, Probability, list->allocator);
 
     // sanity check it
     if (!new_guess) {
@@ -195,13 +245,16 @@ bool AppendGuess(GuessList *list, unsigned int X, unsigned int Y, unsigned int V
     guesscount = list->count + 1;
 
     // realloc the array of guesses
-    list->guesses = (Guess**)realloc(list->guesses, guesscount * sizeof(Guess*));
+    guesses = (Guess**)ReallocateMemory(list->allocator, list->guesses, list->count * sizeof(Guess*), guesscount * sizeof(Guess*));
 
     // sanity the realloc
-    if (!list->guesses) {
+    if (!guesses) {
+        DestroyGuess(new_guess, list->allocator);
         return false;
     }
 
+    list->guesses = guesses;
+
     // insert our new guess
     list->guesses[list->count] = new_guess;
 
@@ -234,15 +287,16 @@ bool RemoveGuess(GuessList *list)
     guesscount = list->count - 1;
 
     // try to destroy the last guess
-    if (!DestroyGuess(list->guesses[guesscount])) {
+    if (!DestroyGuess(list->guesses[guesscount], list->allocator)) {
         return false;
     }
 
-    // realloc the array of guesses
-    list->guesses = (Guess**)realloc(list->guesses, guesscount * sizeof(Guess*));
+    // shrink the array of guesses, it's freed along with the last guess
+    list->guesses = (Guess**)ReallocateMemory(list->allocator, list->guesses, list->count * sizeof(Guess*), guesscount * sizeof(Guess*));
 
     // sanity the realloc
-    if (!list->guesses) {
+    if (guesscount
+        && !list->guesses) {
         return false;
     }
 
@@ -253,49 +307,137 @@ bool RemoveGuess(GuessList *list)
     return true;
 }
 
-//! Function to initialize a new sudoku
+//! Function to initialize a new sudoku that gets its memory from an allocator
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to initialize
  *  @param      float           The probabilty threshold required for a guess to be made
  *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
  *
  *  @returns    boolean         Returns true if successful
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The allocator must outlive the sudoku
  */
-bool InitializeSudoku(Sudoku **sudoku, unsigned int guessthreshold, unsigned int maxguesses)
+bool InitializeSudokuWithAllocator(Sudoku **sudoku, unsigned int guessthreshold, unsigned int maxguesses, const SudokuAllocator *allocator)
 {
+    Sudoku *new_sudoku = NULL;
+
     // sanity check
     if (!sudoku) {
         return false;
     }
 
     // allocate a new sudoku
-    Sudoku *new_sudoku = (Sudoku*)calloc(1, sizeof(Sudoku));
+    new_sudoku = (Sudoku*)AllocateMemory(allocator, sizeof(Sudoku));
 
     // sanity check our new sudoku
     if (!new_sudoku) {
         return false;
     }
 
-    // zero out the grid
-    memset(new_sudoku->grid, 0, sizeof(new_sudoku->grid));
+    // set it up
+    InitializeSudokuStorage(new_sudoku, guessthreshold, maxguesses);
+
+    // remember where our memory comes from
+    new_sudoku->allocator = allocator;
+
+    // assign the sudoku
+    *sudoku = new_sudoku;
+
+    // success
+    return true;
+}
+
+//! Function to initialize a new sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to initialize
+ *  @param      float           The probabilty threshold required for a guess to be made
+ *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeSudoku(Sudoku **sudoku, unsigned int guessthreshold, unsigned int maxguesses)
+{
+    return InitializeSudokuWithAllocator(sudoku, guessthreshold, maxguesses, NULL);
+}
+
+
+
+//! Function to initialize a sudoku in storage provided by the caller
+/*!
+ *  @param      Sudoku*         A pointer to the storage to initialize, on the stack or in an array
+ *  @param      float           The probabilty threshold required for a guess to be made
+ *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Nothing is allocated, a sudoku initialized this way must not be passed to DestroySudoku
+ */
+bool InitializeSudokuStorage(Sudoku *sudoku, unsigned int guessthreshold, unsigned int maxguesses)
+{
+    // sanity check
+    if (!sudoku) {
+        return false;
+    }
+
+    // zero out everything, the grid included
+    memset(sudoku, 0, sizeof(Sudoku));
 
     // assign the guess threshold
-    new_sudoku->threshold = guessthreshold;
+    sudoku->threshold = guessthreshold;
 
     // assign the max guess count
-    new_sudoku->maxguesscount = maxguesses;
+    sudoku->maxguesscount = maxguesses;
 
-    // if we're allowed to guess at all
-    if (maxguesses) {
-        
+    // search on a single thread unless told otherwise
+    sudoku->threads = 1;
+
+    // print our progress by default
+    sudoku->verbose = true;
+
+    // score guesses by probability
+    sudoku->scorer = ProbabilityScore;
+
+    return true;
+}
+
+//! Function to clear a sudoku so it can be reused for another puzzle
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to clear
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The settings and guess list are kept, only the board is cleared
+ */
+bool ResetSudoku(Sudoku *sudoku)
+{
+    // sanity check
+    if (!sudoku) {
+        return false;
     }
 
-    // assign the sudoku
-    *sudoku = new_sudoku;
+    // clear the grid
+    memset(sudoku->grid, 0, sizeof(sudoku->grid));
+    sudoku->contradiction = CONTRADICTION_NONE;
+    sudoku->hash = 0;
+
+    // the candidates and branch cell no longer match the grid
+    sudoku->candidatesvalid = false;
+    sudoku->branchvalid = false;
+
+    // forget any guesses from the last puzzle
+    if (sudoku->guesslist) {
+        EmptyGuessList(sudoku->guesslist);
+    }
 
-    // success
     return true;
 }
 
@@ -317,11 +459,54 @@ bool DestroySudoku(Sudoku *sudoku)
     // if we have a list of guesses
     if (sudoku->guesslist) {
         // free the guess list
-        free(sudoku->guesslist);
+        DestroyGuessList(sudoku->guesslist);
     }
         
     // erase our object
-    free(sudoku);
+    FreeMemory(sudoku->allocator, sudoku, sizeof(Sudoku));
+
+    return true;
+}
+
+//! Function to copy the board and settings of one sudoku into another
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object receiving the copy
+ *  @param      Sudoku*         A pointer to the sudoku object to copy
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The destination keeps its own guess list, allocator and verbosity
+ */
+bool CopySudoku(Sudoku *destination, Sudoku *source)
+{
+    GuessList *guesslist = NULL;
+    const SudokuAllocator *allocator = NULL;
+    bool verbose = false;
+
+    // sanity
+    if (!destination
+        || !source) {
+        return false;
+    }
+
+    // nothing to do when copying onto ourself
+    if (destination == source) {
+        return true;
+    }
+
+    // hang on to what the destination keeps
+    guesslist = destination->guesslist;
+    allocator = destination->allocator;
+    verbose = destination->verbose;
+
+    // copy the grid, candidates and settings in one go
+    *destination = *source;
+
+    destination->guesslist = guesslist;
+    destination->allocator = allocator;
+    destination->verbose = verbose;
 
     return true;
 }
@@ -345,35 +530,170 @@ void PrintSudoku(Sudoku *sudoku)
     // iterate cells and print borders/numbers
     for (i = 0; i < 9; ++i) {
         if(!i) { // top horizontal border
-            printf("\n     1 2 3   4 5 6   7 8 9\n");
-            printf("    _______________________\n\n");
+            SUDOKU_PRINTF("\n     1 2 3   4 5 6   7 8 9\n");
+            SUDOKU_PRINTF("    _______________________\n\n");
         }
 
         for (j = 0; j < 9; ++j) {
             if(!j) { // left vertical border
-                printf(" %d | ", i + 1);
+                SUDOKU_PRINTF(" %d | ", i + 1);
             }
 
             // print current number if not 0
             if (sudoku->grid[i][j]) {
-                printf("%d ", sudoku->grid[i][j]);
+                SUDOKU_PRINTF("%d ", sudoku->grid[i][j]);
             } else { //otherwise place a space
-                printf("  ");
+                SUDOKU_PRINTF("  ");
             }
 
             // all but left vertical border
             if (((j + 1) % 3) == 0) {
-                printf("| ");
+                SUDOKU_PRINTF("| ");
             }
         }
 
         // all but top horizontal border
         if (((i + 1) % 3) == 0) {
-            printf("\n    _______________________\n");
+            SUDOKU_PRINTF("\n    _______________________\n");
+        }
+
+        SUDOKU_PRINTF("\n");
+    }
+}
+
+//! Function to remove a value from the candidates of a cell and the place tables of its units
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      unsigned int    The cell from 0 - 80
+ *  @param      unsigned int    The value to remove from 1 - 9
+ *
+ *  @returns    boolean         Returns true if the value was a candidate
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Sets the contradiction of the sudoku if this leaves the cell or a unit with nowhere to go
+ */
+static bool RemoveCandidate(Sudoku *sudoku, unsigned int cell, unsigned int value)
+{
+    unsigned int row = CellRow[cell], column = CellColumn[cell], box = BOX_UNIT(CellBox[cell]);
+
+    // nothing to do if it's already gone
+    if (!(CELL_CANDIDATES(sudoku, cell) & VALUE_BIT(value))) {
+        return false;
+    }
+
+    CELL_CANDIDATES(sudoku, cell) &= ~VALUE_BIT(value);
+
+    // one less place for this value in each of our units
+    sudoku->places[ROW_UNIT(row)][value]--;
+    sudoku->places[COLUMN_UNIT(column)][value]--;
+    sudoku->places[box][value]--;
+    sudoku->placemasks[ROW_UNIT(row)][value] &= ~(1u << column);
+    sudoku->placemasks[COLUMN_UNIT(column)][value] &= ~(1u << row);
+    sudoku->placemasks[box][value] &= ~(1u << CellBoxIndex[cell]);
+
+    // an empty cell with nothing left, or a value with nowhere left in a unit that still needs it, is a dead end
+    if (!CELL_CANDIDATES(sudoku, cell)
+        && !CELL_VALUE(sudoku, cell)) {
+        sudoku->contradiction = CONTRADICTION_EMPTYCELL;
+    } else if ((!sudoku->places[ROW_UNIT(row)][value] && !(sudoku->unitvalues[ROW_UNIT(row)] & VALUE_BIT(value)))
+        || (!sudoku->places[COLUMN_UNIT(column)][value] && !(sudoku->unitvalues[COLUMN_UNIT(column)] & VALUE_BIT(value)))
+        || (!sudoku->places[box][value] && !(sudoku->unitvalues[box] & VALUE_BIT(value)))) {
+        sudoku->contradiction = CONTRADICTION_NOPLACE;
+    }
+
+    return true;
+}
+
+//! Function to rebuild the candidates and place tables of a sudoku from its grid
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The contradiction of the sudoku is worked out again from scratch
+ */
+static void RebuildCandidates(Sudoku *sudoku)
+{
+    unsigned int c = 0, v = 0, value = 0, mask = 0;
+    unsigned int row = 0, column = 0, box = 0;
+
+    memset(sudoku->unitvalues, 0, sizeof(sudoku->unitvalues));
+    memset(sudoku->unitempty, 0, sizeof(sudoku->unitempty));
+    memset(sudoku->places, 0, sizeof(sudoku->places));
+    memset(sudoku->placemasks, 0, sizeof(sudoku->placemasks));
+    sudoku->contradiction = CONTRADICTION_NONE;
+    sudoku->hash = 0;
+
+    // gather the values used and the empty cells of every unit
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        row = ROW_UNIT(CellRow[c]);
+        column = COLUMN_UNIT(CellColumn[c]);
+        box = BOX_UNIT(CellBox[c]);
+        value = CELL_VALUE(sudoku, c);
+
+        if (value) {
+            // a value used twice in a unit can never be solved
+            if ((sudoku->unitvalues[row] | sudoku->unitvalues[column] | sudoku->unitvalues[box]) & VALUE_BIT(value)) {
+                sudoku->contradiction = CONTRADICTION_DUPLICATE;
+            }
+
+            sudoku->unitvalues[row] |= VALUE_BIT(value);
+            sudoku->unitvalues[column] |= VALUE_BIT(value);
+            sudoku->unitvalues[box] |= VALUE_BIT(value);
+            sudoku->hash ^= ZobristKeys[c][value];
+        } else {
+            sudoku->unitempty[row]++;
+            sudoku->unitempty[column]++;
+            sudoku->unitempty[box]++;
+        }
+    }
+
+    // anything not used by a cell's units is a candidate and a place for that value
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        row = ROW_UNIT(CellRow[c]);
+        column = COLUMN_UNIT(CellColumn[c]);
+        box = BOX_UNIT(CellBox[c]);
+
+        mask = 0;
+
+        if (!CELL_VALUE(sudoku, c)) {
+            mask = ALL_VALUES & ~(sudoku->unitvalues[row] | sudoku->unitvalues[column] | sudoku->unitvalues[box]);
+        }
+
+        CELL_CANDIDATES(sudoku, c) = (unsigned short)mask;
+
+        // an empty cell with nothing that fits
+        if (!mask
+            && !CELL_VALUE(sudoku, c)
+            && !sudoku->contradiction) {
+            sudoku->contradiction = CONTRADICTION_EMPTYCELL;
         }
 
-        printf("\n");
+        for (v = 1; mask; ++v, mask >>= 1) {
+            if (mask & 1) {
+                sudoku->places[row][v]++;
+                sudoku->places[column][v]++;
+                sudoku->places[box][v]++;
+                sudoku->placemasks[row][v] |= (1u << CellColumn[c]);
+                sudoku->placemasks[column][v] |= (1u << CellRow[c]);
+                sudoku->placemasks[box][v] |= (1u << CellBoxIndex[c]);
+            }
+        }
+    }
+
+    // a value with nowhere to go in a unit that still needs it
+    for (c = 0; c < SUDOKU_UNITS && !sudoku->contradiction; ++c) {
+        for (v = 1; v < 10; ++v) {
+            if (!sudoku->places[c][v]
+                && !(sudoku->unitvalues[c] & VALUE_BIT(v))) {
+                sudoku->contradiction = CONTRADICTION_NOPLACE;
+                break;
+            }
+        }
     }
+
+    sudoku->candidatesvalid = true;
 }
 
 //! Function to place a number at a specific location in a sudoku
@@ -392,6 +712,8 @@ void PrintSudoku(Sudoku *sudoku)
  */
 bool PlaceNumber(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value)
 {
+    unsigned int i = 0, cell = 0, mask = 0;
+
     // sanity check
     if (!sudoku 
         || Y > 8
@@ -401,13 +723,119 @@ bool PlaceNumber(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int va
             return false;
     }
 
-    // assign the value
-    sudoku->grid[Y][X] = value;
+    cell = CELL(X, Y);
+
+    TRACE_EVENT(TRACE_PLACE, cell, value, 0);
+    DECISION_EVENT(DECISION_PLACE, cell, value, 0, 0);
+
+    // a legal placement in an empty cell keeps our tables up to date, anything else rebuilds them later
+    if (sudoku->candidatesvalid
+        && (sudoku->candidates[Y][X] & VALUE_BIT(value))) {
+        // assign the value and mark it used in each of our units first,
+        // so the removals below only flag contradictions that really are
+        sudoku->grid[Y][X] = value;
+        sudoku->hash ^= ZobristKeys[cell][value];
+        sudoku->unitvalues[ROW_UNIT(Y)] |= VALUE_BIT(value);
+        sudoku->unitvalues[COLUMN_UNIT(X)] |= VALUE_BIT(value);
+        sudoku->unitvalues[BOX_UNIT(CellBox[cell])] |= VALUE_BIT(value);
+        sudoku->unitempty[ROW_UNIT(Y)]--;
+        sudoku->unitempty[COLUMN_UNIT(X)]--;
+        sudoku->unitempty[BOX_UNIT(CellBox[cell])]--;
+
+        // this cell takes nothing else
+        for (mask = sudoku->candidates[Y][X]; mask; mask &= mask - 1) {
+            RemoveCandidate(sudoku, cell, LOWBIT(mask) + 1);
+        }
+
+        // and nothing sharing a unit with it takes this value
+        for (i = 0; i < SUDOKU_PEERS; ++i) {
+            RemoveCandidate(sudoku, CellPeers[cell][i], value);
+        }
+    } else {
+        // assign the value
+        sudoku->grid[Y][X] = value;
+        sudoku->candidatesvalid = false;
+    }
+
+    // our most constrained cell may have changed
+    sudoku->branchvalid = false;
 
     // success
     return true;
 }
 
+//! Function to empty a cell, taking back the number placed in it
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      unsigned int    The x position of the cell to empty from 0 - 8
+ *  @param      unsigned int    The y position of the cell to empty from 0 - 8
+ *
+ *  @returns    boolean         Returns true if the cell held a number
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Any candidate removed because of the number may be back, so the candidates
+ *        are rebuilt from the grid when next needed and eliminations are lost
+ */
+bool UnplaceNumber(Sudoku *sudoku, unsigned int X, unsigned int Y)
+{
+    // sanity check
+    if (!sudoku 
+        || Y > 8
+        || X > 8) {
+            return false;
+    }
+
+    // nothing to take back from an empty cell
+    if (!sudoku->grid[Y][X]) {
+        return false;
+    }
+
+    sudoku->grid[Y][X] = 0;
+
+    // the number may be a candidate again anywhere it was seen from
+    sudoku->candidatesvalid = false;
+    sudoku->branchvalid = false;
+
+    return true;
+}
+
+//! Function to remove a value from the candidates of a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      unsigned int    The x position of the cell from 0 - 8
+ *  @param      unsigned int    The y position of the cell from 0 - 8
+ *  @param      unsigned int    The value to remove from 1 - 9
+ *
+ *  @returns    boolean         Returns true if the value was a candidate and has been removed
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool EliminateCandidate(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value)
+{
+    // sanity check
+    if (!sudoku 
+        || Y > 8
+        || X > 8
+        || value > 9
+        || value == 0) {
+            return false;
+    }
+
+    // make sure our candidates match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    // our most constrained cell may have changed
+    sudoku->branchvalid = false;
+
+    TRACE_EVENT(TRACE_ELIMINATE, CELL(X, Y), value, 0);
+
+    return RemoveCandidate(sudoku, CELL(X, Y), value);
+}
+
+
 //! Function to check if a specific cell is free or not
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object
@@ -451,29 +879,16 @@ bool CanPlaceNumber(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int
             return false;
     }
 
-    // make sure the cell is empty
-    if (!IsCellEmpty(sudoku, X, Y)) {
-        return false;
+    // make sure our candidates match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
     }
 
-    // check row
-    if (IsNumberInRow(sudoku, Y, value)) {
-        return false;
-    }
+    // anything still a candidate can be placed
+    return (sudoku->candidates[Y][X] & VALUE_BIT(value)) != 0;
+}
 
-    // check column
-    if (IsNumberInColumn(sudoku, X, value)) {
-        return false;
-    }
-    
-    // check box
-    if (IsNumberInBox(sudoku, X, Y, value)) {
-        return false;
-    }
 
-    // we can place a number here
-    return true;
-}
 
 //! Function to determine if a number is within a specific row
 /*!
@@ -554,8 +969,8 @@ bool IsNumberInColumn(Sudoku *sudoku, unsigned int X, unsigned int value)
  */
 bool IsNumberInBox(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value)
 {
-    // the top left cell of this box
-    unsigned int boxX, boxY = 0, i = 0, j = 0;
+    const unsigned char *cells = NULL;
+    unsigned int i = 0;
 
     // sanity check
     if (!sudoku 
@@ -566,22 +981,40 @@ bool IsNumberInBox(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int
             return false;
     }
 
-    // grab the top left cell of this box
-    boxX = X - (X % 3);
-    boxY = Y - (Y % 3);
+    // grab the cells of this box
+    cells = UnitCells[BOX_UNIT(CellBox[CELL(X, Y)])];
 
     // check this box
-    for (i = 0; i < 3; ++i) {
-        for (j = 0; j < 3; ++j) {
-            if (sudoku->grid[boxY + i][boxX + j] == value) {
-                return true;
-            }
+    for (i = 0; i < 9; ++i) {
+        if (CELL_VALUE(sudoku, cells[i]) == value) {
+            return true;
         }
     }
 
     return false;
 }
 
+
+//! Function to gather the values used within a unit
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      unsigned int    The unit to check from 0 - 26
+ *
+ *  @returns    unsigned int    A mask with bit v - 1 set for each value v within the unit
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int UnitMask(Sudoku *sudoku, unsigned int unit)
+{
+    // make sure our tables match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    return sudoku->unitvalues[unit];
+}
+
+
 //! Function to determine if a row contains all numbers from 1 to 9
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object
@@ -593,24 +1026,17 @@ bool IsNumberInBox(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int
  */
 bool IsRowComplete(Sudoku *sudoku, unsigned int Y)
 {
-    unsigned int i = 0;
-    
     // sanity check
     if (!sudoku 
         || Y > 8) {
             return false;
     }
 
-    // find each number in this row
-    for (i = 1; i < 10; ++i) {
-        if (!IsNumberInRow(sudoku, Y, i)) {
-            return false;
-        }
-    }
-
-    return true;
+    // every number must be in this row
+    return (UnitMask(sudoku, ROW_UNIT(Y)) == ALL_VALUES);
 }
 
+
 //! Function to determine if a column contains all numbers from 1 to 9
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object
@@ -622,24 +1048,17 @@ bool IsRowComplete(Sudoku *sudoku, unsigned int Y)
  */
 bool IsColumnComplete(Sudoku *sudoku, unsigned int X)
 {
-    unsigned int i = 0;
-    
     // sanity check
     if (!sudoku 
         || X > 8) {
             return false;
     }
 
-    // find each number in this column
-    for (i = 1; i < 10; ++i) {
-        if (!IsNumberInColumn(sudoku, X, i)) {
-            return false;
-        }
-    }
-
-    return true;
+    // every number must be in this column
+    return (UnitMask(sudoku, COLUMN_UNIT(X)) == ALL_VALUES);
 }
 
+
 //! Function to determine if a 3x3 box contains all numbers from 1 to 9
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object
@@ -652,8 +1071,6 @@ bool IsColumnComplete(Sudoku *sudoku, unsigned int X)
  */
 bool IsBoxComplete(Sudoku *sudoku, unsigned int X, unsigned int Y)
 {
-    unsigned int i = 0;
-
     // sanity check
     if (!sudoku 
         || X > 8
@@ -661,16 +1078,11 @@ bool IsBoxComplete(Sudoku *sudoku, unsigned int X, unsigned int Y)
             return false;
     }
     
-    // find each number in this box
-    for (i = 1; i < 10; ++i) {
-        if (!IsNumberInBox(sudoku, X, Y, i)) {
-            return false;
-        }
-    }
-
-    return true;
+    // every number must be in this box
+    return (UnitMask(sudoku, BOX_UNIT(CellBox[CELL(X, Y)])) == ALL_VALUES);
 }
 
+
 //! Function to determine the specified sudoku contains 1 to 9 in each column, row and box
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to check for completion
@@ -681,7 +1093,7 @@ bool IsBoxComplete(Sudoku *sudoku, unsigned int X, unsigned int Y)
  */
 bool IsSudokuComplete(Sudoku *sudoku)
 {
-    unsigned int i = 0;
+    unsigned int u = 0;
     
     // sanity check
     if (!sudoku) {
@@ -689,26 +1101,101 @@ bool IsSudokuComplete(Sudoku *sudoku)
     }
 
     // find each number in each row, column and box
-    for (i = 0; i < 9; ++i) {
-        // check each row
-        if (!IsRowComplete(sudoku, i)) {
+    for (u = 0; u < SUDOKU_UNITS; ++u) {
+        if (UnitMask(sudoku, u) != ALL_VALUES) {
             return false;
         }
+    }
 
-        // check each column
-        if (!IsColumnComplete(sudoku, i)) {
-            return false;
-        }
+    return true;
+}
 
-        // check each box
-        if (!IsBoxComplete(sudoku, BOX_X(i), BOX_Y(i))) {
-            return false;
-        }
+//! Function to get the Zobrist hash of the grid of a sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @returns    unsigned long long The xor of the ZobristKeys of every value in the grid
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The hash is kept up to date by each placement along with the candidates
+ */
+unsigned long long HashSudoku(Sudoku *sudoku)
+{
+    // sanity check
+    if (!sudoku) {
+        return 0;
     }
 
-    return true;
+    // make sure our hash matches the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    return sudoku->hash;
+}
+
+//! Function to count the empty cells of a sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @returns    unsigned int    The number of empty cells
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int CountEmptyCells(Sudoku *sudoku)
+{
+    unsigned int y = 0, empty = 0;
+
+    // sanity check
+    if (!sudoku) {
+        return 0;
+    }
+
+    // make sure our tables match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    for (y = 0; y < 9; ++y) {
+        empty += sudoku->unitempty[ROW_UNIT(y)];
+    }
+
+    return empty;
+}
+
+
+//! Function which determines the probability that a number is correct based on a unit
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *  @param      unsigned int    The unit containing the cell from 0 - 26
+ *  @param      unsigned int    The cell to test from 0 - 80
+ *  @param      unsigned int    The value to test in the cell
+ *
+ *  @returns    unsigned int    The probability from 0 to 100 that the given number is correct
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int UnitProbability(Sudoku *sudoku, unsigned int unit, unsigned int cell, unsigned int value)
+{
+    unsigned int places = 0;
+
+    // make sure our place tables match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    // the places within this unit we can place the number, counting this cell whether it fits or not
+    places = sudoku->places[unit][value];
+
+    if (!(CELL_CANDIDATES(sudoku, cell) & VALUE_BIT(value))) {
+        places++;
+    }
+
+    return 100 / places;
 }
 
+
 //! Function which determines the probability that a number is correct based on the 3x3 box
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -724,8 +1211,6 @@ bool IsSudokuComplete(Sudoku *sudoku)
  */
 unsigned int BoxProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value)
 {
-    unsigned int x = 0, y = 0, places = 0, box_x_start = 0, box_x_end = 0, box_y_start = 0, box_y_end = 0;
-
     // sanity check
     if (!sudoku 
         || Y > 8
@@ -735,32 +1220,10 @@ unsigned int BoxProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsi
             return 0;
     }
 
-    // the amount of places within this box we can place the number
-    places = 1;
-    
-    box_x_start = (X - (X % 3));
-    box_x_end = ((X - (X % 3)) + 3);
-    box_y_start = (Y - (Y % 3));
-    box_y_end = ((Y - (Y % 3)) + 3);
-
-    // iterate each cell within this box vertically
-    for (y = box_y_start; y < box_y_end; ++y) {
-        // iterate each cell within this box horizontally
-        for (x = box_x_start; x < box_x_end; ++x) {
-            // if this isn't the cell we're originally trying to place a number in
-            if (x != X || y != Y) {
-                // can we place a number in this cell
-                if (CanPlaceNumber(sudoku, x, y, value)) {
-                    // we can place the number in this other box
-                    places++;
-                }
-            }
-        }
-    }
-
-    return 100 / places;
+    return UnitProbability(sudoku, BOX_UNIT(CellBox[CELL(X, Y)]), CELL(X, Y), value);
 }
 
+
 //! Function which determines the probability that a number is correct based on the 1x9 row
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -776,8 +1239,6 @@ unsigned int BoxProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsi
  */
 unsigned int RowProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value)
 {
-    unsigned int x = 0, places = 0;
-
     // sanity check
     if (!sudoku 
         || Y > 8
@@ -787,24 +1248,10 @@ unsigned int RowProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsi
             return 0;
     }
 
-    // the amount of places within this box we can place the number
-    places = 1;
-
-    // iterate each cell within this row horizontally
-    for (x = 0; x < 9; ++x) {
-        // if this isn't the cell we're originally trying to place a number in
-        if (x != X) {
-            // can we place a number in this cell
-            if (CanPlaceNumber(sudoku, x, Y, value)) {
-                // we can place the number in this other box
-                places++;
-            }
-        }
-    }
-
-    return 100 / places;
+    return UnitProbability(sudoku, ROW_UNIT(Y), CELL(X, Y), value);
 }
 
+
 //! Function which determines the probability that a number is correct based on the 1x9 column
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -820,8 +1267,6 @@ unsigned int RowProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsi
  */
 unsigned int ColumnProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value)
 {
-    unsigned int y = 0, places = 0;
-
     // sanity check
     if (!sudoku 
         || Y > 8
@@ -831,24 +1276,10 @@ unsigned int ColumnProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, u
             return 0;
     }
 
-    // the amount of places within this box we can place the number
-    places = 1;
-
-    // iterate each cell within this row horizontally
-    for (y = 0; y < 9; ++y) {
-        // if this isn't the cell we're originally trying to place a number in
-        if (y != Y) {
-            // can we place a number in this cell
-            if (CanPlaceNumber(sudoku, X, y, value)) {
-                // we can place the number in this other box
-                places++;
-            }
-        }
-    }
-
-    return 100 / places;
+    return UnitProbability(sudoku, COLUMN_UNIT(X), CELL(X, Y), value);
 }
 
+
 //! Function which determines the max probability of a correct guess in a cell
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -887,6 +1318,150 @@ unsigned int MaxProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsi
     return max_probability;
 }
 
+//! Function which finds the most constrained cell, optionally placing single candidates
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to scan
+ *  @param      boolean         Whether cells with a single candidate should be placed
+ *
+ *  @returns    unsigned int    The number of cells that were placed
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The most constrained cell is chosen by popcount, ties go to the cell
+ *        with the most empty cells in its row, column and box
+ */
+static unsigned int ScanCandidates(Sudoku *sudoku, bool place)
+{
+    unsigned int c = 0, x = 0, y = 0, v = 0, count = 0, degree = 0, best_degree = 0;
+    unsigned int solvednumbers = 0;
+
+    // make sure our candidates match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    // no cell found yet
+    sudoku->branchcount = 10;
+
+    // look at the candidates of every empty cell, there's no point going on once the board is dead
+    for (c = 0; c < SUDOKU_CELLS && !sudoku->contradiction; ++c) {
+        if (CELL_VALUE(sudoku, c)) {
+            continue;
+        }
+
+        y = CellRow[c];
+        x = CellColumn[c];
+        count = POPCOUNT(sudoku->candidates[y][x]);
+
+        // place a single candidate straight away
+        if (place
+            && count == 1) {
+            v = LOWBIT(sudoku->candidates[y][x]) + 1;
+
+            PlaceNumber(sudoku, x, y, v);
+            solvednumbers++;
+            continue;
+        }
+
+        // the more empty cells we share units with the more a guess here decides
+        degree = sudoku->unitempty[ROW_UNIT(y)] + sudoku->unitempty[COLUMN_UNIT(x)] + sudoku->unitempty[BOX_UNIT(CellBox[c])];
+
+        // keep the cell with the fewest candidates
+        if (count < sudoku->branchcount
+            || (count == sudoku->branchcount && degree > best_degree)) {
+            sudoku->branchx = x;
+            sudoku->branchy = y;
+            sudoku->branchcount = count;
+            best_degree = degree;
+        }
+    }
+
+    // a dead board has nowhere worth guessing
+    if (sudoku->contradiction) {
+        sudoku->branchcount = 0;
+    }
+
+    // anything we placed may have changed the cells before it
+    sudoku->branchvalid = (solvednumbers == 0);
+
+    return solvednumbers;
+}
+
+
+//! Function which attempts to solve the cells of the sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *
+ *  @returns    unsigned int    The number of cells that were correctly solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This function places every cell left with a single candidate and in the
+ *        same pass records the candidates and the most constrained cell
+ */
+unsigned int SolveCells(Sudoku *sudoku)
+{
+    unsigned int solvednumbers = 0;
+
+    // sanity
+    if (!sudoku) {
+        return 0;
+    }
+
+    solvednumbers = ScanCandidates(sudoku, true);
+
+    if (solvednumbers != 0) {
+        TRACE_EVENT(TRACE_TECHNIQUE, 0, solvednumbers, TECHNIQUE_CELLS);
+    }
+
+    // if we solved any numbers
+    if(solvednumbers != 0 && sudoku->verbose) {
+        // notify of how many numbers we solved
+        SUDOKU_PRINTF("Cell-Solved %d numbers\n", solvednumbers);
+    }
+
+    return solvednumbers;
+}
+
+//! Function which places every number that has only one place left within a unit
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *  @param      unsigned int    The unit to solve from 0 - 26
+ *
+ *  @returns    unsigned int    The number of cells that were correctly solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int SolveUnit(Sudoku *sudoku, unsigned int unit)
+{
+    unsigned int v = 0, cell = 0;
+    unsigned int solvednumbers = 0;
+
+    // make sure our place tables match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    // make sure this unit isn't completed yet
+    if (sudoku->unitvalues[unit] == ALL_VALUES) {
+        return 0;
+    }
+
+    // any value with a single place left in this unit must go there
+    for (v = 1; v < 10 && !sudoku->contradiction; ++v) {
+        if (sudoku->places[unit][v] == 1) {
+            cell = UnitCells[unit][LOWBIT(sudoku->placemasks[unit][v])];
+
+            // put our new number here
+            PlaceNumber(sudoku, CellColumn[cell], CellRow[cell], v);
+            solvednumbers++;
+        }
+    }
+
+    return solvednumbers;
+}
+
+
 //! Function which attempts to solve the boxes of the sudoku
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -900,7 +1475,7 @@ unsigned int MaxProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsi
  */
 unsigned int SolveBoxes(Sudoku *sudoku)
 {
-    unsigned int b = 0, y = 0, x = 0, v = 0;
+    unsigned int i = 0;
     unsigned int solvednumbers = 0;
 
     // sanity
@@ -909,42 +1484,24 @@ unsigned int SolveBoxes(Sudoku *sudoku)
     }
 
     // iterate each box
-    for (b = 0; b < 9; ++b) {
-        // make sure this box isn't completed yet
-        if (!IsBoxComplete(sudoku, BOX_X(b), BOX_Y(b))) {
-            // iterate vertically
-            for (y = BOX_Y(b); y < (BOX_Y(b) + 3); ++y) {
-                // iterate horizontally
-                for (x = BOX_X(b); x < (BOX_X(b) + 3); ++x) {
-                    // if this cell is empty
-                    if (IsCellEmpty(sudoku, x, y)) {
-                        // iterate values
-                        for (v = 1; v < 10; ++v) {
-                            // if we can place a number here, check every other cell in this box
-                            if (CanPlaceNumber(sudoku, x, y, v)) {
-                                // if we didn't discover any other places in this box that the number can be placed
-                                if (BoxProbability(sudoku, x, y, v) == 100) {
-                                    // put our new number here
-                                    PlaceNumber(sudoku, x, y, v);
-                                    solvednumbers++;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    for (i = 0; i < 9 && !sudoku->contradiction; ++i) {
+        solvednumbers += SolveUnit(sudoku, BOX_UNIT(i));
+    }
+
+    if (solvednumbers != 0) {
+        TRACE_EVENT(TRACE_TECHNIQUE, 0, solvednumbers, TECHNIQUE_BOXES);
     }
 
     // if we solved any numbers
-    if(solvednumbers != 0) {
+    if(solvednumbers != 0 && sudoku->verbose) {
         // notify of how many numbers we solved
-        printf("Box-Solved %d numbers\n", solvednumbers);
+        SUDOKU_PRINTF("Box-Solved %d numbers\n", solvednumbers);
     }
 
     return solvednumbers;
 }
 
+
 //! Function which attempts to solve the rows of the sudoku
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -958,7 +1515,7 @@ unsigned int SolveBoxes(Sudoku *sudoku)
  */
 unsigned int SolveRows(Sudoku *sudoku)
 {
-    unsigned int y = 0, x = 0, v = 0;
+    unsigned int i = 0;
     unsigned int solvednumbers = 0;
 
     // sanity
@@ -967,39 +1524,24 @@ unsigned int SolveRows(Sudoku *sudoku)
     }
 
     // iterate each row
-    for (y = 0; y < 9; ++y) {
-        // make sure this row isn't completed yet
-        if (!IsRowComplete(sudoku, y)) {
-            // iterate horizontally
-            for (x = 0; x < 9; ++x) {
-                // if this cell is empty
-                if (IsCellEmpty(sudoku, x, y)) {
-                    // iterate values
-                    for (v = 1; v < 10; ++v) {
-                        // if we can place a number here, check every other cell in this row
-                        if (CanPlaceNumber(sudoku, x, y, v)) {
-                            // if we didn't discover any other places in this row that the number can be placed
-                            if (RowProbability(sudoku, x, y, v) == 100) {
-                                // put our new number here
-                                PlaceNumber(sudoku, x, y, v);
-                                solvednumbers++;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    for (i = 0; i < 9 && !sudoku->contradiction; ++i) {
+        solvednumbers += SolveUnit(sudoku, ROW_UNIT(i));
+    }
+
+    if (solvednumbers != 0) {
+        TRACE_EVENT(TRACE_TECHNIQUE, 0, solvednumbers, TECHNIQUE_ROWS);
     }
 
     // if we solved any numbers
-    if(solvednumbers != 0) {
+    if(solvednumbers != 0 && sudoku->verbose) {
         // notify of how many numbers we solved
-        printf("Row-Solved %d numbers\n", solvednumbers);
+        SUDOKU_PRINTF("Row-Solved %d numbers\n", solvednumbers);
     }
 
     return solvednumbers;
 }
 
+
 //! Function which attempts to solve the columns of the sudoku
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -1013,7 +1555,7 @@ unsigned int SolveRows(Sudoku *sudoku)
  */
 unsigned int SolveColumns(Sudoku *sudoku)
 {
-    unsigned int y = 0, x = 0, v = 0;
+    unsigned int i = 0;
     unsigned int solvednumbers = 0;
 
     // sanity
@@ -1022,107 +1564,80 @@ unsigned int SolveColumns(Sudoku *sudoku)
     }
 
     // iterate each column
-    for (x = 0; x < 9; ++x) {
-        // make sure this column isn't completed yet
-        if (!IsColumnComplete(sudoku, x)) {
-            // iterate vertically
-            for (y = 0; y < 9; ++y) {
-                // if this cell is empty
-                if (IsCellEmpty(sudoku, x, y)) {
-                    // iterate values
-                    for (v = 1; v < 10; ++v) {
-                        // if we can place a number here, check every other cell in this column
-                        if (CanPlaceNumber(sudoku, x, y, v)) {
-                            // if we didn't discover any other places in this column that the number can be placed
-                            if (ColumnProbability(sudoku, x, y, v) == 100) {
-                                // put our new number here
-                                PlaceNumber(sudoku, x, y, v);
-                                solvednumbers++;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    for (i = 0; i < 9 && !sudoku->contradiction; ++i) {
+        solvednumbers += SolveUnit(sudoku, COLUMN_UNIT(i));
+    }
+
+    if (solvednumbers != 0) {
+        TRACE_EVENT(TRACE_TECHNIQUE, 0, solvednumbers, TECHNIQUE_COLUMNS);
     }
 
     // if we solved any numbers
-    if(solvednumbers != 0) {
+    if(solvednumbers != 0 && sudoku->verbose) {
         // notify of how many numbers we solved
-        printf("Column-Solved %d numbers\n", solvednumbers);
+        SUDOKU_PRINTF("Column-Solved %d numbers\n", solvednumbers);
     }
 
     return solvednumbers;
 }
 
-//! Function which attempts to find the best guesses within a box with a probability above threshold
+
+//! Function which attempts to find the best guesses within a unit with a probability above threshold
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to search
  *  @param      unsigned int    The minimum threshold to pass for a guess (0 to 100)
- *  @param      unsigned int    The x position of a cell within the box to check
- *  @param      unsigned int    The y position of a cell within the box to check
+ *  @param      unsigned int    The unit to check from 0 - 26
  *  @param      SudokuGuess *    A pointer to a guess list that will receive all the best guesses
  *
  *  @returns    boolean         Returns true if a possible guess was found, false if nothing was found
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-bool FindBestGuessesBox(Sudoku *sudoku, unsigned int threshold, unsigned int X, unsigned int Y, GuessList *list)
+static bool FindBestGuessesUnit(Sudoku *sudoku, unsigned int threshold, unsigned int unit, GuessList *list)
 {
-    unsigned int x = 0, y = 0, v = 0, box_x_start = 0, box_x_end = 0, box_y_start = 0, box_y_end = 0, max_probability = 0, probability = 0;
+    unsigned int i = 0, v = 0, cell = 0, max_probability = 0, probability = 0;
     bool complete_iteration = false;
 
-    // sanity check
-    if (!sudoku
-        || !list
-        || X > 8
-        || Y > 8) {
-            return false;
-    }
-
     // ensure threshold is within 100, not really necessary
     if (threshold > 100) {
         threshold = 100;
     }
 
-    // grab the bounds of this 3x3 box
-    box_x_start = (X - (X % 3));
-    box_x_end = ((X - (X % 3)) + 3);
-    box_y_start = (Y - (Y % 3));
-    box_y_end = ((Y - (Y % 3)) + 3);
-
     // This label is used to iterate all cells twice, first to find the highest probability
     // the second time to store all guesses with the highest probability
 REITERATE:
 
-    // iterate each cell within this box vertically
-    for (y = box_y_start; y < box_y_end; ++y) {
-        // iterate each cell within this box horizontally
-        for (x = box_x_start; x < box_x_end; ++x) {
-            // if this cell is empty
-            if (IsCellEmpty(sudoku, x, y)) {
-                // iterate all values
-                for (v = 0; v < 9; ++v) {
-                    // grab the probability of this cell
-                    probability = BoxProbability(sudoku, x, y, v);
-
-                    // ensure our probability meets our threshold
-                    if (probability >= threshold) {
-                        // if this is the second iteration
-                        if (complete_iteration) {
-                            // if this probability is = to the max
-                            if (probability == max_probability) {
-                                // attempt to append this new guess to the list
-                                if (!AppendGuess(list, x, y, v, probability)) {
-                                    return false;
-                                }
-                            }
-                        } else { // if this is the first iteration
-                            // determine the maxmimum probability out of all cells
-                            if (probability > max_probability) {
-                                max_probability = probability;
+    // iterate each cell within this unit
+    for (i = 0; i < 9; ++i) {
+        cell = UnitCells[unit][i];
+
+        // if this cell is empty
+        if (!CELL_VALUE(sudoku, cell)) {
+            // iterate all values that fit here
+            for (v = 1; v < 10; ++v) {
+                if (!CanPlaceNumber(sudoku, CellColumn[cell], CellRow[cell], v)) {
+                    continue;
+                }
+
+                // grab the probability of this cell
+                probability = UnitProbability(sudoku, unit, cell, v);
+
+                // ensure our probability meets our threshold
+                if (probability >= threshold) {
+                    // if this is the second iteration
+                    if (complete_iteration) {
+                        // if this probability is = to the max
+                        if (probability == max_probability) {
+                            // attempt to append this new guess to the list
+                            if (!AppendGuess(list, CellColumn[cell], CellRow[cell], v, probability)) {
+                                return false;
                             }
                         }
+                    } else { // if this is the first iteration
+                        // determine the maxmimum probability out of all cells
+                        if (probability > max_probability) {
+                            max_probability = probability;
+                        }
                     }
                 }
             }
@@ -1140,82 +1655,56 @@ REITERATE:
     return (list->count > 0);
 }
 
-//! Function which attempts to find the best guesses within a row with a probability above threshold
+//! Function which attempts to find the best guesses within a box with a probability above threshold
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to search
  *  @param      unsigned int    The minimum threshold to pass for a guess (0 to 100)
- *  @param      unsigned int    The y position of the row to check
+ *  @param      unsigned int    The x position of a cell within the box to check
+ *  @param      unsigned int    The y position of a cell within the box to check
  *  @param      SudokuGuess *    A pointer to a guess list that will receive all the best guesses
  *
  *  @returns    boolean         Returns true if a possible guess was found, false if nothing was found
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-bool FindBestGuessesRow(Sudoku *sudoku, unsigned int threshold, unsigned int Y, GuessList *list)
+bool FindBestGuessesBox(Sudoku *sudoku, unsigned int threshold, unsigned int X, unsigned int Y, GuessList *list)
 {
-    unsigned int x = 0, v = 0, max_probability = 0, probability = 0;
-    bool complete_iteration = false;
-
     // sanity check
     if (!sudoku
         || !list
+        || X > 8
         || Y > 8) {
             return false;
     }
 
-    // ensure threshold is within 100, not really necessary
-    if (threshold > 100) {
-        threshold = 100;
-    }
-
-    // This label is used to iterate all cells twice, first to find the highest probability
-    // the second time to store all guesses with the highest probability
-REITERATE:
+    return FindBestGuessesUnit(sudoku, threshold, BOX_UNIT(CellBox[CELL(X, Y)]), list);
+}
 
 
-    // iterate each cell within this row horizontally
-    for (x = 0; x < 9; ++x) {
-        // if this cell is empty
-        if (IsCellEmpty(sudoku, x, Y)) {
-            // iterate all values
-            for (v = 0; v < 9; ++v) {
-                // grab the probability of this cell
-                probability = RowProbability(sudoku, x, Y, v);
-
-                // ensure our probability meets our threshold
-                if (probability >= threshold) {
-                    // if this is the second iteration
-                    if (complete_iteration) {
-                        // if this probability is = to the max
-                        if (probability == max_probability) {
-                            // attempt to append this new guess to the list
-                            if (!AppendGuess(list, x, Y, v, probability)) {
-                                return false;
-                            }
-                        }
-                    } else { // if this is the first iteration
-                        // determine the maxmimum probability out of all cells
-                        if (probability > max_probability) {
-                            max_probability = probability;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-
-    // if we completed a full iteration to determine the highest probability
-    if (!complete_iteration) {
-        // go back and iterate again this time storing all guesses with probability == to the highest
-        complete_iteration = true;
-        goto REITERATE;
+//! Function which attempts to find the best guesses within a row with a probability above threshold
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The minimum threshold to pass for a guess (0 to 100)
+ *  @param      unsigned int    The y position of the row to check
+ *  @param      SudokuGuess *    A pointer to a guess list that will receive all the best guesses
+ *
+ *  @returns    boolean         Returns true if a possible guess was found, false if nothing was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool FindBestGuessesRow(Sudoku *sudoku, unsigned int threshold, unsigned int Y, GuessList *list)
+{
+    // sanity check
+    if (!sudoku
+        || !list
+        || Y > 8) {
+            return false;
     }
 
-    // success
-    return (list->count > 0);
+    return FindBestGuessesUnit(sudoku, threshold, ROW_UNIT(Y), list);
 }
 
+
 //! Function which attempts to find the best guesses within a column with a probability above threshold
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to search
@@ -1229,9 +1718,6 @@ REITERATE:
  */
 bool FindBestGuessesColumn(Sudoku *sudoku, unsigned int threshold, unsigned int X, GuessList *list)
 {
-    unsigned int y = 0, v = 0, max_probability = 0, probability = 0;
-    bool complete_iteration = false;
-
     // sanity check
     if (!sudoku
         || !list
@@ -1239,57 +1725,269 @@ bool FindBestGuessesColumn(Sudoku *sudoku, unsigned int threshold, unsigned int
             return false;
     }
 
-    // ensure threshold is within 100, not really necessary
-    if (threshold > 100) {
-        threshold = 100;
+    return FindBestGuessesUnit(sudoku, threshold, COLUMN_UNIT(X), list);
+}
+
+
+//! Function which counts the places every value can go within every unit
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to count
+ *  @param      GuessCounts *   A pointer to the counts to fill
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool CountGuessPlaces(Sudoku *sudoku, GuessCounts *counts)
+{
+    // sanity
+    if (!sudoku
+        || !counts) {
+        return false;
     }
 
-    // This label is used to iterate all cells twice, first to find the highest probability
-    // the second time to store all guesses with the highest probability
-REITERATE:
+    // make sure our place tables match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
 
+    // our place tables are already counted
+    memcpy(counts->places, sudoku->places, sizeof(counts->places));
 
-    // iterate each cell within this column vertically
-    for (y = 0; y < 9; ++y) {
-        // if this cell is empty
-        if (IsCellEmpty(sudoku, X, y)) {
-            // iterate all values
-            for (v = 0; v < 9; ++v) {
-                // grab the probability of this cell
-                probability = RowProbability(sudoku, X, y, v);
+    return true;
+}
 
-                // ensure our probability meets our threshold
-                if (probability >= threshold) {
-                    // if this is the second iteration
-                    if (complete_iteration) {
-                        // if this probability is = to the max
-                        if (probability == max_probability) {
-                            // attempt to append this new guess to the list
-                            if (!AppendGuess(list, X, y, v, probability)) {
-                                return false;
-                            }
-                        }
-                    } else { // if this is the first iteration
-                        // determine the maxmimum probability out of all cells
-                        if (probability > max_probability) {
-                            max_probability = probability;
-                        }
-                    }
-                }
+
+//! Function which scores a guess by the fewest places its value has in the cell's row, column and box
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object the guess is on
+ *  @param      GuessCounts *   A pointer to the counts of the sudoku
+ *  @param      unsigned int    The cell of the guess from 0 - 80
+ *  @param      unsigned int    The value of the guess
+ *
+ *  @returns    unsigned int    The probability from 0 to 100 that the guess is correct
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This gives the same result as MaxProbability
+ */
+unsigned int ProbabilityScore(Sudoku *sudoku, const GuessCounts *counts, unsigned int cell, unsigned int value)
+{
+    unsigned int places = 0;
+
+    // the unit with the fewest places decides
+    places = MIN(MIN(counts->places[ROW_UNIT(CellRow[cell])][value],
+                     counts->places[COLUMN_UNIT(CellColumn[cell])][value]),
+                     counts->places[BOX_UNIT(CellBox[cell])][value]);
+
+    return places ? 100 / places : 0;
+}
+
+//! Function which scores a guess by the number of candidates in its cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object the guess is on
+ *  @param      GuessCounts *   A pointer to the counts of the sudoku
+ *  @param      unsigned int    The cell of the guess from 0 - 80
+ *  @param      unsigned int    The value of the guess
+ *
+ *  @returns    unsigned int    The probability from 0 to 100 that the guess is correct
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int CandidateScore(Sudoku *sudoku, const GuessCounts *counts, unsigned int cell, unsigned int value)
+{
+    unsigned int places = POPCOUNT(CELL_CANDIDATES(sudoku, cell));
+
+    return places ? 100 / places : 0;
+}
+
+//! Function to determine if one guess ranks above another
+/*!
+ *  @param      Guess *         The first guess
+ *  @param      Guess *         The second guess
+ *
+ *  @returns    boolean         Returns true if the first guess ranks above the second
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Equal probabilities rank in board order so rankings are repeatable
+ */
+static bool IsBetterGuess(const Guess *a, const Guess *b)
+{
+    if (a->probability != b->probability) {
+        return a->probability > b->probability;
+    }
+
+    return ((CELL(a->x, a->y) * 10) + a->value) < ((CELL(b->x, b->y) * 10) + b->value);
+}
+
+//! Function to restore the heap order of a ranking below a guess
+/*!
+ *  @param      GuessRanking *  The ranking to fix
+ *  @param      unsigned int    The index of the guess that may be out of place
+ *  @param      unsigned int    The number of guesses in the heap
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static void SiftRankedGuess(GuessRanking *ranking, unsigned int i, unsigned int count)
+{
+    unsigned int worst = 0, child = 0;
+    Guess swap;
+
+    // keep the worst guess at the top of the heap
+    while ((child = (i * 2) + 1) < count) {
+        worst = child;
+
+        if (child + 1 < count
+            && IsBetterGuess(&ranking->guesses[child], &ranking->guesses[child + 1])) {
+            worst = child + 1;
+        }
+
+        if (!IsBetterGuess(&ranking->guesses[i], &ranking->guesses[worst])) {
+            break;
+        }
+
+        swap = ranking->guesses[i];
+        ranking->guesses[i] = ranking->guesses[worst];
+        ranking->guesses[worst] = swap;
+        i = worst;
+    }
+}
+
+//! Function to offer a guess to a ranking
+/*!
+ *  @param      GuessRanking *  The ranking to add to
+ *  @param      Guess *         The guess to add
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Once the ranking is full the guess replaces the worst guess if it's better
+ */
+static void PushRankedGuess(GuessRanking *ranking, const Guess *guess)
+{
+    unsigned int i = 0, parent = 0;
+    Guess swap;
+
+    // room left, add it and move it up past anything better
+    if (ranking->count < ranking->capacity) {
+        i = ranking->count++;
+        ranking->guesses[i] = *guess;
+
+        while (i > 0) {
+            parent = (i - 1) / 2;
+
+            if (!IsBetterGuess(&ranking->guesses[parent], &ranking->guesses[i])) {
+                break;
             }
+
+            swap = ranking->guesses[i];
+            ranking->guesses[i] = ranking->guesses[parent];
+            ranking->guesses[parent] = swap;
+            i = parent;
         }
+    } else if (IsBetterGuess(guess, &ranking->guesses[0])) { // otherwise replace the worst
+        ranking->guesses[0] = *guess;
+        SiftRankedGuess(ranking, 0, ranking->count);
     }
-    
+}
 
-    // if we completed a full iteration to determine the highest probability
-    if (!complete_iteration) {
-        // go back and iterate again this time storing all guesses with probability == to the highest
-        complete_iteration = true;
-        goto REITERATE;
+//! Function which ranks every possible guess on the board and keeps the best scoring ones
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      GuessScorer     The function to score guesses with, NULL for the sudoku's scorer
+ *  @param      unsigned int    The most guesses to keep, at most MAXRANKEDGUESSES
+ *  @param      GuessRanking *  A pointer to the ranking that receives the guesses best first
+ *
+ *  @returns    boolean         Returns true if any guesses were ranked
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every candidate is scored in a single pass and kept in a fixed size heap
+ */
+bool RankGuesses(Sudoku *sudoku, GuessScorer scorer, unsigned int k, GuessRanking *ranking)
+{
+    unsigned int c = 0, v = 0, mask = 0, n = 0;
+    GuessCounts counts;
+    Guess guess, swap;
+
+    // sanity
+    if (!sudoku
+        || !ranking) {
+        return false;
     }
 
-    // success
-    return (list->count > 0);
+    // fall back on the sudoku's scorer, then on probability
+    if (!scorer) {
+        scorer = sudoku->scorer ? sudoku->scorer : ProbabilityScore;
+    }
+
+    // start empty with room for k guesses
+    ranking->count = 0;
+    ranking->capacity = MIN(MAX(k, 1), MAXRANKEDGUESSES);
+
+    // grab the places of every value
+    if (!CountGuessPlaces(sudoku, &counts)) {
+        return false;
+    }
+
+    // score every candidate of every cell
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        for (v = 1, mask = CELL_CANDIDATES(sudoku, c); mask; ++v, mask >>= 1) {
+            if (mask & 1) {
+                guess.x = CellColumn[c];
+                guess.y = CellRow[c];
+                guess.value = v;
+                guess.probability = MIN(scorer(sudoku, &counts, c, v), 100);
+
+                PushRankedGuess(ranking, &guess);
+            }
+        }
+    }
+
+    // take the worst off the heap until it's sorted best first
+    for (n = ranking->count; n > 1; --n) {
+        swap = ranking->guesses[0];
+        ranking->guesses[0] = ranking->guesses[n - 1];
+        ranking->guesses[n - 1] = swap;
+        SiftRankedGuess(ranking, 0, n - 1);
+    }
+
+    return (ranking->count > 0);
+}
+
+//! Function to append every guess with a given score to a list
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The score a guess must have
+ *  @param      GuessList *     A pointer to the guess list to append to
+ *
+ *  @returns    boolean         Returns false if a guess couldn't be appended
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Guesses are scored the same way RankGuesses scores them without a scorer of its own
+ */
+static bool AppendScoredGuesses(Sudoku *sudoku, unsigned int score, GuessList *list)
+{
+    unsigned int c = 0, v = 0, mask = 0;
+    GuessScorer scorer = sudoku->scorer ? sudoku->scorer : ProbabilityScore;
+    GuessCounts counts;
+
+    if (!CountGuessPlaces(sudoku, &counts)) {
+        return false;
+    }
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        for (v = 1, mask = CELL_CANDIDATES(sudoku, c); mask; ++v, mask >>= 1) {
+            if ((mask & 1)
+                && MIN(scorer(sudoku, &counts, c, v), 100) == score
+                && !AppendGuess(list, CellColumn[c], CellRow[c], v, score)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
 }
 
 //! Function which attempts to find all the best guesses within the entire sudoku with a probability above threshold
@@ -1301,12 +1999,14 @@ REITERATE:
  *  @returns    boolean         Returns true if a possible guess was found, false if nothing was found
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every guess tied for the best is returned, when there are more ties than a
+ *        GuessRanking holds the board is scanned a second time to collect the rest
  */
 bool FindBestGuesses(Sudoku *sudoku, unsigned int threshold, GuessList *list)
 {
-    unsigned int z = 0, g = 0, max_probability = 0, probability = 0;
-    bool complete_iteration = false;
-    GuessList *guesses_list = NULL;
+    unsigned int g = 0;
+    GuessRanking ranking;
 
     // sanity check
     if (!sudoku
@@ -1319,160 +2019,533 @@ bool FindBestGuesses(Sudoku *sudoku, unsigned int threshold, GuessList *list)
         threshold = 100;
     }
 
-    // initialize our guess list
-    if (!InitializeGuessList(&guesses_list)) {
+    // rank every guess on the board
+    if (!RankGuesses(sudoku, NULL, MAXRANKEDGUESSES, &ranking)) {
         return false;
     }
 
-    // iterate all boxes, rows and columns and find guesses above the threshold
-    for (z = 0; z < 9; ++z) {
-        // find the best guesses for this box
-        FindBestGuessesBox(sudoku, threshold, BOX_X(z), BOX_Y(z), guesses_list);
-
-        // find the best guesses for this row
-        FindBestGuessesRow(sudoku, threshold, z, guesses_list);
-
-        // find the best guesses for this column
-        FindBestGuessesColumn(sudoku, threshold, z, guesses_list);
+    // a full ranking still tied at its end may have dropped ties, so go back over the board for all of them
+    if (ranking.count == MAXRANKEDGUESSES
+        && ranking.guesses[ranking.count - 1].probability == ranking.guesses[0].probability
+        && ranking.guesses[0].probability >= threshold) {
+        return AppendScoredGuesses(sudoku, ranking.guesses[0].probability, list)
+            && list->count > 0;
     }
 
-    // used to reiterate after the highest guess probability has been found
-    // once the highest is found all the guesses with the highest probability can be added
-REITERATE:
-    for (g = 0; g < guesses_list->count; ++g) {
-        // the probability for this guess
-        probability = guesses_list->guesses[g]->probability;
-        
-        // if this is the second iteration
-        if (complete_iteration) {
-            // if this guess has the highest probability
-            if (probability == max_probability) {
-                // Append a copy of this guess to our output list
-                if (!AppendGuess(list, 
-                    guesses_list->guesses[g]->x,
-                    guesses_list->guesses[g]->y,
-                    guesses_list->guesses[g]->value,
-                    guesses_list->guesses[g]->probability)) {
-                    // make sure our guess appending worked
-                    return false;
-                }
-            }
-        } else { // if this is the first iteration
-            // store the highest probability
-            if (probability > max_probability) {
-                max_probability = probability;
-            }
+    // append every guess tied with the best that meets our threshold
+    for (g = 0; g < ranking.count; ++g) {
+        if (ranking.guesses[g].probability != ranking.guesses[0].probability
+            || ranking.guesses[g].probability < threshold) {
+            break;
         }
-    }
 
-    // once we've gone through the entire list to determine the highest probability
-    if (!complete_iteration) {
-        // go back through the list and save the guesses with the highest probability
-        complete_iteration = true;
-        goto REITERATE;
+        if (!AppendGuess(list,
+            ranking.guesses[g].x,
+            ranking.guesses[g].y,
+            ranking.guesses[g].value,
+            ranking.guesses[g].probability)) {
+            return false;
+        }
     }
-    
-    // cleanup the guess list
-    DestroyGuessList(guesses_list);
 
     // return whether any were found
     return (list->count > 0);
 }
 
 
-//! Function which attempts to solve the sudoku
+
+//! Function which counts the values that can still be placed in a cell
 /*!
- *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The x position of the cell to check
+ *  @param      unsigned int    The y position of the cell to check
  *
- *  @returns    boolean         Returns true if the sudoku was successfully solved
+ *  @returns    unsigned int    The number of values from 1 - 9 that can be placed in the cell
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-bool SolveSudoku(Sudoku *sudoku)
+unsigned int CandidateCount(Sudoku *sudoku, unsigned int X, unsigned int Y)
 {
-    bool progress = true, complete = false;
-#ifdef CANGUESS
-    bool can_guess = false;
-    unsigned int guess_count = 0;
-    GuessList *guess_list = NULL;
-    Guess *last_guess = NULL;
-#endif
+    // sanity check
+    if (!sudoku
+        || X > 8
+        || Y > 8) {
+            return 0;
+    }
+
+    // make sure our candidates match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    return POPCOUNT(sudoku->candidates[Y][X]);
+}
+
 
+//! Function which makes sure the candidates match the grid, keeping any eliminations made since
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @returns    boolean         Returns false if the board has a contradiction
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The candidates are only rebuilt once a placement has made them stale
+ */
+bool RefreshCandidates(Sudoku *sudoku)
+{
     // sanity
     if (!sudoku) {
         return false;
     }
 
-#ifdef CANGUESS
-    // make a new guess list for guessing purposes
-    if (!InitializeGuessList(&guess_list)) {
+    // make sure our candidates match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    return sudoku->contradiction == CONTRADICTION_NONE;
+}
+
+
+//! Function which recalculates the candidates of every cell and the most constrained cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to scan
+ *
+ *  @returns    boolean         Returns false if an empty cell has no candidates
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool UpdateCandidates(Sudoku *sudoku)
+{
+    // sanity
+    if (!sudoku) {
         return false;
     }
-#endif
-    
-    // loop till we can't make any more progress or the sudoku is solved
-    while (progress && !complete) {
+
+    RebuildCandidates(sudoku);
+    ScanCandidates(sudoku, false);
+
+    return (sudoku->branchcount != 0);
+}
+
+
+//! Function which finds the empty cell with the fewest values that can be placed in it
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int *  A pointer that will receive the x position of the cell
+ *  @param      unsigned int *  A pointer that will receive the y position of the cell
+ *
+ *  @returns    boolean         Returns false if there are no empty cells or an empty cell has no candidates
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Ties are broken by the most empty cells sharing a row, column or box
+ */
+bool FindMostConstrainedCell(Sudoku *sudoku, unsigned int *X, unsigned int *Y)
+{
+    // sanity check
+    if (!sudoku
+        || !X
+        || !Y) {
+            return false;
+    }
+
+    // rescan if we've placed anything since the last propagation
+    if (!sudoku->branchvalid) {
+        ScanCandidates(sudoku, false);
+    }
+
+    // an empty cell with nothing that fits means this board is a dead end
+    if (sudoku->branchcount == 0
+        || sudoku->branchcount > 9) {
+        return false;
+    }
+
+    *X = sudoku->branchx;
+    *Y = sudoku->branchy;
+
+    return true;
+}
+
+//! Function which ranks every value that can be placed in a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The x position of the cell
+ *  @param      unsigned int    The y position of the cell
+ *  @param      GuessRanking *  A pointer to the ranking that receives the guesses best first
+ *
+ *  @returns    boolean         Returns true if any guesses were ranked
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Nothing is allocated so this is safe to call at every step of a search
+ */
+bool RankCellGuesses(Sudoku *sudoku, unsigned int X, unsigned int Y, GuessRanking *ranking)
+{
+    unsigned int v = 0, g = 0;
+    Guess guess;
+    GuessScorer scorer = NULL;
+    GuessCounts counts;
+
+    // sanity check
+    if (!sudoku
+        || !ranking
+        || X > 8
+        || Y > 8) {
+            return false;
+    }
+
+    // start with an empty ranking
+    ranking->count = 0;
+    ranking->capacity = MAXRANKEDGUESSES;
+
+    // grab the places of every value to score with
+    if (!CountGuessPlaces(sudoku, &counts)) {
+        return false;
+    }
+
+    // fall back on probability if we have no scorer
+    scorer = sudoku->scorer ? sudoku->scorer : ProbabilityScore;
+
+    // insert every value we can place here so the most probable is tried first
+    for (v = 1; v < 10; ++v) {
+        if (sudoku->candidates[Y][X] & VALUE_BIT(v)) {
+            guess.x = X;
+            guess.y = Y;
+            guess.value = v;
+            guess.probability = scorer(sudoku, &counts, CELL(X, Y), v);
+
+            for (g = ranking->count; g > 0 && ranking->guesses[g - 1].probability < guess.probability; --g) {
+                ranking->guesses[g] = ranking->guesses[g - 1];
+            }
+
+            ranking->guesses[g] = guess;
+            ranking->count++;
+        }
+    }
+
+    return (ranking->count > 0);
+}
+
+//! Function which appends a guess for every value that can be placed in a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The x position of the cell
+ *  @param      unsigned int    The y position of the cell
+ *  @param      GuessList *     A pointer to a guess list that will receive the guesses
+ *
+ *  @returns    boolean         Returns true if any guesses were appended
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The appended guesses are ordered from highest to lowest score
+ */
+bool FindCellGuesses(Sudoku *sudoku, unsigned int X, unsigned int Y, GuessList *list)
+{
+    unsigned int g = 0;
+    GuessRanking ranking;
+
+    // sanity check
+    if (!sudoku
+        || !list) {
+            return false;
+    }
+
+    // rank the guesses in this cell
+    if (!RankCellGuesses(sudoku, X, Y, &ranking)) {
+        return false;
+    }
+
+    // append them best first
+    for (g = 0; g < ranking.count; ++g) {
+        if (!AppendGuess(list,
+            ranking.guesses[g].x,
+            ranking.guesses[g].y,
+            ranking.guesses[g].value,
+            ranking.guesses[g].probability)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Function which places every forced number until no more progress can be made
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to propagate
+ *
+ *  @returns    unsigned int    PROPAGATE_COMPLETE, PROPAGATE_INCOMPLETE when a guess is needed,
+ *                              or PROPAGATE_CONTRADICTION when the board can't be solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Propagation stops the moment a contradiction is found, the reason is left in
+ *        the contradiction of the sudoku
+ */
+unsigned int PropagateSudoku(Sudoku *sudoku)
+{
+    bool progress = true;
+
+    // sanity
+    if (!sudoku) {
+        return PROPAGATE_INCOMPLETE;
+    }
+
+    // make sure our tables, and any contradiction in them, match the grid
+    if (!sudoku->candidatesvalid) {
+        RebuildCandidates(sudoku);
+    }
+
+    // loop till we can't make any more progress, giving up the moment the board is dead
+    while (progress
+        && !sudoku->contradiction
+        && !IsSudokuComplete(sudoku)) {
         // start with no progress this loop
         progress = false;
 
-        // first attempt to solve the boxes
-        if (SolveBoxes(sudoku) > 0) {
+        // first fill in cells with only one candidate
+        if (SolveCells(sudoku) > 0) {
+            progress = true;
+        }
+
+        // then attempt to solve the boxes
+        if (!sudoku->contradiction
+            && SolveBoxes(sudoku) > 0) {
             progress = true;
         }
 
         // now try to solve the rows
-        if (SolveRows(sudoku) > 0) {
+        if (!sudoku->contradiction
+            && SolveRows(sudoku) > 0) {
             progress = true;
         }
 
         // finally solve the columns
-        if (SolveColumns(sudoku) > 0) {
+        if (!sudoku->contradiction
+            && SolveColumns(sudoku) > 0) {
             progress = true;
         }
+    }
+
+    if (sudoku->contradiction) {
+        TRACE_EVENT(TRACE_CONTRADICTION, 0, 0, sudoku->contradiction);
+        return PROPAGATE_CONTRADICTION;
+    }
+
+    return IsSudokuComplete(sudoku) ? PROPAGATE_COMPLETE : PROPAGATE_INCOMPLETE;
+}
 
-        // check for completion
-        complete = IsSudokuComplete(sudoku);
-
-#ifdef CANGUESS
-        // if we can't make progress, and the sudoku isn't complete, we need to guess
-        if (!progress && !complete) {
-           // see if we can guess
-           can_guess = FindBestGuesses(sudoku, sudoku->threshold, guess_list);
-
-           // if we're able to make a guess
-           if (can_guess) {
-
-               if(guess_count < sudoku->maxguesscount) {
-               
-               // make sure we can place this guess
-               if (CanPlaceNumber(sudoku, 
-                   guess_list->guesses[guess_count]->x,
-                   guess_list->guesses[guess_count]->y,
-                   guess_list->guesses[guess_count]->value)) {
-                   // place the guess
-                   PlaceNumber(sudoku, 
-                       guess_list->guesses[guess_count]->x,
-                       guess_list->guesses[guess_count]->y,
-                       guess_list->guesses[guess_count]->value);
-                       
-                   // set the last guess
-                   last_guess = guess_list->guesses[guess_count];
-
-                   // increment our guesses
-                   guess_count++;
-               }
-           }
-
-           // if we were able to guess, we made progress and should re-try
-           progress = can_guess;
+
+//! Function which searches for a solution by guessing in the most constrained cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      unsigned int    The number of guesses already made above this board
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: No more than maxguesscount consecutive guesses will be made.
+ *        Branches live on the stack so searching never allocates.
+ *        With a transposition table boards already proven dead are skipped.
+ */
+bool SearchSudoku(Sudoku *sudoku, unsigned int depth)
+{
+    unsigned int x = 0, y = 0, g = 0;
+    bool solved = false;
+    GuessRanking ranking;
+    Sudoku branch;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    // someone else has already finished
+    if (SEARCH_CANCELLED(sudoku)) {
+        return false;
+    }
+
+    // place everything that is forced, we may not need to guess at all
+    switch (PropagateSudoku(sudoku)) {
+        case PROPAGATE_COMPLETE:
+            return true;
+        case PROPAGATE_CONTRADICTION:
+            return false;
+    }
+
+    // don't guess any deeper than we're allowed
+    if (depth >= sudoku->maxguesscount) {
+        return false;
+    }
+
+    // find the cell to guess in, if there isn't one this board is a dead end
+    if (!FindMostConstrainedCell(sudoku, &x, &y)) {
+        return false;
+    }
+
+    // another order of guesses may already have shown this board is a dead end
+    if (sudoku->transpositions
+        && IsKnownDead(sudoku->transpositions, HashSudoku(sudoku))) {
+        TRACE_EVENT(TRACE_KNOWNDEAD, 0, 0, depth);
+        return false;
+    }
+
+    // grab our guesses and a board on the stack to try them on
+    if (RankCellGuesses(sudoku, x, y, &ranking)
+        && InitializeSudokuStorage(&branch, sudoku->threshold, sudoku->maxguesscount)) {
+        // branches work quietly
+        branch.verbose = false;
+
+        // try each guess on a fresh copy of this board
+        for (g = 0; g < ranking.count && !solved && !SEARCH_CANCELLED(sudoku); ++g) {
+            CopySudoku(&branch, sudoku);
+            TRACE_EVENT(TRACE_GUESS, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, depth);
+            DECISION_EVENT(DECISION_GUESS, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, ranking.guesses[g].probability, depth);
+            PlaceNumber(&branch,
+                ranking.guesses[g].x,
+                ranking.guesses[g].y,
+                ranking.guesses[g].value);
+
+            // count the guess if anyone is keeping track
+            if (sudoku->guesscounter) {
+                (*sudoku->guesscounter)++;
+            }
+
+            // if this guess leads to a solution keep it
+            if (SearchSudoku(&branch, depth + 1)) {
+                CopySudoku(sudoku, &branch);
+                solved = true;
+            } else {
+                TRACE_EVENT(TRACE_BACKTRACK, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, depth);
+                DECISION_EVENT(DECISION_BACKTRACK, CELL(ranking.guesses[g].x, ranking.guesses[g].y), ranking.guesses[g].value, 0, depth);
+            }
+        }
+
+        // every guess failed, remember it unless the guess limit or a cancel could have cut a branch short
+        if (!solved
+            && sudoku->transpositions
+            && !SEARCH_CANCELLED(sudoku)
+            && depth + CountEmptyCells(sudoku) <= sudoku->maxguesscount) {
+            RecordDead(sudoku->transpositions, HashSudoku(sudoku));
         }
-#endif
     }
 
-#ifdef CANGUESS
-    // done with our guess list
-    DestroyGuessList(guess_list);
-#endif
+    return solved;
+}
+
+//! Function which searches for a solution with the engine chosen for the sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: ENGINE_PROBABILITY guesses with SearchSudoku, ENGINE_LEARNING learns nogoods with
+ *        SearchSudokuLearning, ENGINE_SAT hands the board to the sat solver, ENGINE_PORTFOLIO
+ *        races the DefaultPortfolio, ENGINE_RESTARTS guesses with random tie breaks and
+ *        luby restarts and ENGINE_ADAPTIVE picks one of them from how hard the board looks
+ */
+bool SearchSudokuEngine(Sudoku *sudoku)
+{
+    NogoodStore store;
+    bool solved = false;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    switch (sudoku->engine) {
+        case ENGINE_LEARNING:
+            // the nogoods only hold for this board so they're thrown away after
+            if (!InitializeNogoodStore(&store, 0, sudoku->allocator)) {
+                return false;
+            }
+
+            solved = SearchSudokuLearning(sudoku, &store);
+            DestroyNogoodStore(&store);
+
+            return solved;
+        case ENGINE_SAT:
+            return SolveSudokuSat(sudoku);
+        case ENGINE_PORTFOLIO:
+            return SearchSudokuPortfolio(sudoku, NULL, NULL);
+        case ENGINE_RESTARTS:
+            return SearchSudokuRestarts(sudoku, RESTART_LUBY);
+        case ENGINE_ADAPTIVE:
+            return SearchSudokuAdaptive(sudoku, NULL);
+        default:
+            return SearchSudoku(sudoku, 0);
+    }
+}
+
+//! Function to tell how a search of a sudoku ended
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object after searching
+ *
+ *  @returns    unsigned int    METRIC_SOLVED, METRIC_UNSOLVED or METRIC_GAVEUP
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The search gave up on an unsolved board without a contradiction when it was cancelled,
+ *        ran out of its guess budget, or still has more empty cells than the guess limit allows
+ *        guesses, as any of them could have cut the search short
+ */
+unsigned int SolveOutcome(Sudoku *sudoku)
+{
+    // sanity
+    if (!sudoku) {
+        return METRIC_UNSOLVED;
+    }
+
+    if (IsSudokuComplete(sudoku)) {
+        return METRIC_SOLVED;
+    }
+
+    // a contradiction proves there's nothing to find whatever cut the search short
+    if (sudoku->contradiction == CONTRADICTION_NONE
+        && (SEARCH_CANCELLED(sudoku)
+            || CountEmptyCells(sudoku) > sudoku->maxguesscount)) {
+        return METRIC_GAVEUP;
+    }
+
+    return METRIC_UNSOLVED;
+}
+
+//! Function which attempts to solve the sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *
+ *  @returns    boolean         Returns true if the sudoku was successfully solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool SolveSudoku(Sudoku *sudoku)
+{
+    unsigned long long started = 0;
+
+    // sanity
+    if (!sudoku) {
+        return false;
+    }
+
+    // only read the clock if someone wants the latency
+    if (sudoku->metrics) {
+        started = MetricsNanoseconds();
+    }
+
+    // place everything we can, then search if we're allowed to guess and the board isn't dead
+    if (PropagateSudoku(sudoku) == PROPAGATE_INCOMPLETE
+        && sudoku->maxguesscount) {
+        SearchSudokuEngine(sudoku);
+    }
+
+    if (sudoku->metrics) {
+        RecordSolveMetrics(sudoku->metrics, MetricsNanoseconds() - started, SolveOutcome(sudoku));
+    }
 
     // print our sudoku after all attempts to solve have been made
     PrintSudoku(sudoku);
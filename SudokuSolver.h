@@ -5,6 +5,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+
+#include "SudokuTables.h"
+#include "SudokuAllocator.h"
+#include "SudokuTransposition.h"
+#include "SudokuMetrics.h"
+#include "SudokuTrace.h"
+
+// libraries are built with SUDOKU_NO_STDIO so the solver never prints anything
+#ifdef SUDOKU_NO_STDIO
+#define SUDOKU_PRINTF(...)  ((void)0)
+#else
+#define SUDOKU_PRINTF(...)  printf(__VA_ARGS__)
+#endif
 
 // Converts boxes 0 - 8 from left to right, top to bottom. into their top left square x/y
 /* 
@@ -12,13 +26,51 @@
  * 3 4 5
  * 6 7 8
  */
-#define BOX_X(b)  ((b % 3) * 3)
-#define BOX_Y(b)  (b - (b % 3))
+#define BOX_X(b)  (BoxLeft[b])
+#define BOX_Y(b)  (BoxTop[b])
+
+// candidate masks hold value v in bit v - 1
+#define VALUE_BIT(v)  (1u << ((v) - 1))
+#define ALL_VALUES    0x1FFu
+
+// counts the set bits of a candidate mask, and finds the index of the lowest set bit
+#if defined(__GNUC__)
+#define POPCOUNT(x)   ((unsigned int)__builtin_popcount(x))
+#define LOWBIT(x)     ((unsigned int)__builtin_ctz(x))
+#else
+#define POPCOUNT(x)   (PopCount(x))
+#define LOWBIT(x)     (PopCount(((x) & (0u - (x))) - 1))
+#endif
 
 // simplistic type-unsafe min/max macros
 #define MIN(X, Y) (((X) < (Y)) ? (X) : (Y))
 #define MAX(X, Y) (((X) > (Y)) ? (X) : (Y))
 
+// the reasons a board can't be solved, kept in the contradiction of a sudoku
+#define CONTRADICTION_NONE       0
+#define CONTRADICTION_EMPTYCELL  1
+#define CONTRADICTION_NOPLACE    2
+#define CONTRADICTION_DUPLICATE  3
+#define CONTRADICTION_NOGOOD     4
+
+// the outcomes of propagating a sudoku
+#define PROPAGATE_INCOMPLETE     0
+#define PROPAGATE_COMPLETE       1
+#define PROPAGATE_CONTRADICTION  2
+
+// the engines a sudoku can be searched with
+#define ENGINE_PROBABILITY  0
+#define ENGINE_LEARNING     1
+#define ENGINE_SAT          2
+#define ENGINE_PORTFOLIO    3
+#define ENGINE_RESTARTS     4
+#define ENGINE_ADAPTIVE     5
+
+// whether someone has asked every search of a sudoku to stop, or it has used up its guesses
+#define SEARCH_CANCELLED(sudoku) \
+    (((sudoku)->cancel && atomic_load_explicit((sudoku)->cancel, memory_order_relaxed)) \
+    || ((sudoku)->guesslimit && (sudoku)->guesscounter && *(sudoku)->guesscounter >= (sudoku)->guesslimit))
+
 // A structure defining an placement entry into the sudoku log
 typedef struct {
     // the x position of the placement
@@ -68,10 +120,40 @@ typedef struct {
 
     // the list of pointers to guesses
     Guess **guesses;
+
+    // where the list and its guesses get their memory from
+    const SudokuAllocator *allocator;
 } GuessList;
 
-// A structure defining a sudoku that needs solving
+// the most guesses a guess ranking can hold
+#define MAXRANKEDGUESSES 32
+
+// A structure defining the counts guesses are scored from
 typedef struct {
+    // the number of places each value 1 - 9 can still go within each unit
+    unsigned char places[SUDOKU_UNITS][10];
+} GuessCounts;
+
+struct Sudoku;
+struct SudokuDispatcher;
+
+// A function which scores placing a value in a cell, higher scores are guessed first
+typedef unsigned int (*GuessScorer)(struct Sudoku *sudoku, const GuessCounts *counts, unsigned int cell, unsigned int value);
+
+// A structure defining the best scoring guesses on a board
+typedef struct {
+    // the number of guesses held
+    unsigned int count;
+
+    // the most guesses to hold
+    unsigned int capacity;
+
+    // the guesses, a heap with the worst guess first while ranking and sorted best first after
+    Guess guesses[MAXRANKEDGUESSES];
+} GuessRanking;
+
+// A structure defining a sudoku that needs solving
+typedef struct Sudoku {
     // the grid itself
     unsigned int grid[9][9];
 
@@ -83,30 +165,128 @@ typedef struct {
 
     // the list of guesses that have been made
     GuessList *guesslist;
+
+    // where the sudoku and its guess list get their memory from
+    const SudokuAllocator *allocator;
+
+    // counts every guess made while searching when set, shared by every branch
+    unsigned long long *guesscounter;
+
+    // why this board can't be solved, CONTRADICTION_NONE while it still might be
+    unsigned int contradiction;
+
+    // remembers the boards found to have no solution when set, shared by every branch
+    TranspositionTable *transpositions;
+
+    // the number of threads used when searching
+    unsigned int threads;
+
+    // whether solving progress is printed
+    bool verbose;
+
+    // the values that can be placed in each cell, value v is bit v - 1
+    unsigned short candidates[9][9];
+
+    // the values placed within each unit
+    unsigned short unitvalues[SUDOKU_UNITS];
+
+    // the number of empty cells within each unit
+    unsigned char unitempty[SUDOKU_UNITS];
+
+    // the number of places each value 1 - 9 can still go within each unit
+    unsigned char places[SUDOKU_UNITS][10];
+
+    // where each value can still go within each unit, bit i is the unit's i'th cell
+    unsigned short placemasks[SUDOKU_UNITS][10];
+
+    // the Zobrist hash of the grid, kept up to date with the candidates
+    unsigned long long hash;
+
+    // whether the candidates and place tables match the grid, they're kept up to date
+    // by each placement and rebuilt when next needed otherwise
+    bool candidatesvalid;
+
+    // whether the most constrained cell below matches the grid
+    bool branchvalid;
+
+    // the x position of the most constrained cell at the last scan
+    unsigned int branchx;
+
+    // the y position of the most constrained cell at the last scan
+    unsigned int branchy;
+
+    // the candidates in the most constrained cell, 0 if a cell has none and 10 if every cell is full
+    unsigned int branchcount;
+
+    // scores the guesses made on this sudoku
+    GuessScorer scorer;
+
+    // the engine the sudoku is searched with, ENGINE_PROBABILITY unless told otherwise
+    unsigned int engine;
+
+    // records the latency and outcome of every solve when set
+    SudokuMetrics *metrics;
+
+    // stops every search of the sudoku once set, shared by every branch, NULL if it can't be cancelled
+    atomic_bool *cancel;
+
+    // stops every search of the sudoku once the guess counter reaches it, 0 for no limit
+    unsigned long long guesslimit;
+
+    // where randomized searches start their random numbers, the same seed makes the same guesses
+    unsigned long long seed;
+
+    // chooses the engine of ENGINE_ADAPTIVE searches, NULL for DefaultDispatcher
+    const struct SudokuDispatcher *dispatcher;
 } Sudoku;
 
+//! Function to count the set bits of a candidate mask
+/*!
+ *  @param      unsigned int    The mask to count
+ *
+ *  @returns    unsigned int    The number of bits set in the mask
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Only used by POPCOUNT when the compiler has no builtin
+ */
+unsigned int PopCount(unsigned int mask);
+
 //! Function to create an initialize a new guess
 /*!
  *  @param      unsigned int    The x position of the new guess
  *  @param      unsigned int    The y position of the new guess
  *  @param      unsigned int    The value of the new guess
  *  @param      unsigned int    The probability of the new guess
+ *  @param      SudokuAllocator * Where to allocate the guess, or NULL for the system allocator
  *
  *  @returns    Guess *         A pointer to the new guess object or NULL
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-Guess *CreateGuess(unsigned int X, unsigned int Y, unsigned int Value, unsigned int Probability);
+Guess *CreateGuess(unsigned int X, unsigned int Y, unsigned int Value, unsigned int Probability, const SudokuAllocator *allocator);
 
 //! Function to destroy an initialized new guess
 /*!
  *  @param      Guess *         A pointer to the guess object to destroy
+ *  @param      SudokuAllocator * The allocator the guess came from, or NULL for the system allocator
  *
  *  @returns    boolean         Whether the guess object was successfully destroyed
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
  */
-bool DestroyGuess(Guess *guess);
+bool DestroyGuess(Guess *guess, const SudokuAllocator *allocator);
+
+//! Function to initialize a new guess list that gets its memory from an allocator
+/*!
+ *  @param      Guesslist **    A pointer to a pointer that will receive the initialized guess list
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the guess list was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeGuessListWithAllocator(GuessList **list, const SudokuAllocator *allocator);
 
 //! Function to initialize a new guess list
 /*!
@@ -162,6 +342,21 @@ bool AppendGuess(GuessList *list, unsigned int X, unsigned int Y, unsigned int V
  */
 bool RemoveGuess(GuessList *guesslist);
 
+//! Function to initialize a new sudoku that gets its memory from an allocator
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to initialize
+ *  @param      float           The probabilty threshold required for a guess to be made
+ *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The allocator must outlive the sudoku
+ */
+bool InitializeSudokuWithAllocator(Sudoku **sudoku, unsigned int guessthreshold, unsigned int maxguesses, const SudokuAllocator *allocator);
+
 //! Function to initialize a new sudoku
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to initialize
@@ -174,6 +369,32 @@ bool RemoveGuess(GuessList *guesslist);
  */
 bool InitializeSudoku(Sudoku **sudoku, unsigned int guessthreshold, unsigned int maxguesses);
 
+//! Function to initialize a sudoku in storage provided by the caller
+/*!
+ *  @param      Sudoku*         A pointer to the storage to initialize, on the stack or in an array
+ *  @param      float           The probabilty threshold required for a guess to be made
+ *  @param      unsigned int    The maxmimum number of consecutive guesses
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Nothing is allocated, a sudoku initialized this way must not be passed to DestroySudoku
+ */
+bool InitializeSudokuStorage(Sudoku *sudoku, unsigned int guessthreshold, unsigned int maxguesses);
+
+//! Function to clear a sudoku so it can be reused for another puzzle
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to clear
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The settings and guess list are kept, only the board is cleared
+ */
+bool ResetSudoku(Sudoku *sudoku);
+
 //! Function to safely cleanup a sudoku object
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to initialize
@@ -184,6 +405,19 @@ bool InitializeSudoku(Sudoku **sudoku, unsigned int guessthreshold, unsigned int
  */
 bool DestroySudoku(Sudoku *sudoku);
 
+//! Function to copy the board and settings of one sudoku into another
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object receiving the copy
+ *  @param      Sudoku*         A pointer to the sudoku object to copy
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The destination keeps its own guess list, allocator and verbosity
+ */
+bool CopySudoku(Sudoku *destination, Sudoku *source);
+
 //! Function to print out the sudoku table
 /*!
  *  @param    Sudoku*         A pointer to the sudoku object to print
@@ -208,6 +442,34 @@ void PrintSudoku(Sudoku *sudoku);
  */
 bool PlaceNumber(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value);
 
+//! Function to empty a cell, taking back the number placed in it
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      unsigned int    The x position of the cell to empty from 0 - 8
+ *  @param      unsigned int    The y position of the cell to empty from 0 - 8
+ *
+ *  @returns    boolean         Returns true if the cell held a number
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Any candidate removed because of the number may be back, so the candidates
+ *        are rebuilt from the grid when next needed and eliminations are lost
+ */
+bool UnplaceNumber(Sudoku *sudoku, unsigned int X, unsigned int Y);
+
+//! Function to remove a value from the candidates of a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      unsigned int    The x position of the cell from 0 - 8
+ *  @param      unsigned int    The y position of the cell from 0 - 8
+ *  @param      unsigned int    The value to remove from 1 - 9
+ *
+ *  @returns    boolean         Returns true if the value was a candidate and has been removed
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool EliminateCandidate(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value);
+
 //! Function to check if a specific cell is free or not
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object
@@ -316,6 +578,28 @@ bool IsBoxComplete(Sudoku *sudoku, unsigned int X, unsigned int Y);
  */
 bool IsSudokuComplete(Sudoku *sudoku);
 
+//! Function to get the Zobrist hash of the grid of a sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @returns    unsigned long long The xor of the ZobristKeys of every value in the grid
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The hash is kept up to date by each placement along with the candidates
+ */
+unsigned long long HashSudoku(Sudoku *sudoku);
+
+//! Function to count the empty cells of a sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @returns    unsigned int    The number of empty cells
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int CountEmptyCells(Sudoku *sudoku);
+
 //! Function which determines the probability that a number is correct based on the 3x3 box
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -376,6 +660,19 @@ unsigned int ColumnProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, u
  */
 unsigned int MaxProbability(Sudoku *sudoku, unsigned int X, unsigned int Y, unsigned int value);
 
+//! Function which attempts to solve the cells of the sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
+ *
+ *  @returns    unsigned int    The number of cells that were correctly solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This function places every cell left with a single candidate and in the
+ *        same pass records the candidates and the most constrained cell
+ */
+unsigned int SolveCells(Sudoku *sudoku);
+
 //! Function which attempts to solve the boxes of the sudoku
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -455,6 +752,60 @@ bool FindBestGuessesRow(Sudoku *sudoku, unsigned int threshold, unsigned int Y,
  */
 bool FindBestGuessesColumn(Sudoku *sudoku, unsigned int threshold, unsigned int X, GuessList *list);
 
+//! Function which counts the places every value can go within every unit
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to count
+ *  @param      GuessCounts *   A pointer to the counts to fill
+ *
+ *  @returns    boolean         Returns true if successful
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool CountGuessPlaces(Sudoku *sudoku, GuessCounts *counts);
+
+//! Function which scores a guess by the fewest places its value has in the cell's row, column and box
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object the guess is on
+ *  @param      GuessCounts *   A pointer to the counts of the sudoku
+ *  @param      unsigned int    The cell of the guess from 0 - 80
+ *  @param      unsigned int    The value of the guess
+ *
+ *  @returns    unsigned int    The probability from 0 to 100 that the guess is correct
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This gives the same result as MaxProbability
+ */
+unsigned int ProbabilityScore(Sudoku *sudoku, const GuessCounts *counts, unsigned int cell, unsigned int value);
+
+//! Function which scores a guess by the number of candidates in its cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object the guess is on
+ *  @param      GuessCounts *   A pointer to the counts of the sudoku
+ *  @param      unsigned int    The cell of the guess from 0 - 80
+ *  @param      unsigned int    The value of the guess
+ *
+ *  @returns    unsigned int    The probability from 0 to 100 that the guess is correct
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int CandidateScore(Sudoku *sudoku, const GuessCounts *counts, unsigned int cell, unsigned int value);
+
+//! Function which ranks every possible guess on the board and keeps the best scoring ones
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      GuessScorer     The function to score guesses with, NULL for the sudoku's scorer
+ *  @param      unsigned int    The most guesses to keep, at most MAXRANKEDGUESSES
+ *  @param      GuessRanking *  A pointer to the ranking that receives the guesses best first
+ *
+ *  @returns    boolean         Returns true if any guesses were ranked
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every candidate is scored in a single pass and kept in a fixed size heap
+ */
+bool RankGuesses(Sudoku *sudoku, GuessScorer scorer, unsigned int k, GuessRanking *ranking);
+
 //! Function which attempts to find all the best guesses within the entire sudoku with a probability above threshold
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to search
@@ -464,9 +815,150 @@ bool FindBestGuessesColumn(Sudoku *sudoku, unsigned int threshold, unsigned int
  *  @returns    boolean         Returns true if a possible guess was found, false if nothing was found
  *
  *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Every guess tied for the best is returned, when there are more ties than a
+ *        GuessRanking holds the board is scanned a second time to collect the rest
  */
 bool FindBestGuesses(Sudoku *sudoku, unsigned int threshold, GuessList *list);
 
+//! Function which counts the values that can still be placed in a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The x position of the cell to check
+ *  @param      unsigned int    The y position of the cell to check
+ *
+ *  @returns    unsigned int    The number of values from 1 - 9 that can be placed in the cell
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int CandidateCount(Sudoku *sudoku, unsigned int X, unsigned int Y);
+
+//! Function which makes sure the candidates match the grid, keeping any eliminations made since
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *
+ *  @returns    boolean         Returns false if the board has a contradiction
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The candidates are only rebuilt once a placement has made them stale
+ */
+bool RefreshCandidates(Sudoku *sudoku);
+
+//! Function which recalculates the candidates of every cell and the most constrained cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to scan
+ *
+ *  @returns    boolean         Returns false if an empty cell has no candidates
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This rebuilds the candidates and place tables from the grid
+ */
+bool UpdateCandidates(Sudoku *sudoku);
+
+//! Function which finds the empty cell with the fewest values that can be placed in it
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int *  A pointer that will receive the x position of the cell
+ *  @param      unsigned int *  A pointer that will receive the y position of the cell
+ *
+ *  @returns    boolean         Returns false if there are no empty cells or an empty cell has no candidates
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Ties are broken by the most empty cells sharing a row, column or box
+ */
+bool FindMostConstrainedCell(Sudoku *sudoku, unsigned int *X, unsigned int *Y);
+
+//! Function which ranks every value that can be placed in a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The x position of the cell
+ *  @param      unsigned int    The y position of the cell
+ *  @param      GuessRanking *  A pointer to the ranking that receives the guesses best first
+ *
+ *  @returns    boolean         Returns true if any guesses were ranked
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Nothing is allocated so this is safe to call at every step of a search
+ */
+bool RankCellGuesses(Sudoku *sudoku, unsigned int X, unsigned int Y, GuessRanking *ranking);
+
+//! Function which appends a guess for every value that can be placed in a cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search
+ *  @param      unsigned int    The x position of the cell
+ *  @param      unsigned int    The y position of the cell
+ *  @param      GuessList *     A pointer to a guess list that will receive the guesses
+ *
+ *  @returns    boolean         Returns true if any guesses were appended
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The appended guesses are ordered from highest to lowest score
+ */
+bool FindCellGuesses(Sudoku *sudoku, unsigned int X, unsigned int Y, GuessList *list);
+
+//! Function which places every forced number until no more progress can be made
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to propagate
+ *
+ *  @returns    unsigned int    PROPAGATE_COMPLETE, PROPAGATE_INCOMPLETE when a guess is needed,
+ *                              or PROPAGATE_CONTRADICTION when the board can't be solved
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Propagation stops the moment a contradiction is found, the reason is left in
+ *        the contradiction of the sudoku
+ */
+unsigned int PropagateSudoku(Sudoku *sudoku);
+
+//! Function which searches for a solution by guessing in the most constrained cell
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *  @param      unsigned int    The number of guesses already made above this board
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: No more than maxguesscount consecutive guesses will be made.
+ *        Branches live on the stack so searching never allocates.
+ *        With a transposition table boards already proven dead are skipped.
+ */
+bool SearchSudoku(Sudoku *sudoku, unsigned int depth);
+
+//! Function which searches for a solution with the engine chosen for the sudoku
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object to search, receives the solution
+ *
+ *  @returns    boolean         Returns true if a solution was found
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: ENGINE_PROBABILITY guesses with SearchSudoku, ENGINE_LEARNING learns nogoods with
+ *        SearchSudokuLearning, ENGINE_SAT hands the board to the sat solver, ENGINE_PORTFOLIO
+ *        races the DefaultPortfolio, ENGINE_RESTARTS guesses with random tie breaks and
+ *        luby restarts and ENGINE_ADAPTIVE picks one of them from how hard the board looks
+ */
+bool SearchSudokuEngine(Sudoku *sudoku);
+
+//! Function to tell how a search of a sudoku ended
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object after searching
+ *
+ *  @returns    unsigned int    METRIC_SOLVED, METRIC_UNSOLVED or METRIC_GAVEUP
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The search gave up on an unsolved board without a contradiction when it was cancelled,
+ *        ran out of its guess budget, or still has more empty cells than the guess limit allows
+ *        guesses, as any of them could have cut the search short
+ */
+unsigned int SolveOutcome(Sudoku *sudoku);
+
 //! Function which attempts to solve the sudoku
 /*!
  *  @param      Sudoku*         A pointer to the sudoku object to attempt to solve
@@ -0,0 +1,76 @@
+#include "SudokuTables.h"
+
+// The tables below are expanded by the preprocessor so the compiler builds them as constants,
+// none of this arithmetic is left for the solver to do at runtime.
+
+// the row, column and box of cell c
+#define T_ROW(c)      ((c) / 9)
+#define T_COLUMN(c)   ((c) % 9)
+#define T_BOX(c)      (((T_ROW(c) / 3) * 3) + (T_COLUMN(c) / 3))
+#define T_BOX_INDEX(c)  (((T_ROW(c) % 3) * 3) + (T_COLUMN(c) % 3))
+
+// the k'th other cell in the row, column and box of cell c
+#define T_ROW_PEER(c, k)     ((T_ROW(c) * 9) + ((k) < T_COLUMN(c) ? (k) : (k) + 1))
+#define T_COLUMN_PEER(c, k)  ((((k) < T_ROW(c) ? (k) : (k) + 1) * 9) + T_COLUMN(c))
+#define T_BOX_PEER(c, k)     (((T_ROW(c) - (T_ROW(c) % 3) + (((T_ROW(c) % 3) + 1 + ((k) / 2)) % 3)) * 9) \
+                             + (T_COLUMN(c) - (T_COLUMN(c) % 3) + (((T_COLUMN(c) % 3) + 1 + ((k) % 2)) % 3)))
+
+// the i'th cell of unit u
+#define T_UNIT_CELL(u, i)    ((u) < 9 ? (((u) * 9) + (i)) \
+                             : (u) < 18 ? (((i) * 9) + ((u) - 9)) \
+                             : ((((((u) - 18) / 3) * 3) + ((i) / 3)) * 9) + ((((u) - 18) % 3) * 3) + ((i) % 3))
+
+// expand F over every cell
+#define T_ROW_OF_CELLS(F, r)  F(r * 9 + 0), F(r * 9 + 1), F(r * 9 + 2), F(r * 9 + 3), F(r * 9 + 4), \
+                              F(r * 9 + 5), F(r * 9 + 6), F(r * 9 + 7), F(r * 9 + 8)
+#define T_CELLS(F)  T_ROW_OF_CELLS(F, 0), T_ROW_OF_CELLS(F, 1), T_ROW_OF_CELLS(F, 2), \
+                    T_ROW_OF_CELLS(F, 3), T_ROW_OF_CELLS(F, 4), T_ROW_OF_CELLS(F, 5), \
+                    T_ROW_OF_CELLS(F, 6), T_ROW_OF_CELLS(F, 7), T_ROW_OF_CELLS(F, 8)
+
+// the peers of cell c
+#define T_PEERS(c)  { T_ROW_PEER(c, 0), T_ROW_PEER(c, 1), T_ROW_PEER(c, 2), T_ROW_PEER(c, 3), \
+                      T_ROW_PEER(c, 4), T_ROW_PEER(c, 5), T_ROW_PEER(c, 6), T_ROW_PEER(c, 7), \
+                      T_COLUMN_PEER(c, 0), T_COLUMN_PEER(c, 1), T_COLUMN_PEER(c, 2), T_COLUMN_PEER(c, 3), \
+                      T_COLUMN_PEER(c, 4), T_COLUMN_PEER(c, 5), T_COLUMN_PEER(c, 6), T_COLUMN_PEER(c, 7), \
+                      T_BOX_PEER(c, 0), T_BOX_PEER(c, 1), T_BOX_PEER(c, 2), T_BOX_PEER(c, 3) }
+
+// the cells of unit u
+#define T_UNIT(u)   { T_UNIT_CELL(u, 0), T_UNIT_CELL(u, 1), T_UNIT_CELL(u, 2), \
+                      T_UNIT_CELL(u, 3), T_UNIT_CELL(u, 4), T_UNIT_CELL(u, 5), \
+                      T_UNIT_CELL(u, 6), T_UNIT_CELL(u, 7), T_UNIT_CELL(u, 8) }
+
+// the Zobrist key of value v in cell c, the splitmix64 of c * 10 + v so every key is a fixed constant
+#define T_SPLITMIX_0(i)  (((unsigned long long)(i) + 1ull) * 0x9E3779B97F4A7C15ull)
+#define T_SPLITMIX_1(i)  ((T_SPLITMIX_0(i) ^ (T_SPLITMIX_0(i) >> 30)) * 0xBF58476D1CE4E5B9ull)
+#define T_SPLITMIX_2(i)  ((T_SPLITMIX_1(i) ^ (T_SPLITMIX_1(i) >> 27)) * 0x94D049BB133111EBull)
+#define T_KEY(c, v)      (T_SPLITMIX_2(((c) * 10) + (v)) ^ (T_SPLITMIX_2(((c) * 10) + (v)) >> 31))
+
+// the keys of cell c, an empty cell has no key
+#define T_ZOBRIST(c)  { 0, T_KEY(c, 1), T_KEY(c, 2), T_KEY(c, 3), T_KEY(c, 4), \
+                        T_KEY(c, 5), T_KEY(c, 6), T_KEY(c, 7), T_KEY(c, 8), T_KEY(c, 9) }
+
+const unsigned char CellRow[SUDOKU_CELLS] = { T_CELLS(T_ROW) };
+
+const unsigned char CellColumn[SUDOKU_CELLS] = { T_CELLS(T_COLUMN) };
+
+const unsigned char CellBox[SUDOKU_CELLS] = { T_CELLS(T_BOX) };
+
+const unsigned char CellBoxIndex[SUDOKU_CELLS] = { T_CELLS(T_BOX_INDEX) };
+
+const unsigned char CellPeers[SUDOKU_CELLS][SUDOKU_PEERS] = { T_CELLS(T_PEERS) };
+
+const unsigned char UnitCells[SUDOKU_UNITS][SUDOKU_SIZE] = {
+    T_UNIT(0),  T_UNIT(1),  T_UNIT(2),  T_UNIT(3),  T_UNIT(4),  T_UNIT(5),  T_UNIT(6),  T_UNIT(7),  T_UNIT(8),
+    T_UNIT(9),  T_UNIT(10), T_UNIT(11), T_UNIT(12), T_UNIT(13), T_UNIT(14), T_UNIT(15), T_UNIT(16), T_UNIT(17),
+    T_UNIT(18), T_UNIT(19), T_UNIT(20), T_UNIT(21), T_UNIT(22), T_UNIT(23), T_UNIT(24), T_UNIT(25), T_UNIT(26)
+};
+
+const unsigned long long ZobristKeys[SUDOKU_CELLS][10] = { T_CELLS(T_ZOBRIST) };
+
+const unsigned char BoxBand[SUDOKU_SIZE] = { 0, 0, 0, 1, 1, 1, 2, 2, 2 };
+
+const unsigned char BoxStack[SUDOKU_SIZE] = { 0, 1, 2, 0, 1, 2, 0, 1, 2 };
+
+const unsigned char BoxLeft[SUDOKU_SIZE] = { 0, 3, 6, 0, 3, 6, 0, 3, 6 };
+
+const unsigned char BoxTop[SUDOKU_SIZE] = { 0, 0, 0, 3, 3, 3, 6, 6, 6 };
@@ -0,0 +1,50 @@
+#ifndef SUDOKU_TABLES_H
+#define SUDOKU_TABLES_H
+
+// the supported board is 9x9 made of 3x3 boxes
+#define SUDOKU_SIZE   9
+#define SUDOKU_CELLS  81
+#define SUDOKU_UNITS  27
+#define SUDOKU_PEERS  20
+
+// cells are numbered 0 - 80 from left to right, top to bottom
+#define CELL(x, y)    (((y) * SUDOKU_SIZE) + (x))
+
+// units 0 - 8 are rows, 9 - 17 are columns and 18 - 26 are boxes
+#define ROW_UNIT(y)     (y)
+#define COLUMN_UNIT(x)  (SUDOKU_SIZE + (x))
+#define BOX_UNIT(b)     ((2 * SUDOKU_SIZE) + (b))
+
+// the value and candidates at cell c of a sudoku
+#define CELL_VALUE(sudoku, c)       ((&(sudoku)->grid[0][0])[c])
+#define CELL_CANDIDATES(sudoku, c)  ((&(sudoku)->candidates[0][0])[c])
+
+// the row, column and box of every cell
+extern const unsigned char CellRow[SUDOKU_CELLS];
+extern const unsigned char CellColumn[SUDOKU_CELLS];
+extern const unsigned char CellBox[SUDOKU_CELLS];
+
+// the position of every cell within its box, a cell's position in its row is its
+// column and its position in its column is its row
+extern const unsigned char CellBoxIndex[SUDOKU_CELLS];
+
+// the 20 cells sharing a row, column or box with every cell
+// 8 from the row, then 8 from the column, then the 4 left in the box
+extern const unsigned char CellPeers[SUDOKU_CELLS][SUDOKU_PEERS];
+
+// the 9 cells of every unit
+extern const unsigned char UnitCells[SUDOKU_UNITS][SUDOKU_SIZE];
+
+// a random key for every value 1 - 9 in every cell, the hash of a grid is the xor of the keys
+// of its values, key 0 of every cell is 0 so empty cells add nothing
+extern const unsigned long long ZobristKeys[SUDOKU_CELLS][10];
+
+// the band (row of boxes) and stack (column of boxes) of every box
+extern const unsigned char BoxBand[SUDOKU_SIZE];
+extern const unsigned char BoxStack[SUDOKU_SIZE];
+
+// the x and y of the top left cell of every box
+extern const unsigned char BoxLeft[SUDOKU_SIZE];
+extern const unsigned char BoxTop[SUDOKU_SIZE];
+
+#endif
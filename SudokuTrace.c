@@ -0,0 +1,311 @@
+#include <string.h>
+
+#include "SudokuTrace.h"
+
+// the ring events are recorded into on this thread, NULL when this thread isn't tracing
+_Thread_local TraceRing *ActiveTrace;
+
+//! Function to initialize an empty trace ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring to initialize
+ *  @param      unsigned int    The most events to keep, rounded down to a power of two, 0 for TRACECAPACITY
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the ring was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeTraceRing(TraceRing *ring, unsigned int capacity, const SudokuAllocator *allocator)
+{
+    unsigned int count = 1;
+
+    // sanity
+    if (!ring) {
+        return false;
+    }
+
+    memset(ring, 0, sizeof(TraceRing));
+
+    if (!capacity) {
+        capacity = TRACECAPACITY;
+    }
+
+    // the largest power of two that fits, so the head wraps with a mask
+    while (count <= capacity / 2) {
+        count *= 2;
+    }
+
+    ring->events = AllocateMemory(allocator, count * sizeof(TraceEvent));
+
+    if (!ring->events) {
+        return false;
+    }
+
+    ring->mask = count - 1;
+    ring->allocator = allocator;
+
+    return true;
+}
+
+//! Function to cleanup a trace ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyTraceRing(TraceRing *ring)
+{
+    // sanity
+    if (!ring) {
+        return;
+    }
+
+    // never leave this thread recording into freed memory
+    if (ActiveTrace == ring) {
+        ActiveTrace = NULL;
+    }
+
+    FreeMemory(ring->allocator, ring->events, (ring->events ? ring->mask + 1 : 0) * sizeof(TraceEvent));
+    memset(ring, 0, sizeof(TraceRing));
+}
+
+//! Function to start recording the events of the calling thread into a ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring, emptied first
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void BeginTrace(TraceRing *ring)
+{
+    // sanity
+    if (!ring
+        || !ring->events) {
+        return;
+    }
+
+    ring->head = 0;
+    ring->startnanoseconds = MetricsNanoseconds();
+    ring->startticks = TraceTicks();
+    ring->endticks = ring->startticks;
+    ring->endnanoseconds = ring->startnanoseconds;
+
+    ActiveTrace = ring;
+    RecordTraceEvent(ring, TRACE_BEGIN, 0, 0, 0);
+}
+
+//! Function to stop recording the events of the calling thread
+/*!
+ *  @param      TraceRing *     A pointer to the ring being recorded into
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void EndTrace(TraceRing *ring)
+{
+    // sanity
+    if (!ring
+        || !ring->events) {
+        return;
+    }
+
+    RecordTraceEvent(ring, TRACE_END, 0, 0, 0);
+    ring->endticks = TraceTicks();
+    ring->endnanoseconds = MetricsNanoseconds();
+
+    if (ActiveTrace == ring) {
+        ActiveTrace = NULL;
+    }
+}
+
+#ifndef SUDOKU_NO_STDIO
+//! Function to write the events of a ring to a file
+/*!
+ *  @param      TraceRing *     A pointer to a ring that has ended
+ *  @param      unsigned char[81] The puzzle that was solved, or NULL
+ *  @param      unsigned long long How long the solve took in nanoseconds
+ *  @param      char *          The file to write
+ *
+ *  @returns    boolean         Whether the trace was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The file is a TraceHeader followed by the events oldest first, in the byte
+ *        order of the machine that wrote it
+ */
+bool WriteTraceFile(const TraceRing *ring, const unsigned char givens[81], unsigned long long latency, const char *path)
+{
+    TraceHeader header;
+    unsigned long long capacity = 0, first = 0, split = 0;
+    FILE *file = NULL;
+    bool written = false;
+
+    // sanity
+    if (!ring
+        || !ring->events
+        || !path) {
+        return false;
+    }
+
+    capacity = (unsigned long long)ring->mask + 1;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACEMAGIC, sizeof(header.magic));
+    header.version = TRACEVERSION;
+    header.count = (unsigned int)(ring->head < capacity ? ring->head : capacity);
+    header.dropped = ring->head - header.count;
+    header.startticks = ring->startticks;
+    header.startnanoseconds = ring->startnanoseconds;
+    header.endticks = ring->endticks;
+    header.endnanoseconds = ring->endnanoseconds;
+    header.latency = latency;
+
+    if (givens) {
+        memcpy(header.givens, givens, sizeof(header.givens));
+    }
+
+    file = fopen(path, "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    // the oldest event sits just after the newest once the ring has wrapped
+    first = header.dropped & ring->mask;
+    split = (capacity - first < header.count) ? capacity - first : header.count;
+
+    written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(ring->events + first, sizeof(TraceEvent), split, file) == split
+        && fwrite(ring->events, sizeof(TraceEvent), header.count - split, file) == header.count - split;
+
+    if (fclose(file) != 0) {
+        written = false;
+    }
+
+    return written;
+}
+
+//! Function to name a trace event
+/*!
+ *  @param      unsigned int    The TRACE_ event
+ *
+ *  @returns    char *          The name of the event
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static const char *TraceEventName(unsigned int type)
+{
+    switch (type) {
+        case TRACE_BEGIN:
+            return "begin";
+        case TRACE_PLACE:
+            return "place";
+        case TRACE_ELIMINATE:
+            return "eliminate";
+        case TRACE_TECHNIQUE:
+            return "technique";
+        case TRACE_GUESS:
+            return "guess";
+        case TRACE_BACKTRACK:
+            return "backtrack";
+        case TRACE_CONTRADICTION:
+            return "contradiction";
+        case TRACE_KNOWNDEAD:
+            return "knowndead";
+        case TRACE_END:
+            return "end";
+        case TRACE_RESTART:
+            return "restart";
+        default:
+            return "unknown";
+    }
+}
+
+//! Function to print a trace file as text
+/*!
+ *  @param      char *          The trace file to read
+ *  @param      FILE *          Where to print the events
+ *
+ *  @returns    boolean         Whether the whole trace was read
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool DecodeTraceFile(const char *path, FILE *output)
+{
+    static const char *Techniques[] = { "cells", "boxes", "rows", "columns" };
+    TraceHeader header;
+    TraceEvent event;
+    unsigned int i = 0, c = 0;
+    double scale = 1.0;
+    FILE *file = NULL;
+    bool complete = true;
+
+    // sanity
+    if (!path
+        || !output) {
+        return false;
+    }
+
+    file = fopen(path, "rb");
+
+    if (!file) {
+        return false;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.magic, TRACEMAGIC, sizeof(header.magic)) != 0
+        || header.version != TRACEVERSION) {
+        fclose(file);
+        return false;
+    }
+
+    // nanoseconds per tick, from the clocks read when the trace began and ended
+    if (header.endticks > header.startticks) {
+        scale = (double)(header.endnanoseconds - header.startnanoseconds) / (double)(header.endticks - header.startticks);
+    }
+
+    fprintf(output, "puzzle ");
+
+    for (c = 0; c < 81; ++c) {
+        fputc(header.givens[c] ? '0' + header.givens[c] : '.', output);
+    }
+
+    fprintf(output, "\nlatency %.3fus, %u events, %llu dropped\n", (double)header.latency / 1000.0, header.count, header.dropped);
+
+    for (i = 0; i < header.count; ++i) {
+        if (fread(&event, sizeof(event), 1, file) != 1) {
+            complete = false;
+            break;
+        }
+
+        fprintf(output, "%12.3fus %-13s", (double)(long long)(event.ticks - header.startticks) * scale / 1000.0, TraceEventName(event.type));
+
+        switch (event.type) {
+            case TRACE_PLACE:
+            case TRACE_ELIMINATE:
+                fprintf(output, " r%uc%u %u", event.cell / 9 + 1, event.cell % 9 + 1, event.value);
+                break;
+            case TRACE_GUESS:
+            case TRACE_BACKTRACK:
+                fprintf(output, " r%uc%u %u depth %u", event.cell / 9 + 1, event.cell % 9 + 1, event.value, event.detail);
+                break;
+            case TRACE_TECHNIQUE:
+                fprintf(output, " %s placed %u", event.detail < 4 ? Techniques[event.detail] : "unknown", event.value);
+                break;
+            case TRACE_CONTRADICTION:
+                fprintf(output, " reason %u", event.detail);
+                break;
+            case TRACE_KNOWNDEAD:
+                fprintf(output, " depth %u", event.detail);
+                break;
+            case TRACE_RESTART:
+                fprintf(output, " number %u", event.detail);
+                break;
+        }
+
+        fputc('\n', output);
+    }
+
+    fclose(file);
+
+    return complete;
+}
+#endif
@@ -0,0 +1,234 @@
+#ifndef SUDOKU_TRACE_H
+#define SUDOKU_TRACE_H
+
+#include <stdbool.h>
+
+#include "SudokuAllocator.h"
+#include "SudokuMetrics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// the number of events a ring keeps when the caller doesn't say, 16 bytes each
+#define TRACECAPACITY 65536
+
+// the first bytes of every trace file, and the version of the layout after them
+#define TRACEMAGIC    "SDKTRACE"
+#define TRACEVERSION  1
+
+// the events a trace records
+#define TRACE_BEGIN          0
+#define TRACE_PLACE          1
+#define TRACE_ELIMINATE      2
+#define TRACE_TECHNIQUE      3
+#define TRACE_GUESS          4
+#define TRACE_BACKTRACK      5
+#define TRACE_CONTRADICTION  6
+#define TRACE_KNOWNDEAD      7
+#define TRACE_END            8
+#define TRACE_RESTART        9
+
+// the techniques a TRACE_TECHNIQUE event names in its detail
+#define TECHNIQUE_CELLS    0
+#define TECHNIQUE_BOXES    1
+#define TECHNIQUE_ROWS     2
+#define TECHNIQUE_COLUMNS  3
+
+// A structure defining a single event of a trace
+typedef struct {
+    // when the event happened in clock ticks, see TraceTicks
+    unsigned long long ticks;
+
+    // the TRACE_ event
+    unsigned char type;
+
+    // the cell from 0 - 80
+    unsigned char cell;
+
+    // the value from 1 - 9, or the number of cells a technique placed
+    unsigned char value;
+
+    // keeps the detail aligned
+    unsigned char unused;
+
+    // the guess depth, technique or contradiction the event is about
+    unsigned int detail;
+} TraceEvent;
+
+// A structure defining the events recorded by one thread, the oldest are overwritten once it is full
+typedef struct {
+    // the events
+    TraceEvent *events;
+
+    // the number of events less one, a power of two less one
+    unsigned int mask;
+
+    // the number of events recorded since the trace began
+    unsigned long long head;
+
+    // the ticks and time the trace began, so ticks can be turned into time
+    unsigned long long startticks;
+    unsigned long long startnanoseconds;
+
+    // the ticks and time the trace ended
+    unsigned long long endticks;
+    unsigned long long endnanoseconds;
+
+    // where the ring gets its memory from
+    const SudokuAllocator *allocator;
+} TraceRing;
+
+// A structure defining the header of a trace file, the events follow oldest first
+typedef struct {
+    // TRACEMAGIC without its terminator
+    char magic[8];
+
+    // TRACEVERSION
+    unsigned int version;
+
+    // the number of events in the file
+    unsigned int count;
+
+    // the number of events overwritten before the trace was written
+    unsigned long long dropped;
+
+    // the ticks and time the trace began and ended
+    unsigned long long startticks;
+    unsigned long long startnanoseconds;
+    unsigned long long endticks;
+    unsigned long long endnanoseconds;
+
+    // how long the solve took in nanoseconds
+    unsigned long long latency;
+
+    // the puzzle that was solved, 1 - 9 for givens and 0 for blanks
+    unsigned char givens[81];
+
+    // keeps the events aligned
+    unsigned char unused[7];
+} TraceHeader;
+
+// the ring events are recorded into on this thread, NULL when this thread isn't tracing
+extern _Thread_local TraceRing *ActiveTrace;
+
+//! Function to read a clock fast enough to stamp every event
+/*!
+ *  @returns    unsigned long long The time in ticks
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: On x86 this is the time stamp counter, a few nanoseconds to read, elsewhere ticks are nanoseconds
+ */
+static inline unsigned long long TraceTicks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return MetricsNanoseconds();
+#endif
+}
+
+//! Function to add an event to a ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring
+ *  @param      unsigned int    The TRACE_ event
+ *  @param      unsigned int    The cell from 0 - 80
+ *  @param      unsigned int    The value
+ *  @param      unsigned int    The detail
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The ring belongs to the calling thread so nothing is locked
+ */
+static inline void RecordTraceEvent(TraceRing *ring, unsigned int type, unsigned int cell, unsigned int value, unsigned int detail)
+{
+    TraceEvent *event = &ring->events[ring->head++ & ring->mask];
+
+    event->ticks = TraceTicks();
+    event->type = (unsigned char)type;
+    event->cell = (unsigned char)cell;
+    event->value = (unsigned char)value;
+    event->detail = detail;
+}
+
+// records an event if this thread is tracing, building with SUDOKU_NO_TRACE removes every event
+#ifdef SUDOKU_NO_TRACE
+#define TRACE_EVENT(type, cell, value, detail)  ((void)0)
+#else
+#define TRACE_EVENT(type, cell, value, detail) \
+    do { \
+        if (ActiveTrace) { \
+            RecordTraceEvent(ActiveTrace, (type), (cell), (value), (detail)); \
+        } \
+    } while (0)
+#endif
+
+//! Function to initialize an empty trace ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring to initialize
+ *  @param      unsigned int    The most events to keep, rounded down to a power of two, 0 for TRACECAPACITY
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the ring was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool InitializeTraceRing(TraceRing *ring, unsigned int capacity, const SudokuAllocator *allocator);
+
+//! Function to cleanup a trace ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyTraceRing(TraceRing *ring);
+
+//! Function to start recording the events of the calling thread into a ring
+/*!
+ *  @param      TraceRing *     A pointer to the ring, emptied first
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void BeginTrace(TraceRing *ring);
+
+//! Function to stop recording the events of the calling thread
+/*!
+ *  @param      TraceRing *     A pointer to the ring being recorded into
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void EndTrace(TraceRing *ring);
+
+#ifndef SUDOKU_NO_STDIO
+#include <stdio.h>
+
+//! Function to write the events of a ring to a file
+/*!
+ *  @param      TraceRing *     A pointer to a ring that has ended
+ *  @param      unsigned char[81] The puzzle that was solved, or NULL
+ *  @param      unsigned long long How long the solve took in nanoseconds
+ *  @param      char *          The file to write
+ *
+ *  @returns    boolean         Whether the trace was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The file is a TraceHeader followed by the events oldest first, in the byte
+ *        order of the machine that wrote it
+ */
+bool WriteTraceFile(const TraceRing *ring, const unsigned char givens[81], unsigned long long latency, const char *path);
+
+//! Function to print a trace file as text
+/*!
+ *  @param      char *          The trace file to read
+ *  @param      FILE *          Where to print the events
+ *
+ *  @returns    boolean         Whether the whole trace was read
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool DecodeTraceFile(const char *path, FILE *output);
+#endif
+
+#endif
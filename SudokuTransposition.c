@@ -0,0 +1,181 @@
+#include <string.h>
+
+#include "SudokuTransposition.h"
+
+//! Function to find the bucket a hash is stored in
+/*!
+ *  @param      TranspositionTable * A pointer to the table
+ *  @param      unsigned long long The hash
+ *
+ *  @returns    atomic_ullong * The first entry of the bucket
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static atomic_ullong *FindBucket(TranspositionTable *table, unsigned long long hash)
+{
+    return table->entries + ((size_t)hash & (table->count - 1) & ~(size_t)(TRANSPOSITIONBUCKET - 1));
+}
+
+//! Function to initialize a transposition table
+/*!
+ *  @param      TranspositionTable * A pointer to the table to initialize
+ *  @param      size_t          The most bytes the entries may use
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the table was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The entries are rounded down to a power of two that fits, at least one bucket of them
+ */
+bool InitializeTranspositionTable(TranspositionTable *table, size_t bytes, const SudokuAllocator *allocator)
+{
+    size_t count = TRANSPOSITIONBUCKET;
+
+    // sanity
+    if (!table) {
+        return false;
+    }
+
+    memset(table, 0, sizeof(TranspositionTable));
+
+    // the biggest power of two that fits our budget
+    while (count * 2 * sizeof(atomic_ullong) <= bytes) {
+        count *= 2;
+    }
+
+    table->allocator = allocator;
+    table->entries = (atomic_ullong*)AllocateMemory(allocator, count * sizeof(atomic_ullong));
+
+    // sanity check it
+    if (!table->entries) {
+        return false;
+    }
+
+    table->count = count;
+    ClearTranspositionTable(table);
+
+    return true;
+}
+
+//! Function to cleanup a transposition table
+/*!
+ *  @param      TranspositionTable * A pointer to the table to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyTranspositionTable(TranspositionTable *table)
+{
+    // sanity
+    if (!table) {
+        return;
+    }
+
+    FreeMemory(table->allocator, table->entries, table->count * sizeof(atomic_ullong));
+    memset(table, 0, sizeof(TranspositionTable));
+}
+
+//! Function to forget every board in a transposition table
+/*!
+ *  @param      TranspositionTable * A pointer to the table to clear
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Boards are dead whatever puzzle they came from, so a table only needs clearing to free up room
+ */
+void ClearTranspositionTable(TranspositionTable *table)
+{
+    size_t i = 0;
+
+    // sanity
+    if (!table
+        || !table->entries) {
+        return;
+    }
+
+    for (i = 0; i < table->count; ++i) {
+        atomic_init(&table->entries[i], 0);
+    }
+
+    atomic_init(&table->hits, 0);
+    atomic_init(&table->stores, 0);
+}
+
+//! Function to check whether a board is known to have no solution
+/*!
+ *  @param      TranspositionTable * A pointer to the table
+ *  @param      unsigned long long The Zobrist hash of the board
+ *
+ *  @returns    boolean         Whether the board was stored as dead
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This never locks, any number of threads can share a table
+ */
+bool IsKnownDead(TranspositionTable *table, unsigned long long hash)
+{
+    atomic_ullong *bucket = NULL;
+    unsigned int i = 0;
+
+    // sanity, an empty entry can't be looked up
+    if (!table
+        || !table->entries
+        || !hash) {
+        return false;
+    }
+
+    bucket = FindBucket(table, hash);
+
+    for (i = 0; i < TRANSPOSITIONBUCKET; ++i) {
+        if (atomic_load_explicit(&bucket[i], memory_order_relaxed) == hash) {
+            atomic_fetch_add_explicit(&table->hits, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! Function to store a board that has no solution
+/*!
+ *  @param      TranspositionTable * A pointer to the table
+ *  @param      unsigned long long The Zobrist hash of the board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This never locks. A full bucket has one of its entries replaced, chosen by the hash.
+ */
+void RecordDead(TranspositionTable *table, unsigned long long hash)
+{
+    atomic_ullong *bucket = NULL;
+    unsigned long long entry = 0;
+    unsigned int i = 0;
+
+    // sanity, an empty entry can't be stored
+    if (!table
+        || !table->entries
+        || !hash) {
+        return;
+    }
+
+    bucket = FindBucket(table, hash);
+
+    // take the first empty entry, unless we're already stored
+    for (i = 0; i < TRANSPOSITIONBUCKET; ++i) {
+        entry = atomic_load_explicit(&bucket[i], memory_order_relaxed);
+
+        if (entry == hash) {
+            return;
+        }
+
+        if (!entry
+            && atomic_compare_exchange_strong_explicit(&bucket[i], &entry, hash, memory_order_relaxed, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&table->stores, 1, memory_order_relaxed);
+            return;
+        }
+    }
+
+    // the bucket is full, the bits of the hash above the ones that picked the bucket pick the entry to replace
+    atomic_store_explicit(&bucket[(hash >> 32) % TRANSPOSITIONBUCKET], hash, memory_order_relaxed);
+    atomic_fetch_add_explicit(&table->stores, 1, memory_order_relaxed);
+}
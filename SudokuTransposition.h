@@ -0,0 +1,85 @@
+#ifndef SUDOKU_TRANSPOSITION_H
+#define SUDOKU_TRANSPOSITION_H
+
+#include <stdatomic.h>
+
+#include "SudokuAllocator.h"
+
+// the number of entries a hash can be stored in, four 8 byte entries share half a cache line
+#define TRANSPOSITIONBUCKET 4
+
+// A structure defining a table of the boards a search has proven have no solution
+typedef struct {
+    // the hash of a dead board in every entry, 0 for an empty entry
+    atomic_ullong *entries;
+
+    // the number of entries, a power of two
+    size_t count;
+
+    // the number of lookups that found a dead board
+    atomic_ullong hits;
+
+    // the number of dead boards stored
+    atomic_ullong stores;
+
+    // where the table gets its memory from
+    const SudokuAllocator *allocator;
+} TranspositionTable;
+
+//! Function to initialize a transposition table
+/*!
+ *  @param      TranspositionTable * A pointer to the table to initialize
+ *  @param      size_t          The most bytes the entries may use
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the table was initialized
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The entries are rounded down to a power of two that fits, at least one bucket of them
+ */
+bool InitializeTranspositionTable(TranspositionTable *table, size_t bytes, const SudokuAllocator *allocator);
+
+//! Function to cleanup a transposition table
+/*!
+ *  @param      TranspositionTable * A pointer to the table to clean up
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DestroyTranspositionTable(TranspositionTable *table);
+
+//! Function to forget every board in a transposition table
+/*!
+ *  @param      TranspositionTable * A pointer to the table to clear
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Boards are dead whatever puzzle they came from, so a table only needs clearing to free up room
+ */
+void ClearTranspositionTable(TranspositionTable *table);
+
+//! Function to check whether a board is known to have no solution
+/*!
+ *  @param      TranspositionTable * A pointer to the table
+ *  @param      unsigned long long The Zobrist hash of the board
+ *
+ *  @returns    boolean         Whether the board was stored as dead
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This never locks, any number of threads can share a table
+ */
+bool IsKnownDead(TranspositionTable *table, unsigned long long hash);
+
+//! Function to store a board that has no solution
+/*!
+ *  @param      TranspositionTable * A pointer to the table
+ *  @param      unsigned long long The Zobrist hash of the board
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This never locks. A full bucket has one of its entries replaced, chosen by the hash.
+ */
+void RecordDead(TranspositionTable *table, unsigned long long hash);
+
+#endif
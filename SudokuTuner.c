@@ -0,0 +1,375 @@
+#include "SudokuTuner.h"
+#include "SudokuTransposition.h"
+
+// the knobs a tuner sweeps, in the order it sweeps them
+#define KNOB_ENGINE     0
+#define KNOB_SCORER     1
+#define KNOB_MAXGUESSES 2
+#define KNOB_TABLE      3
+#define TUNINGKNOBS     4
+
+// the most settings a knob is swept over
+#define MAXKNOBSETTINGS 8
+
+// the longest line of a config
+#define CONFIGLINESIZE  256
+
+// A structure defining the settings a knob is swept over
+typedef struct {
+    // the settings
+    unsigned int settings[MAXKNOBSETTINGS];
+
+    // the number of settings
+    unsigned int count;
+} TuningKnob;
+
+// the settings of every knob, indexed by KNOB_
+static const TuningKnob TuningKnobs[TUNINGKNOBS] = {
+    { { ENGINE_PROBABILITY, ENGINE_LEARNING, ENGINE_SAT, ENGINE_PORTFOLIO, ENGINE_RESTARTS, ENGINE_ADAPTIVE }, 6 },
+    { { SCORER_PROBABILITY, SCORER_CANDIDATES }, 2 },
+    { { 10, 20, 40, 60, 81 }, 5 },
+    { { 0, 1, 16 }, 3 }
+};
+
+//! Function to find the setting of a knob within a config
+/*!
+ *  @param      SolverConfig *  A pointer to the config
+ *  @param      unsigned int    The KNOB_
+ *
+ *  @returns    unsigned int *  A pointer to the setting
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static unsigned int *KnobSetting(SolverConfig *config, unsigned int knob)
+{
+    switch (knob) {
+        case KNOB_ENGINE:
+            return &config->engine;
+        case KNOB_SCORER:
+            return &config->scorer;
+        case KNOB_MAXGUESSES:
+            return &config->maxguesses;
+        default:
+            return &config->tablemegabytes;
+    }
+}
+
+//! Function to tell whether one result beats another
+/*!
+ *  @param      TuningResult *  The challenger
+ *  @param      TuningResult *  The result already kept
+ *
+ *  @returns    boolean         Whether the challenger solved more, or as many clearly faster
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+static bool IsBetterResult(const TuningResult *challenger, const TuningResult *kept)
+{
+    if (challenger->solved != kept->solved) {
+        return challenger->solved > kept->solved;
+    }
+
+    return (challenger->nanoseconds * 100) < (kept->nanoseconds * (100 - TUNINGMARGIN));
+}
+
+//! Function to set a config to the settings batch mode uses without one
+/*!
+ *  @param      SolverConfig *  A pointer to the config
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DefaultSolverConfig(SolverConfig *config)
+{
+    // sanity
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(SolverConfig));
+
+    config->threshold = 100;
+    config->maxguesses = SUDOKU_CELLS;
+    config->engine = ENGINE_PROBABILITY;
+    config->scorer = SCORER_PROBABILITY;
+    config->dispatcher = DefaultDispatcher;
+}
+
+//! Function to set up a sudoku with every knob of a config but the transposition table
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SolverConfig *  The config
+ *
+ *  @returns    boolean         Whether the config was applied
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The sudoku points at the dispatcher of the config, the config must outlive it
+ */
+bool ApplySolverConfig(Sudoku *sudoku, const SolverConfig *config)
+{
+    // sanity
+    if (!sudoku
+        || !config) {
+        return false;
+    }
+
+    sudoku->threshold = config->threshold;
+    sudoku->maxguesscount = config->maxguesses;
+    sudoku->engine = config->engine;
+    sudoku->scorer = (config->scorer == SCORER_CANDIDATES) ? CandidateScore : ProbabilityScore;
+    sudoku->seed = config->seed;
+    sudoku->dispatcher = config->dispatchervalid ? &config->dispatcher : NULL;
+
+    return true;
+}
+
+//! Function to time a config on a corpus
+/*!
+ *  @param      SolverConfig *  The config
+ *  @param      unsigned int[][9][9] The puzzles, 0 for an empty cell
+ *  @param      unsigned int    The number of puzzles
+ *  @param      TuningResult *  Receives the solve rate and time
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether every puzzle was searched
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool MeasureSolverConfig(const SolverConfig *config, const unsigned int (*puzzles)[9][9], unsigned int count, TuningResult *result, const SudokuAllocator *allocator)
+{
+    unsigned long long started = 0;
+    unsigned int i = 0;
+    TranspositionTable table;
+    Sudoku sudoku;
+
+    // sanity
+    if (!config
+        || !puzzles
+        || !result) {
+        return false;
+    }
+
+    memset(result, 0, sizeof(TuningResult));
+
+    InitializeSudokuStorage(&sudoku, config->threshold, config->maxguesses);
+    sudoku.verbose = false;
+    ApplySolverConfig(&sudoku, config);
+
+    // every puzzle shares the table like they would in batch mode
+    if (config->tablemegabytes) {
+        if (!InitializeTranspositionTable(&table, (size_t)config->tablemegabytes << 20, allocator)) {
+            return false;
+        }
+
+        sudoku.transpositions = &table;
+    }
+
+    for (i = 0; i < count; ++i) {
+        ResetSudoku(&sudoku);
+        memcpy(sudoku.grid, puzzles[i], sizeof(sudoku.grid));
+
+        started = MetricsNanoseconds();
+
+        // the same steps as SolveSudoku without the printing
+        if (PropagateSudoku(&sudoku) == PROPAGATE_INCOMPLETE
+            && sudoku.maxguesscount) {
+            SearchSudokuEngine(&sudoku);
+        }
+
+        result->nanoseconds += MetricsNanoseconds() - started;
+        result->solved += IsSudokuComplete(&sudoku);
+        result->count++;
+    }
+
+    if (config->tablemegabytes) {
+        DestroyTranspositionTable(&table);
+    }
+
+    return true;
+}
+
+//! Function to find the config that solves the most of a corpus the fastest
+/*!
+ *  @param      SolverConfig *  The config to start from, receives the best found
+ *  @param      unsigned int[][9][9] The puzzles, 0 for an empty cell
+ *  @param      unsigned int    The number of puzzles
+ *  @param      TuningResult *  Receives how the best config did, or NULL
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the corpus could be measured
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The dispatcher is trained on the corpus first. Then each knob in turn is swept over
+ *        its settings with the rest held, keeping whichever solves the most puzzles and, of
+ *        those, is TUNINGMARGIN percent faster than the setting already kept. This is repeated
+ *        TUNINGPASSES times, so it costs a few dozen runs over the corpus rather than one for
+ *        every combination
+ */
+bool TuneSolverConfig(SolverConfig *config, const unsigned int (*puzzles)[9][9], unsigned int count, TuningResult *result, const SudokuAllocator *allocator)
+{
+    unsigned int pass = 0, knob = 0, s = 0, kept = 0;
+    unsigned int *setting = NULL;
+    TuningResult best, measured;
+
+    // sanity
+    if (!config
+        || !puzzles
+        || !count) {
+        return false;
+    }
+
+    // the adaptive engine is swept with buckets that fit the corpus
+    if (TrainSudokuDispatcher(&config->dispatcher, puzzles, count, 1, config->maxguesses ? config->maxguesses : SUDOKU_CELLS, allocator)) {
+        config->dispatchervalid = true;
+    }
+
+    if (!MeasureSolverConfig(config, puzzles, count, &best, allocator)) {
+        return false;
+    }
+
+    for (pass = 0; pass < TUNINGPASSES; ++pass) {
+        for (knob = 0; knob < TUNINGKNOBS; ++knob) {
+            setting = KnobSetting(config, knob);
+            kept = *setting;
+
+            // try every other setting with the rest of the config held
+            for (s = 0; s < TuningKnobs[knob].count; ++s) {
+                if (TuningKnobs[knob].settings[s] == kept) {
+                    continue;
+                }
+
+                *setting = TuningKnobs[knob].settings[s];
+
+                if (MeasureSolverConfig(config, puzzles, count, &measured, allocator)
+                    && IsBetterResult(&measured, &best)) {
+                    best = measured;
+                    kept = *setting;
+                }
+            }
+
+            *setting = kept;
+        }
+    }
+
+    if (result) {
+        *result = best;
+    }
+
+    return true;
+}
+
+//! Function to write a config as text
+/*!
+ *  @param      SolverConfig *  The config
+ *  @param      TuningResult *  How the config did, written as a comment, or NULL
+ *  @param      FILE *          The file to write to
+ *
+ *  @returns    boolean         Whether the whole config was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool SaveSolverConfig(const SolverConfig *config, const TuningResult *result, FILE *file)
+{
+    unsigned int b = 0;
+
+    // sanity
+    if (!config
+        || !file) {
+        return false;
+    }
+
+    if (result
+        && result->count
+        && fprintf(file, "# %u puzzles, %u solved, %.3fus each\n",
+            result->count,
+            result->solved,
+            (double)result->nanoseconds / (double)result->count / 1000.0) < 0) {
+        return false;
+    }
+
+    if (fprintf(file, "threshold %u\nmaxguesses %u\nengine %u\nscorer %u\ntable %u\nseed %llu\n",
+        config->threshold,
+        config->maxguesses,
+        config->engine,
+        config->scorer,
+        config->tablemegabytes,
+        config->seed) < 0) {
+        return false;
+    }
+
+    // bucket <lowest difficulty> <engine> <1 to search in parallel>
+    for (b = 0; config->dispatchervalid && b < config->dispatcher.count; ++b) {
+        if (fprintf(file, "bucket %u %u %u\n",
+            config->dispatcher.bounds[b],
+            config->dispatcher.engines[b],
+            config->dispatcher.parallel[b] ? 1u : 0u) < 0) {
+            return false;
+        }
+    }
+
+    return (fflush(file) == 0);
+}
+
+//! Function to read a config written by SaveSolverConfig
+/*!
+ *  @param      SolverConfig *  Receives the config, anything the file doesn't set keeps its setting
+ *  @param      FILE *          The file to read from
+ *
+ *  @returns    boolean         Whether every line was understood
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Each line is a knob and its setting, lines starting with # are comments
+ */
+bool LoadSolverConfig(SolverConfig *config, FILE *file)
+{
+    char line[CONFIGLINESIZE], key[32];
+    unsigned int value = 0, engine = 0, parallel = 0, buckets = 0;
+    unsigned long long seed = 0;
+    bool understood = true;
+
+    // sanity
+    if (!config
+        || !file) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        // blank lines and comments
+        if (sscanf(line, "%31s", key) != 1
+            || key[0] == '#') {
+            continue;
+        }
+
+        if (strcmp(key, "seed") == 0
+            && sscanf(line, "%*s %llu", &seed) == 1) {
+            config->seed = seed;
+        } else if (strcmp(key, "bucket") == 0
+            && buckets < DISPATCHBUCKETS
+            && sscanf(line, "%*s %u %u %u", &value, &engine, &parallel) == 3) {
+            // the first bucket replaces the dispatcher we had
+            config->dispatcher.bounds[buckets] = value;
+            config->dispatcher.engines[buckets] = engine;
+            config->dispatcher.parallel[buckets] = (parallel != 0);
+            config->dispatcher.count = ++buckets;
+            config->dispatchervalid = true;
+        } else if (sscanf(line, "%*s %u", &value) != 1) {
+            understood = false;
+        } else if (strcmp(key, "threshold") == 0) {
+            config->threshold = value;
+        } else if (strcmp(key, "maxguesses") == 0) {
+            config->maxguesses = value;
+        } else if (strcmp(key, "engine") == 0) {
+            config->engine = value;
+        } else if (strcmp(key, "scorer") == 0) {
+            config->scorer = value;
+        } else if (strcmp(key, "table") == 0) {
+            config->tablemegabytes = value;
+        } else {
+            understood = false;
+        }
+    }
+
+    return understood;
+}
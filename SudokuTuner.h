@@ -0,0 +1,139 @@
+#ifndef SUDOKU_TUNER_H
+#define SUDOKU_TUNER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "SudokuSolver.h"
+#include "SudokuDispatch.h"
+
+// the scorers a config can guess with
+#define SCORER_PROBABILITY  0
+#define SCORER_CANDIDATES   1
+
+// the passes a tuner makes over every knob, later passes catch knobs that depend on each other
+#define TUNINGPASSES        2
+
+// the percentage a setting must be faster by to replace the one already chosen, so noise doesn't flip it
+#define TUNINGMARGIN        3
+
+// A structure defining every knob of a search
+typedef struct {
+    // the minimum guess threshold % of FindBestGuesses, kept with the config but never tuned as no engine ranks by it
+    unsigned int threshold;
+
+    // the maximum number of consecutive guesses
+    unsigned int maxguesses;
+
+    // the ENGINE_ to search with
+    unsigned int engine;
+
+    // the SCORER_ to rank guesses with
+    unsigned int scorer;
+
+    // the megabytes of the transposition table shared by every puzzle, 0 for none
+    unsigned int tablemegabytes;
+
+    // where randomized searches start their random numbers
+    unsigned long long seed;
+
+    // chooses the engine of ENGINE_ADAPTIVE searches
+    SudokuDispatcher dispatcher;
+
+    // whether the dispatcher was trained, DefaultDispatcher is used otherwise
+    bool dispatchervalid;
+} SolverConfig;
+
+// A structure defining how well a config did on a corpus
+typedef struct {
+    // the number of puzzles searched
+    unsigned int count;
+
+    // the number of puzzles solved
+    unsigned int solved;
+
+    // the time spent solving every puzzle in nanoseconds
+    unsigned long long nanoseconds;
+} TuningResult;
+
+//! Function to set a config to the settings batch mode uses without one
+/*!
+ *  @param      SolverConfig *  A pointer to the config
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+void DefaultSolverConfig(SolverConfig *config);
+
+//! Function to set up a sudoku with every knob of a config but the transposition table
+/*!
+ *  @param      Sudoku*         A pointer to the sudoku object
+ *  @param      SolverConfig *  The config
+ *
+ *  @returns    boolean         Whether the config was applied
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The sudoku points at the dispatcher of the config, the config must outlive it
+ */
+bool ApplySolverConfig(Sudoku *sudoku, const SolverConfig *config);
+
+//! Function to time a config on a corpus
+/*!
+ *  @param      SolverConfig *  The config
+ *  @param      unsigned int[][9][9] The puzzles, 0 for an empty cell
+ *  @param      unsigned int    The number of puzzles
+ *  @param      TuningResult *  Receives the solve rate and time
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether every puzzle was searched
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool MeasureSolverConfig(const SolverConfig *config, const unsigned int (*puzzles)[9][9], unsigned int count, TuningResult *result, const SudokuAllocator *allocator);
+
+//! Function to find the config that solves the most of a corpus the fastest
+/*!
+ *  @param      SolverConfig *  The config to start from, receives the best found
+ *  @param      unsigned int[][9][9] The puzzles, 0 for an empty cell
+ *  @param      unsigned int    The number of puzzles
+ *  @param      TuningResult *  Receives how the best config did, or NULL
+ *  @param      SudokuAllocator * The allocator to use, or NULL for the system allocator
+ *
+ *  @returns    boolean         Whether the corpus could be measured
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The dispatcher is trained on the corpus first. Then each knob in turn is swept over
+ *        its settings with the rest held, keeping whichever solves the most puzzles and, of
+ *        those, is TUNINGMARGIN percent faster than the setting already kept. This is repeated
+ *        TUNINGPASSES times, so it costs a few dozen runs over the corpus rather than one for
+ *        every combination
+ */
+bool TuneSolverConfig(SolverConfig *config, const unsigned int (*puzzles)[9][9], unsigned int count, TuningResult *result, const SudokuAllocator *allocator);
+
+//! Function to write a config as text
+/*!
+ *  @param      SolverConfig *  The config
+ *  @param      TuningResult *  How the config did, written as a comment, or NULL
+ *  @param      FILE *          The file to write to
+ *
+ *  @returns    boolean         Whether the whole config was written
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool SaveSolverConfig(const SolverConfig *config, const TuningResult *result, FILE *file);
+
+//! Function to read a config written by SaveSolverConfig
+/*!
+ *  @param      SolverConfig *  Receives the config, anything the file doesn't set keeps its setting
+ *  @param      FILE *          The file to read from
+ *
+ *  @returns    boolean         Whether every line was understood
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: Each line is a knob and its setting, lines starting with # are comments
+ */
+bool LoadSolverConfig(SolverConfig *config, FILE *file);
+
+#endif
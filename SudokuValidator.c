@@ -0,0 +1,358 @@
+#include "SudokuValidator.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// the bit for value v, with no bit at all for a blank
+#define GIVEN_BIT(v)  ((1u << (v)) >> 1)
+
+//! Function to check every cell of a grid holds a value in range
+/*!
+ *  @param      unsigned char[81] The grid to check
+ *  @param      unsigned int    The smallest value allowed, 0 to allow blanks
+ *
+ *  @returns    boolean         Whether every cell is from the smallest value to 9
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: With SSE2 the cells are checked 16 at a time
+ */
+static bool CellsInRange(const unsigned char grid[81], unsigned int low)
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    const __m128i base = _mm_set1_epi8((char)low);
+    const __m128i limit = _mm_set1_epi8((char)(9 - low));
+    __m128i cells, offset, bad = _mm_setzero_si128();
+
+    // anything below the smallest value wraps round past the limit
+    for (i = 0; i + 16 <= SUDOKU_CELLS; i += 16) {
+        cells = _mm_loadu_si128((const __m128i*)(grid + i));
+        offset = _mm_sub_epi8(cells, base);
+        bad = _mm_or_si128(bad, _mm_xor_si128(_mm_cmpeq_epi8(_mm_min_epu8(offset, limit), offset), _mm_set1_epi8(-1)));
+    }
+
+    if (_mm_movemask_epi8(bad)) {
+        return false;
+    }
+#endif
+
+    // whatever is left one cell at a time
+    for (; i < SUDOKU_CELLS; ++i) {
+        if (grid[i] < low
+            || grid[i] > 9) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Function to check a solution keeps every given of its puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle
+ *  @param      unsigned char[81] The solution
+ *
+ *  @returns    boolean         Whether every cell is blank in the puzzle or the same in both
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: With SSE2 the cells are checked 16 at a time
+ */
+static bool KeepsGivens(const unsigned char givens[81], const unsigned char solution[81])
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    __m128i given, solved, kept = _mm_set1_epi8(-1);
+
+    for (i = 0; i + 16 <= SUDOKU_CELLS; i += 16) {
+        given = _mm_loadu_si128((const __m128i*)(givens + i));
+        solved = _mm_loadu_si128((const __m128i*)(solution + i));
+        kept = _mm_and_si128(kept, _mm_or_si128(_mm_cmpeq_epi8(given, zero), _mm_cmpeq_epi8(given, solved)));
+    }
+
+    if (_mm_movemask_epi8(kept) != 0xFFFF) {
+        return false;
+    }
+#endif
+
+    // whatever is left one cell at a time
+    for (; i < SUDOKU_CELLS; ++i) {
+        if (givens[i]
+            && givens[i] != solution[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Function to find and describe the first thing wrong with a grid
+/*!
+ *  @param      unsigned char[81] The puzzle the grid must keep the givens of, or NULL
+ *  @param      unsigned char[81] The grid to check
+ *  @param      boolean         Whether the grid must have every cell filled
+ *  @param      ValidationResult * Where to report the outcome
+ *
+ *  @returns    boolean         Whether the grid is valid
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: This walks the grid a cell at a time, it is only called once the quick checks
+ *        have found something wrong or when the caller wants the details
+ */
+static bool DescribeGrid(const unsigned char *givens, const unsigned char grid[81], bool complete, ValidationResult *result)
+{
+    unsigned short units[SUDOKU_UNITS];
+    unsigned int c = 0, u = 0, bit = 0;
+    unsigned int cellunits[3];
+
+    memset(units, 0, sizeof(units));
+    memset(result, 0, sizeof(ValidationResult));
+
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        result->cell = c;
+        result->value = grid[c];
+
+        // a value that can't be in a sudoku at all
+        if (grid[c] > 9) {
+            result->error = VALIDATE_BADVALUE;
+            return false;
+        }
+
+        // a blank in a grid that should be full
+        if (!grid[c]) {
+            if (complete) {
+                result->error = VALIDATE_INCOMPLETE;
+                return false;
+            }
+
+            continue;
+        }
+
+        // a given that got changed
+        if (givens
+            && givens[c]
+            && givens[c] != grid[c]) {
+            result->error = VALIDATE_MISMATCH;
+            return false;
+        }
+
+        // a value already seen in one of our units
+        bit = VALUE_BIT(grid[c]);
+        cellunits[0] = ROW_UNIT(CellRow[c]);
+        cellunits[1] = COLUMN_UNIT(CellColumn[c]);
+        cellunits[2] = BOX_UNIT(CellBox[c]);
+
+        for (u = 0; u < 3; ++u) {
+            if (units[cellunits[u]] & bit) {
+                result->error = VALIDATE_DUPLICATE;
+                result->unit = cellunits[u];
+                return false;
+            }
+
+            units[cellunits[u]] |= bit;
+        }
+    }
+
+    memset(result, 0, sizeof(ValidationResult));
+
+    return true;
+}
+
+//! Function to check the givens of a puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle left to right, top to bottom, 1 - 9 for givens and 0 for blanks
+ *  @param      ValidationResult * Where to report the outcome, or NULL
+ *
+ *  @returns    boolean         Whether every given is from 1 - 9 and none share a row, column or box
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: The givens are gathered into unit masks without branching, the grid is only walked
+ *        again to describe the error when one is found
+ */
+bool ValidateGivens(const unsigned char givens[81], ValidationResult *result)
+{
+    ValidationResult ignored;
+    unsigned short units[SUDOKU_UNITS];
+    unsigned int c = 0, bit = 0, clash = 0;
+
+    // sanity
+    if (!givens) {
+        return false;
+    }
+
+    if (!result) {
+        result = &ignored;
+    }
+
+    // every cell must be a blank or 1 - 9 before the values can be used as bits
+    if (!CellsInRange(givens, 0)) {
+        return DescribeGrid(NULL, givens, false, result);
+    }
+
+    memset(units, 0, sizeof(units));
+
+    // note any given already in one of its units
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        bit = GIVEN_BIT(givens[c]);
+        clash |= (units[ROW_UNIT(CellRow[c])] | units[COLUMN_UNIT(CellColumn[c])] | units[BOX_UNIT(CellBox[c])]) & bit;
+        units[ROW_UNIT(CellRow[c])] |= bit;
+        units[COLUMN_UNIT(CellColumn[c])] |= bit;
+        units[BOX_UNIT(CellBox[c])] |= bit;
+    }
+
+    if (clash) {
+        return DescribeGrid(NULL, givens, false, result);
+    }
+
+    memset(result, 0, sizeof(ValidationResult));
+
+    return true;
+}
+
+//! Function to check a solved grid
+/*!
+ *  @param      unsigned char[81] The puzzle the solution is for, or NULL to only check the solution
+ *  @param      unsigned char[81] The solution laid out as for the puzzle
+ *  @param      ValidationResult * Where to report the outcome, or NULL
+ *
+ *  @returns    boolean         Whether the solution is a full valid grid that keeps every given
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A solution that is valid and keeps every given also proves the givens were consistent.
+ *        With every cell from 1 - 9 the grid is valid exactly when every unit holds all nine
+ *        values, so the grid is only walked again to describe the error when one is found.
+ */
+bool ValidateSolution(const unsigned char givens[81], const unsigned char solution[81], ValidationResult *result)
+{
+    ValidationResult ignored;
+    unsigned short units[SUDOKU_UNITS];
+    unsigned int c = 0, bit = 0, all = ALL_VALUES;
+
+    // sanity
+    if (!solution) {
+        return false;
+    }
+
+    if (!result) {
+        result = &ignored;
+    }
+
+    // every cell must be 1 - 9 and keep its given
+    if (!CellsInRange(solution, 1)
+        || (givens && !KeepsGivens(givens, solution))) {
+        return DescribeGrid(givens, solution, true, result);
+    }
+
+    memset(units, 0, sizeof(units));
+
+    // gather the values of every unit
+    for (c = 0; c < SUDOKU_CELLS; ++c) {
+        bit = VALUE_BIT(solution[c]);
+        units[ROW_UNIT(CellRow[c])] |= bit;
+        units[COLUMN_UNIT(CellColumn[c])] |= bit;
+        units[BOX_UNIT(CellBox[c])] |= bit;
+    }
+
+    for (c = 0; c < SUDOKU_UNITS; ++c) {
+        all &= units[c];
+    }
+
+    if (all != ALL_VALUES) {
+        return DescribeGrid(givens, solution, true, result);
+    }
+
+    memset(result, 0, sizeof(ValidationResult));
+
+    return true;
+}
+
+//! Function to check the givens of an array of puzzles
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each
+ *  @param      unsigned int    The number of puzzles
+ *  @param      ValidationResult * Receives the outcome of every puzzle, or NULL
+ *
+ *  @returns    unsigned int    The number of valid puzzles
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int ValidateGivensBatch(const unsigned char *givens, unsigned int count, ValidationResult *results)
+{
+    unsigned int i = 0, valid = 0;
+
+    // sanity
+    if (!givens) {
+        return 0;
+    }
+
+    for (i = 0; i < count; ++i) {
+        if (ValidateGivens(givens + (i * SUDOKU_CELLS), results ? &results[i] : NULL)) {
+            valid++;
+        }
+    }
+
+    return valid;
+}
+
+//! Function to check an array of solved grids
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each, or NULL to only check the solutions
+ *  @param      unsigned char * The solutions, 81 bytes each
+ *  @param      unsigned int    The number of solutions
+ *  @param      ValidationResult * Receives the outcome of every solution, or NULL
+ *
+ *  @returns    unsigned int    The number of valid solutions
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int ValidateSolutionBatch(const unsigned char *givens, const unsigned char *solutions, unsigned int count, ValidationResult *results)
+{
+    unsigned int i = 0, valid = 0;
+
+    // sanity
+    if (!solutions) {
+        return 0;
+    }
+
+    for (i = 0; i < count; ++i) {
+        if (ValidateSolution(givens ? givens + (i * SUDOKU_CELLS) : NULL,
+            solutions + (i * SUDOKU_CELLS),
+            results ? &results[i] : NULL)) {
+            valid++;
+        }
+    }
+
+    return valid;
+}
+
+//! Function to describe a validation error
+/*!
+ *  @param      unsigned int    The error from a ValidationResult
+ *
+ *  @returns    char *          A short description of the error
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+const char *ValidationErrorString(unsigned int error)
+{
+    switch (error) {
+        case VALIDATE_OK:
+            return "ok";
+        case VALIDATE_BADVALUE:
+            return "cell holds a value above 9";
+        case VALIDATE_DUPLICATE:
+            return "value appears twice in a row, column or box";
+        case VALIDATE_INCOMPLETE:
+            return "cell is blank";
+        case VALIDATE_MISMATCH:
+            return "cell differs from the given";
+        default:
+            return "unknown error";
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef SUDOKU_VALIDATOR_H
+#define SUDOKU_VALIDATOR_H
+
+#include "SudokuSolver.h"
+
+// the problems a grid can be found to have
+#define VALIDATE_OK          0
+#define VALIDATE_BADVALUE    1
+#define VALIDATE_DUPLICATE   2
+#define VALIDATE_INCOMPLETE  3
+#define VALIDATE_MISMATCH    4
+
+// A structure defining the outcome of validating a grid
+typedef struct {
+    // what is wrong with the grid, VALIDATE_OK if nothing is
+    unsigned int error;
+
+    // the first cell found to be wrong from 0 - 80, 0 if nothing is
+    unsigned int cell;
+
+    // the row, column or box holding a duplicate from 0 - 26, 0 for any other error
+    unsigned int unit;
+
+    // the value found in the cell
+    unsigned int value;
+} ValidationResult;
+
+//! Function to check the givens of a puzzle
+/*!
+ *  @param      unsigned char[81] The puzzle left to right, top to bottom, 1 - 9 for givens and 0 for blanks
+ *  @param      ValidationResult * Where to report the outcome, or NULL
+ *
+ *  @returns    boolean         Whether every given is from 1 - 9 and none share a row, column or box
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+bool ValidateGivens(const unsigned char givens[81], ValidationResult *result);
+
+//! Function to check a solved grid
+/*!
+ *  @param      unsigned char[81] The puzzle the solution is for, or NULL to only check the solution
+ *  @param      unsigned char[81] The solution laid out as for the puzzle
+ *  @param      ValidationResult * Where to report the outcome, or NULL
+ *
+ *  @returns    boolean         Whether the solution is a full valid grid that keeps every given
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ *
+ *  Note: A solution that is valid and keeps every given also proves the givens were consistent
+ */
+bool ValidateSolution(const unsigned char givens[81], const unsigned char solution[81], ValidationResult *result);
+
+//! Function to check the givens of an array of puzzles
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each
+ *  @param      unsigned int    The number of puzzles
+ *  @param      ValidationResult * Receives the outcome of every puzzle, or NULL
+ *
+ *  @returns    unsigned int    The number of valid puzzles
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int ValidateGivensBatch(const unsigned char *givens, unsigned int count, ValidationResult *results);
+
+//! Function to check an array of solved grids
+/*!
+ *  @param      unsigned char * The puzzles, 81 bytes each, or NULL to only check the solutions
+ *  @param      unsigned char * The solutions, 81 bytes each
+ *  @param      unsigned int    The number of solutions
+ *  @param      ValidationResult * Receives the outcome of every solution, or NULL
+ *
+ *  @returns    unsigned int    The number of valid solutions
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+unsigned int ValidateSolutionBatch(const unsigned char *givens, const unsigned char *solutions, unsigned int count, ValidationResult *results);
+
+//! Function to describe a validation error
+/*!
+ *  @param      unsigned int    The error from a ValidationResult
+ *
+ *  @returns    char *          A short description of the error
+ *
+ *  @author     Daniel Fraser   <danielfraser782@gmail.com>
+ */
+const char *ValidationErrorString(unsigned int error);
+
+#endif